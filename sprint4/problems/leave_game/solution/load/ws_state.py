@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""Сравнение получения состояния игры опросом GET /api/v1/game/state и по WebSocket.
+
+Скрипт подключает N игроков к карте и в течение заданного времени получает состояние
+одним из способов, затем печатает количество полученных состояний в секунду.
+Загрузка CPU сервера снимается параллельно: pidstat -p $(pidof game_server) 1
+
+    pip install websockets
+    python3 ws_state.py --mode poll --players 256 --duration 30
+    python3 ws_state.py --mode ws --players 256 --duration 30
+"""
+import argparse
+import asyncio
+import json
+import time
+import urllib.request
+
+import websockets
+
+
+def join(host, port, map_id, name):
+    body = json.dumps({"userName": name, "mapId": map_id}).encode()
+    request = urllib.request.Request(f"http://{host}:{port}/api/v1/game/join", data=body,
+                                     headers={"Content-Type": "application/json"}, method="POST")
+    with urllib.request.urlopen(request) as response:
+        return json.load(response)["authToken"]
+
+
+async def poll(host, port, token, deadline, counter):
+    # Опрос по одному keep-alive соединению, как это делает клиент игры
+    reader, writer = await asyncio.open_connection(host, port)
+    request = (f"GET /api/v1/game/state HTTP/1.1\r\nHost: {host}\r\n"
+               f"Authorization: Bearer {token}\r\n\r\n").encode()
+    while time.monotonic() < deadline:
+        writer.write(request)
+        headers = await reader.readuntil(b"\r\n\r\n")
+        length = next(int(line.split(b":")[1]) for line in headers.split(b"\r\n")
+                      if line.lower().startswith(b"content-length:"))
+        await reader.readexactly(length)
+        counter[0] += 1
+    writer.close()
+
+
+async def subscribe(host, port, token, deadline, counter):
+    async with websockets.connect(f"ws://{host}:{port}/api/v1/game/ws",
+                                  extra_headers={"Authorization": f"Bearer {token}"}) as ws:
+        while (timeout := deadline - time.monotonic()) > 0:
+            try:
+                await asyncio.wait_for(ws.recv(), timeout)
+            except asyncio.TimeoutError:
+                break
+            counter[0] += 1
+
+
+async def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--host", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--map", default="map1")
+    parser.add_argument("--mode", choices=["poll", "ws"], default="ws")
+    parser.add_argument("--players", type=int, default=256)
+    parser.add_argument("--duration", type=float, default=30)
+    args = parser.parse_args()
+
+    tokens = [join(args.host, args.port, args.map, f"load{i}") for i in range(args.players)]
+    counter = [0]
+    deadline = time.monotonic() + args.duration
+    client = poll if args.mode == "poll" else subscribe
+    await asyncio.gather(*(client(args.host, args.port, token, deadline, counter) for token in tokens))
+    print(f"{args.mode}: {counter[0]} states, {counter[0] / args.duration:.0f} states/s")
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
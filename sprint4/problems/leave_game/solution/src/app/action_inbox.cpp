@@ -0,0 +1,49 @@
+#include "action_inbox.h"
+
+#include <algorithm>
+#include <array>
+
+#include "players.h"
+
+namespace app {
+
+namespace {
+
+// Команда хранится в ячейке игрока как индекс направления плюс один: 0 означает отсутствие команды
+constexpr std::array DIRECTIONS{model::Movement::UP, model::Movement::DOWN, model::Movement::LEFT,
+                                model::Movement::RIGHT, model::Movement::STOP};
+
+}  // namespace
+
+std::optional<std::string_view> ActionInbox::ParseDirection(std::string_view direction) noexcept {
+    for (const auto known : DIRECTIONS) {
+        if (direction == known) {
+            return known;
+        }
+    }
+    return std::nullopt;
+}
+
+void ActionInbox::Push(const std::shared_ptr<Player>& player, std::string_view direction) {
+    const auto it = std::find(DIRECTIONS.begin(), DIRECTIONS.end(), direction);
+    if (it == DIRECTIONS.end()) {
+        return;
+    }
+    if (player->SetPendingMove(static_cast<std::uint8_t>(it - DIRECTIONS.begin() + 1))) {
+        moved_.Push(player);
+    }
+}
+
+std::size_t ActionInbox::Drain(Players& players) {
+    return moved_.ConsumeAll([&players](std::shared_ptr<Player>&& player) {
+        // Команда забирается и у покинувшего игру игрока, чтобы следующая снова поставила его в очередь
+        const auto move = player->TakePendingMove();
+        const auto it = players.GetList().find(player->GetId());
+        if (move == 0 || it == players.GetList().end() || it->second != player) {
+            return;
+        }
+        player->DogMove(DIRECTIONS[move - 1], player->GetSession()->GetMap()->GetDogSpeed());
+    });
+}
+
+}  // namespace app
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "token.h"
+#include "../util/mpsc_queue.h"
+
+namespace app {
+
+class Player;
+class Players;
+
+/**
+ * Входящие команды движения собак. Команды принимаются из любого потока без блокировок
+ * и применяются одним проходом в начале тика. У каждого игрока одна ячейка для команды:
+ * новая команда заменяет неприменённую, поэтому из нескольких команд игрока за тик действует последняя,
+ * а память очереди ограничена числом игроков
+ */
+class ActionInbox {
+public:
+    ActionInbox() = default;
+
+    // Необработанные команды не входят в состояние приложения: копия начинает с пустой очереди,
+    // а при присваивании очередь сохраняет свои команды
+    ActionInbox(const ActionInbox&) noexcept {}
+    ActionInbox& operator=(const ActionInbox&) noexcept { return *this; }
+
+    /**
+     * Проверяет направление движения
+     * @param direction направление из запроса
+     * @return то же направление в виде константы model::Movement или nullopt, если направление неизвестно
+     */
+    static std::optional<std::string_view> ParseDirection(std::string_view direction) noexcept;
+
+    /**
+     * Запоминает команду движения игрока. Можно вызывать из любого потока
+     * @param player игрок. Команды игроков, покинувших игру к началу тика, отбрасываются
+     * @param direction направление, полученное от ParseDirection
+     */
+    void Push(const std::shared_ptr<Player>& player, std::string_view direction);
+
+    /**
+     * Применяет последнюю команду каждого игрока, получившего команды с прошлого вызова. Вызывается в api_strand
+     * @param players игроки
+     * @return количество игроков, получивших команды
+     */
+    std::size_t Drain(Players& players);
+
+private:
+    // Игроки, у которых появилась команда. Игрок попадает в очередь, только когда его ячейка была пуста
+    util::MpscQueue<std::shared_ptr<Player>> moved_;
+};
+
+}  // namespace app
@@ -87,6 +87,14 @@ Players& Application::GetPlayers() & noexcept {
     return players_;
 }
 
+/**
+ * Получить входящие команды движения собак
+ * @return ActionInbox
+ */
+ActionInbox& Application::GetActionInbox() noexcept {
+    return actions_;
+}
+
 /**
  * Получить игровую модель
  * @return Игровая модель
@@ -100,6 +108,8 @@ const model::Game& Application::GetGameModel() const noexcept {
  * @param tick время
  */
 void Application::Tick(std::chrono::milliseconds tick){
+    // Команды, поступившие с прошлого тика, применяются до перемещения собак
+    actions_.Drain(players_);
     game_.Update(tick);
     for (auto& listener: listeners_) {
         if(listener){
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "../json/json_loader.h"
+#include "action_inbox.h"
 #include "players.h"
 #include "application_listener.h"
 
@@ -32,6 +33,7 @@ public:
     std::shared_ptr<Player> FindPlayer(const Token &token);
     const Players& GetPlayers() const & noexcept;
     Players& GetPlayers() & noexcept;
+    ActionInbox& GetActionInbox() noexcept;
     const model::Game& GetGameModel() const noexcept;
     void Tick(std::chrono::milliseconds tick);
     void SetRandomSpawn(bool enable) noexcept;
@@ -49,6 +51,7 @@ private:
     fs::path config_;
     model::Game game_;
     Players players_;
+    ActionInbox actions_;
     static inline std::atomic<uint64_t> dog_id_ = 0;
     bool enable_random_spawn = false;
     bool enable_tick_mode = false;
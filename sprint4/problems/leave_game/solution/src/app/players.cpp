@@ -37,7 +37,11 @@ std::shared_ptr<model::Dog> Player::GetDog() & noexcept {
  */
 void Player::DogMove(std::string_view dir, model::DimensionDouble speed){
     if(dog_){
-        dog_->Move(dir, speed);
+        // Скорость и направление собаки входят в состояние сессии. Повторная команда его не меняет,
+        // и версия сессии остаётся прежней
+        if (dog_->Move(dir, speed) && session_) {
+            session_->MarkDogChanged(dog_->GetId());
+        }
     }
 }
 
@@ -55,7 +59,8 @@ Player::Id Player::GetId() const noexcept{
  * @return Указатель на константу Player
  */
 std::shared_ptr<Player> PlayerTokens::FindPlayer(const Token& token) {
-    return token_to_player_.contains(token) ? token_to_player_.at(token) : nullptr;
+    const auto it = token_to_player_.find(token);
+    return it != token_to_player_.end() ? it->second : nullptr;
 }
 
 /**
@@ -63,9 +68,7 @@ std::shared_ptr<Player> PlayerTokens::FindPlayer(const Token& token) {
  * @param token токен
  */
 void PlayerTokens::DeleteTokenPlayer(const Token& token) {
-    if(token_to_player_.contains(token)){
-        token_to_player_.erase(token);
-    }
+    token_to_player_.erase(token);
 }
 
 /**
@@ -97,14 +100,15 @@ void PlayerTokens::AddPlayerWithToken(const app::Token& token, const app::Player
 }
 
 /**
- * Получить Токен
+ * Получить новый случайный Токен
  * @return Токен
  */
 Token PlayerTokens::GetToken() {
-    std::stringstream ss;
-    ss << std::setw(16) << std::setfill('0') << std::hex << generator1_();
-    ss << std::setw(16) << std::setfill('0') << std::hex << generator2_();
-    return Token(ss.str());
+    if (token_batch_pos_ == token_batch_.size()) {
+        GenerateTokenValues(token_batch_);
+        token_batch_pos_ = 0;
+    }
+    return Token{token_batch_[token_batch_pos_++]};
 }
 
 /**
@@ -117,6 +121,7 @@ std::pair<Token, Player&> Players::AddPlayer(const model::Dog::Id& id, const std
     auto player_shrd = std::make_shared<Player>(app::Player::Id::New(), *session->FindDog(id), session);
     auto it = players_.emplace(player_shrd->GetId(), player_shrd);
     auto Token = tokens_.AddPlayer(player_shrd);
+    ++version_;
     return {Token, *it.first->second};
 }
 
@@ -144,6 +149,7 @@ void Players::DeleteByToken(const Token& token) {
         }
         players_.erase(player->GetId());
         tokens_.DeleteTokenPlayer(token);
+        ++version_;
     }
 }
 
@@ -163,4 +169,12 @@ const PlayerTokens& Players::GetPlayerTokens() const noexcept {
     return tokens_;
 }
 
+/**
+ * Возвращает версию набора игроков
+ * @return версия набора игроков
+ */
+std::uint64_t Players::GetVersion() const noexcept {
+    return version_;
+}
+
 } // namespace app
\ No newline at end of file
@@ -2,13 +2,15 @@
 
 #include <boost/container_hash/hash.hpp>
 
-#include <random>
-#include <sstream>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <deque>
-#include <iomanip>
 #include <utility>
 
+#include "token.h"
 #include "../model/model.h"
+#include "../util/flat_hash_map.h"
 #include "../util/tagged_uuid.h"
 
 namespace serialization {
@@ -17,12 +19,9 @@ namespace serialization {
 
 namespace app {
 namespace detail {
-    struct TokenTag {};
     struct PlayerTag {};
 }  // namespace detail
 
-using Token = util::Tagged<std::string, detail::TokenTag>;
-
 class Player {
 public:
     using Id = util::TaggedUUID<detail::PlayerTag>;
@@ -31,6 +30,11 @@ public:
             id_(std::move(id)), dog_(std::move(dog)), session_(std::move(session)) {
     }
 
+    // Неприменённая команда движения не входит в состояние игрока и не копируется
+    Player(const Player& other) :
+            id_(other.id_), dog_(other.dog_), session_(other.session_) {
+    }
+
     [[nodiscard]] std::shared_ptr<const model::GameSession> GetSession() const & noexcept;
 
     std::shared_ptr<model::GameSession> GetSession() & noexcept;
@@ -43,10 +47,29 @@ public:
 
     [[nodiscard]] Id GetId() const noexcept;
 
+    /**
+     * Запоминает команду движения до начала тика, заменяя предыдущую. Можно вызывать из любого потока
+     * @param move код команды ActionInbox, не 0
+     * @return true, если у игрока не было неприменённой команды
+     */
+    bool SetPendingMove(std::uint8_t move) noexcept {
+        return pending_move_.exchange(move, std::memory_order_acq_rel) == 0;
+    }
+
+    /**
+     * Забирает неприменённую команду движения. Вызывается в api_strand
+     * @return код команды ActionInbox или 0, если команды нет
+     */
+    std::uint8_t TakePendingMove() noexcept {
+        return pending_move_.exchange(0, std::memory_order_acq_rel);
+    }
+
 private:
     Id id_;
     std::shared_ptr<model::Dog> dog_;
     std::shared_ptr<model::GameSession> session_;
+    // Последняя команда движения, полученная после начала прошлого тика (0 - нет команды)
+    std::atomic<std::uint8_t> pending_move_{0};
 };
 }; // namespace app
 
@@ -63,8 +86,7 @@ namespace app {
 class PlayerTokens {
     friend class serialization::PlayersRepr;
 public:
-    using TokenHasher = util::TaggedHasher<Token>;
-    using TokenToPlayer = std::unordered_map<Token, std::shared_ptr<Player>, TokenHasher>;
+    using TokenToPlayer = util::FlatHashMap<Token, std::shared_ptr<Player>, TokenHasher>;
 
     PlayerTokens() = default;
     PlayerTokens(const PlayerTokens& other):
@@ -79,7 +101,7 @@ public:
     std::shared_ptr<Player> FindPlayer(const Token& token);
     void DeleteTokenPlayer(const Token& token);
     Token AddPlayer(std::shared_ptr<Player> player);
-    static inline constexpr uint8_t GetTokenLenght() noexcept{ return 32; }
+    static inline constexpr uint8_t GetTokenLenght() noexcept{ return TOKEN_HEX_LENGTH; }
     const TokenToPlayer& GetTokenToPlayer() const noexcept;
 
 private:
@@ -87,15 +109,11 @@ private:
     Token GetToken();
 
 private:
-    std::random_device random_device_;
-    std::mt19937_64 generator1_{[this] {
-        std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};
-    std::mt19937_64 generator2_{[this] {
-        std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};
+    // Токены запрашиваются у генератора ОС пачками, чтобы не делать системный вызов на каждого игрока
+    constexpr static std::size_t TOKEN_BATCH_SIZE = 64;
+
+    std::array<TokenValue, TOKEN_BATCH_SIZE> token_batch_{};
+    std::size_t token_batch_pos_ = TOKEN_BATCH_SIZE;
 
     TokenToPlayer token_to_player_;
 };
@@ -112,8 +130,15 @@ public:
     const PlayerList& GetList() const noexcept;
     const PlayerTokens& GetPlayerTokens() const noexcept;
 
+    /**
+     * Версия набора игроков. Увеличивается при каждом входе и выходе игрока
+     * @return версия набора игроков
+     */
+    [[nodiscard]] std::uint64_t GetVersion() const noexcept;
+
 private:
     PlayerList players_;
     PlayerTokens tokens_;
+    std::uint64_t version_ = 0;
 };
 } // namespace app
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "token.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/random.h>
+#include <cerrno>
+#endif
+
+namespace app {
+namespace {
+
+// Значение шестнадцатеричной цифры или 0x80 для недопустимого символа
+constexpr std::array<std::uint8_t, 256> HEX_DIGITS = [] {
+    std::array<std::uint8_t, 256> digits{};
+    digits.fill(0x80);
+    for (std::uint8_t i = 0; i < 10; ++i) {
+        digits['0' + i] = i;
+    }
+    for (std::uint8_t i = 0; i < 6; ++i) {
+        digits['a' + i] = 10 + i;
+        digits['A' + i] = 10 + i;
+    }
+    return digits;
+}();
+
+constexpr std::string_view LOWER_HEX_DIGITS = "0123456789abcdef";
+
+/**
+ * Разбирает 16 шестнадцатеричных цифр
+ * @param hex цифры
+ * @param invalid накапливает признак недопустимого символа (бит 0x80)
+ * @return 64-битное значение
+ */
+std::uint64_t DecodeHex64(const char* hex, std::uint8_t& invalid) noexcept {
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < 16; ++i) {
+        const std::uint8_t digit = HEX_DIGITS[static_cast<unsigned char>(hex[i])];
+        invalid |= digit;
+        value = (value << 4) | (digit & 0x0F);
+    }
+    return value;
+}
+
+void EncodeHex64(std::uint64_t value, char* hex) noexcept {
+    for (std::size_t i = 16; i-- > 0; value >>= 4) {
+        hex[i] = LOWER_HEX_DIGITS[value & 0x0F];
+    }
+}
+
+void FillRandom(void* data, std::size_t size) {
+#ifdef __linux__
+    auto* bytes = static_cast<unsigned char*>(data);
+    while (size > 0) {
+        const ssize_t result = ::getrandom(bytes, size, 0);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::system_category(), "getrandom");
+        }
+        bytes += result;
+        size -= static_cast<std::size_t>(result);
+    }
+#else
+    std::random_device random_device;
+    auto* bytes = static_cast<unsigned char*>(data);
+    for (std::size_t i = 0; i < size; i += sizeof(unsigned)) {
+        const unsigned value = random_device();
+        std::memcpy(bytes + i, &value, std::min(sizeof(value), size - i));
+    }
+#endif
+}
+
+}  // namespace
+
+std::optional<Token> TokenFromHex(std::string_view hex) noexcept {
+    if (hex.size() != TOKEN_HEX_LENGTH) {
+        return std::nullopt;
+    }
+    std::uint8_t invalid = 0;
+    const TokenValue value{DecodeHex64(hex.data(), invalid), DecodeHex64(hex.data() + 16, invalid)};
+    if (invalid & 0x80) {
+        return std::nullopt;
+    }
+    return Token{value};
+}
+
+std::string TokenToHex(const Token& token) {
+    std::string hex(TOKEN_HEX_LENGTH, '0');
+    EncodeHex64((*token).high, hex.data());
+    EncodeHex64((*token).low, hex.data() + 16);
+    return hex;
+}
+
+void GenerateTokenValues(std::span<TokenValue> values) {
+    FillRandom(values.data(), values.size_bytes());
+    for (auto& value : values) {
+        // Нулевое значение обозначает пустую ячейку индекса токенов
+        while (value == TokenValue{}) {
+            FillRandom(&value, sizeof(value));
+        }
+    }
+}
+
+std::ostream& operator<<(std::ostream& out, const TokenValue& value) {
+    return out << TokenToHex(Token{value});
+}
+
+}  // namespace app
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "../util/tagged.h"
+
+namespace app {
+namespace detail {
+    struct TokenTag {};
+}  // namespace detail
+
+/**
+ * 128-битное значение токена. Нулевое значение зарезервировано и токеном не выдаётся
+ */
+struct TokenValue {
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+
+    auto operator<=>(const TokenValue&) const = default;
+};
+
+using Token = util::Tagged<TokenValue, detail::TokenTag>;
+
+// Длина токена в шестнадцатеричной записи
+constexpr std::size_t TOKEN_HEX_LENGTH = 32;
+
+/**
+ * Разбирает токен из шестнадцатеричной записи (цифры в любом регистре) без ветвлений по символам
+ * @param hex TOKEN_HEX_LENGTH шестнадцатеричных цифр
+ * @return токен или nullopt, если запись некорректна
+ */
+std::optional<Token> TokenFromHex(std::string_view hex) noexcept;
+
+/**
+ * @return шестнадцатеричная запись токена в нижнем регистре
+ */
+std::string TokenToHex(const Token& token);
+
+/**
+ * Заполняет values случайными ненулевыми значениями из криптографически стойкого генератора ОС
+ * одним обращением к нему
+ */
+void GenerateTokenValues(std::span<TokenValue> values);
+
+std::ostream& operator<<(std::ostream& out, const TokenValue& value);
+
+/**
+ * Хешер токенов. Токены случайны, поэтому младшего слова достаточно для равномерного распределения
+ */
+struct TokenHasher {
+    std::size_t operator()(const Token& token) const noexcept {
+        return static_cast<std::size_t>((*token).low ^ ((*token).high * 0x9E3779B97F4A7C15ull));
+    }
+};
+
+}  // namespace app
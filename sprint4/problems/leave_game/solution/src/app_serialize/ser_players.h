@@ -47,7 +47,7 @@ namespace serialization {
 
         explicit PlayersRepr(const app::Players &players) {
             for (auto &[token, player] : players.GetPlayerTokens().GetTokenToPlayer()) {
-                players_.emplace_back(*token, PlayerRepr(*player));
+                players_.emplace_back(app::TokenToHex(token), PlayerRepr(*player));
             }
         }
 
@@ -58,7 +58,11 @@ namespace serialization {
                 auto it = players.players_.emplace(player_repr.GetId(),
                                      std::make_shared<app::Player>(player_repr.GetId(),
                                                                    *session->FindDog(player_repr.GetDogId()), session));
-                players.tokens_.AddPlayerWithToken(app::Token{token}, *it.first->second);
+                const auto parsed_token = app::TokenFromHex(token);
+                if (!parsed_token) {
+                    throw std::runtime_error("Invalid player token in saved state");
+                }
+                players.tokens_.AddPlayerWithToken(*parsed_token, *it.first->second);
             }
             return players;
         }
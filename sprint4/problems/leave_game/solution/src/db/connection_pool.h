@@ -2,10 +2,13 @@
 
 #include <pqxx/connection>
 
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
 
+#include "../metrics/metrics.h"
+
 namespace data_base {
     class ConnectionPool {
         using PoolType = ConnectionPool;
@@ -48,7 +51,16 @@ namespace data_base {
             }
         }
 
+        /**
+         * Включает учёт времени ожидания соединения. Вызывается до первого GetConnection
+         * @param histogram гистограмма времени ожидания (nullptr - без учёта)
+         */
+        void SetWaitHistogram(metrics::Histogram* histogram) noexcept {
+            wait_histogram_ = histogram;
+        }
+
         ConnectionWrapper GetConnection() {
+            const auto wait_start = wait_histogram_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
             std::unique_lock lock{mutex_};
             // Блокируем текущий поток и ждём, пока cond_var_ не получит уведомление
             // и не освободится хотя бы одно соединение
@@ -56,6 +68,9 @@ namespace data_base {
                 return used_connections_ < pool_.size();
             });
             // После выхода из цикла ожидания мьютекс остаётся захваченным
+            if (wait_histogram_) {
+                wait_histogram_->Record(std::chrono::steady_clock::now() - wait_start);
+            }
 
             return {std::move(pool_[used_connections_++]), *this};
         }
@@ -76,5 +91,6 @@ namespace data_base {
         std::condition_variable cond_var_;
         std::vector<ConnectionPtr> pool_;
         size_t used_connections_ = 0;
+        metrics::Histogram* wait_histogram_ = nullptr;
     };
 } // namespace postgres
\ No newline at end of file
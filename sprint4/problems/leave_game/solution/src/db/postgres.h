@@ -73,6 +73,7 @@ public:
     explicit Database(size_t capacity, const std::string& db_url);
 
     app::UnitOfWorkFactory& GetUnitOfWorkFactory() { return unit_factory_; }
+    ConnectionPool& GetConnectionPool() noexcept { return connection_pool_; }
 private:
     ConnectionPool connection_pool_;
     UnitOfWorkFactoryImpl unit_factory_{connection_pool_};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <boost/beast/core/file.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace http_server {
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+/**
+ * Тело ответа - участок открытого файла [offset, offset + size).
+ * Сессия отправляет такое тело системным вызовом sendfile(2) без копирования через
+ * пользовательские буферы. Writer используется, только если тело сериализуется
+ * обычным http::async_write: он читает файл фрагментами, как http::file_body
+ */
+struct FileRegionBody {
+    class value_type {
+    public:
+        value_type() = default;
+        value_type(value_type&&) = default;
+        value_type& operator=(value_type&&) = default;
+
+        /**
+         * Открывает файл на чтение. Участок охватывает весь файл
+         * @param path путь к файлу
+         * @param ec код ошибки
+         */
+        void Open(const char* path, beast::error_code& ec) {
+            file_.open(path, beast::file_mode::scan, ec);
+            if (ec) {
+                return;
+            }
+            offset_ = 0;
+            size_ = file_.size(ec);
+        }
+
+        /**
+         * Ограничивает участок файла
+         * @param offset смещение от начала файла
+         * @param size длина участка
+         */
+        void SetRegion(std::uint64_t offset, std::uint64_t size) {
+            offset_ = offset;
+            size_ = size;
+        }
+
+        [[nodiscard]] bool IsOpen() const { return file_.is_open(); }
+        [[nodiscard]] std::uint64_t GetOffset() const noexcept { return offset_; }
+        [[nodiscard]] std::uint64_t GetSize() const noexcept { return size_; }
+        [[nodiscard]] beast::file& GetFile() noexcept { return file_; }
+
+    private:
+        beast::file file_;
+        std::uint64_t offset_ = 0;
+        std::uint64_t size_ = 0;
+    };
+
+    static std::uint64_t size(const value_type& body) {
+        return body.GetSize();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(http::header<isRequest, Fields>& /*header*/, value_type& body)
+            : body_(body)
+            , remain_(body.GetSize()) {
+        }
+
+        void init(beast::error_code& ec) {
+            body_.GetFile().seek(body_.GetOffset(), ec);
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            const auto amount = static_cast<std::size_t>(std::min<std::uint64_t>(remain_, buffer_.size()));
+            if (amount == 0) {
+                ec = {};
+                return boost::none;
+            }
+            const auto bytes_read = body_.GetFile().read(buffer_.data(), amount, ec);
+            if (ec) {
+                return boost::none;
+            }
+            if (bytes_read == 0) {
+                // Файл оказался короче заявленного участка
+                ec = http::error::short_read;
+                return boost::none;
+            }
+            remain_ -= bytes_read;
+            return {{const_buffers_type{buffer_.data(), bytes_read}, remain_ > 0}};
+        }
+
+    private:
+        value_type& body_;
+        std::uint64_t remain_;
+        std::array<char, 4096> buffer_{};
+    };
+};
+
+}  // namespace http_server
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace http_server {
+
+/**
+ * Память для обработчиков асинхронных операций одной сессии.
+ * Освобождённые блоки не возвращаются в кучу, а кэшируются и переиспользуются
+ * следующими операциями. Поскольку сессия выполняет один и тот же цикл
+ * "чтение - обработка - запись", после первых запросов все блоки берутся из кэша.
+ *
+ * Блок может освобождаться в потоке io_context вне strand сессии
+ * (Asio освобождает память операции до вызова обработчика), поэтому кэш защищён мьютексом.
+ * @tparam CacheSize сколько освобождённых блоков хранится в кэше
+ */
+template <std::size_t CacheSize>
+class RecyclingMemory {
+public:
+    RecyclingMemory() = default;
+
+    RecyclingMemory(const RecyclingMemory&) = delete;
+    RecyclingMemory& operator=(const RecyclingMemory&) = delete;
+
+    ~RecyclingMemory() {
+        for (auto& block : cache_) {
+            if (block.data != nullptr) {
+                ::operator delete(static_cast<std::byte*>(block.data) - HEADER_SIZE);
+            }
+        }
+    }
+
+    void* Allocate(std::size_t size) {
+        {
+            std::lock_guard lock{mutex_};
+            // Берём наименьший подходящий блок из кэша
+            Block* best = nullptr;
+            for (auto& block : cache_) {
+                if (block.data != nullptr && block.size >= size && (best == nullptr || block.size < best->size)) {
+                    best = &block;
+                }
+            }
+            if (best != nullptr) {
+                void* data = best->data;
+                *best = Block{};
+                return data;
+            }
+        }
+        // Размер блока хранится перед данными, чтобы при освобождении вернуть его в кэш
+        auto* header = static_cast<std::size_t*>(::operator new(HEADER_SIZE + size));
+        *header = size;
+        return reinterpret_cast<std::byte*>(header) + HEADER_SIZE;
+    }
+
+    void Deallocate(void* data) noexcept {
+        std::size_t size = *reinterpret_cast<std::size_t*>(static_cast<std::byte*>(data) - HEADER_SIZE);
+        {
+            std::lock_guard lock{mutex_};
+            for (auto& block : cache_) {
+                if (block.data == nullptr) {
+                    block = Block{data, size};
+                    return;
+                }
+            }
+        }
+        ::operator delete(static_cast<std::byte*>(data) - HEADER_SIZE);
+    }
+
+private:
+    struct Block {
+        void* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    // Заголовок с размером блока, выровненный так, чтобы данные оставались выровнены
+    static constexpr std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    std::mutex mutex_;
+    std::array<Block, CacheSize> cache_{};
+};
+
+// Столько блоков одновременно используют операции чтения и записи одной сессии
+using HandlerMemory = RecyclingMemory<8>;
+
+// Память полей запросов сессии: request-target и по блоку на поле заголовка у каждого запроса конвейера
+using FieldsMemory = RecyclingMemory<64>;
+
+/**
+ * Аллокатор, выделяющий память из HandlerMemory.
+ * Привязывается к обработчикам через net::bind_allocator, после чего Asio и Beast
+ * размещают в HandlerMemory состояние составных операций
+ */
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept
+        : memory_(&memory) {
+    }
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : memory_(other.memory_) {
+    }
+
+    T* allocate(std::size_t n) const {
+        return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, std::size_t /*n*/) const noexcept {
+        memory_->Deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+private:
+    template <typename> friend class HandlerAllocator;
+    HandlerMemory* memory_;
+};
+
+/**
+ * Аллокатор полей запроса (http::basic_fields). Сессия читает запросы в поля с памятью FieldsMemory,
+ * поэтому request-target и поля заголовка следующих запросов занимают блоки, освобождённые предыдущими.
+ * Запрос передаётся обработчику во владение и может пережить сессию, поэтому аллокатор разделяет
+ * владение памятью. Аллокатор по умолчанию (запросы, созданные вне сессии) выделяет память в куче
+ */
+template <typename T>
+class FieldsAllocator {
+public:
+    using value_type = T;
+    // Как у std::allocator: присваивание запроса забирает память вместе с полями
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    FieldsAllocator() noexcept = default;
+
+    explicit FieldsAllocator(std::shared_ptr<FieldsMemory> memory) noexcept
+        : memory_(std::move(memory)) {
+    }
+
+    template <typename U>
+    FieldsAllocator(const FieldsAllocator<U>& other) noexcept  // NOLINT(google-explicit-constructor)
+        : memory_(other.memory_) {
+    }
+
+    T* allocate(std::size_t n) const {
+        if (!memory_) {
+            return std::allocator<T>{}.allocate(n);
+        }
+        return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, std::size_t n) const noexcept {
+        if (!memory_) {
+            return std::allocator<T>{}.deallocate(p, n);
+        }
+        memory_->Deallocate(p);
+    }
+
+    template <typename U>
+    bool operator==(const FieldsAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+private:
+    template <typename> friend class FieldsAllocator;
+    std::shared_ptr<FieldsMemory> memory_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+
+#include "handler_memory.h"
+
+namespace http_server {
+
+namespace http = boost::beast::http;
+
+// Запрос, который сессия передаёт обработчику. Поля заголовка размещаются в памяти сессии
+// и переиспользуются следующими запросами (см. FieldsAllocator)
+using RequestFields = http::basic_fields<FieldsAllocator<char>>;
+using HttpRequest = http::request<http::string_body, RequestFields>;
+
+}  // namespace http_server
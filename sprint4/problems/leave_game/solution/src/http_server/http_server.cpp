@@ -1,14 +1,34 @@
 #include "http_server.h"
 
 #include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <cstring>
 #include <iostream>
 
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#ifdef BOOST_ASIO_HAS_FILE
+#include <unistd.h>
+#endif
+
 namespace http_server {
 
 void ReportError(beast::error_code ec, std::string_view what) {
     server_logging::Logger::LogError(ec, what);
 }
 
+std::optional<tcp::endpoint> ToTcpEndpoint(const Endpoint& endpoint) {
+    const int family = endpoint.protocol().family();
+    if (family != AF_INET && family != AF_INET6) {
+        return std::nullopt;
+    }
+    tcp::endpoint result;
+    std::memcpy(result.data(), endpoint.data(), endpoint.size());
+    result.resize(endpoint.size());
+    return result;
+}
+
 void SessionBase::Run() {
     // Вызываем метод Read, используя executor объекта stream_.
     // Таким образом вся работа со stream_ будет выполняться, используя его executor
@@ -16,51 +36,334 @@ void SessionBase::Run() {
                   beast::bind_front_handler(&SessionBase::Read, GetSharedThis()));
 }
 
-tcp::endpoint SessionBase::GetEndpoint() const {
+Endpoint SessionBase::GetEndpoint() const {
     return stream_.socket().remote_endpoint();
 }
 
+Stream::executor_type SessionBase::GetExecutor() {
+    return stream_.get_executor();
+}
+
+
+void SessionBase::Flush() {
+    using namespace std::literals;
+    if (write_in_progress_) {
+        return;
+    }
+    // Собираем подряд идущие готовые ответы в одну операцию записи
+    write_buffers_.clear();
+    std::size_t request_number = next_response_;
+    for (; request_number < next_request_; ++request_number) {
+        const auto& pending = GetPending(request_number);
+        if (!pending.ready || pending.write) {
+            break;
+        }
+        write_buffers_.emplace_back(net::buffer(pending.data));
+        if (pending.body.size() > 0) {
+            write_buffers_.emplace_back(pending.body);
+        }
+        if (pending.close) {
+            // Ответы после закрывающего соединение не отправляются
+            ++request_number;
+            break;
+        }
+    }
+
+    if (!write_buffers_.empty()) {
+        writing_ = request_number - next_response_;
+        write_in_progress_ = true;
+        stream_.expires_after(30s);
+        net::async_write(stream_, std::span<const net::const_buffer>(write_buffers_),
+                         net::bind_allocator(GetHandlerAllocator(),
+                                             beast::bind_front_handler(&SessionBase::OnWrite, GetSharedThis())));
+        return;
+    }
+
+    // Ответ, который не сериализуется в память, отправляется отдельной операцией
+    if (request_number < next_request_) {
+        auto& pending = GetPending(request_number);
+        if (pending.ready && pending.write) {
+            writing_ = 1;
+            write_in_progress_ = true;
+            auto write = std::move(pending.write);
+            pending.write = nullptr;
+            stream_.expires_after(30s);
+            write(*this);
+        }
+    }
+}
+
+void SessionBase::WriteFileRegion(std::shared_ptr<FileRegionResponse> response) {
+    auto transfer = std::make_shared<FileTransfer>();
+    transfer->offset = response->body().GetOffset();
+    transfer->remain = response->body().GetSize();
+
+    // Сериализуем только заголовок: тело отправим отдельно
+    if (auto ec = Serialize(*response, transfer->header, true)) {
+        return OnWrite(ec, 0);
+    }
+    transfer->response = std::move(response);
+
+    net::async_write(stream_, net::buffer(transfer->header),
+                     net::bind_allocator(GetHandlerAllocator(),
+                                         [self = GetSharedThis(), transfer](beast::error_code ec, std::size_t bytes_written) {
+                                             transfer->bytes_written += bytes_written;
+                                             if (ec) {
+                                                 return self->OnWrite(ec, transfer->bytes_written);
+                                             }
+                                             if (self->use_sendfile_) {
+                                                 self->SendFileRegion(transfer);
+                                             } else {
+                                                 self->CopyFileRegion(transfer);
+                                             }
+                                         }));
+}
+
+void SessionBase::SendFileRegion(std::shared_ptr<FileTransfer> transfer) {
+#ifdef __linux__
+    using namespace std::literals;
+    // Поток отправляет за раз не больше одной порции, затем уступает его другим сессиям
+    constexpr std::uint64_t MAX_CHUNK = 1 << 20;
+    auto& socket = stream_.socket();
+    beast::error_code ec;
+    socket.native_non_blocking(true, ec);
+    if (ec) {
+        return CopyFileRegion(std::move(transfer));
+    }
+    const int file_fd = transfer->response->body().GetFile().native_handle();
+
+    while (transfer->remain > 0) {
+        auto offset = static_cast<off_t>(transfer->offset);
+        const ssize_t sent = ::sendfile(socket.native_handle(), file_fd, &offset,
+                                        static_cast<std::size_t>(std::min(transfer->remain, MAX_CHUNK)));
+        if (sent > 0) {
+            transfer->offset += sent;
+            transfer->remain -= sent;
+            transfer->bytes_written += sent;
+            if (transfer->remain > 0) {
+                net::post(stream_.get_executor(), net::bind_allocator(GetHandlerAllocator(), [self = GetSharedThis(), transfer] {
+                    self->SendFileRegion(transfer);
+                }));
+                return;
+            }
+            continue;
+        }
+        if (sent == 0) {
+            // Файл оказался короче заявленного участка
+            return OnWrite(http::error::short_read, transfer->bytes_written);
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Буфер сокета заполнен - продолжим, когда сокет снова будет готов к записи.
+            // Если клиент не читает ответ, ожидание отменяется по таймеру и сессия завершается
+            send_timer_.expires_after(30s);
+            send_timer_.async_wait(net::bind_allocator(GetHandlerAllocator(), [self = GetSharedThis()](beast::error_code ec) {
+                // Таймер мог сработать одновременно с готовностью сокета и после перезапуска для следующего ожидания
+                if (!ec && self->send_timer_.expiry() <= std::chrono::steady_clock::now()) {
+                    self->stream_.socket().cancel(ec);
+                }
+            }));
+            socket.async_wait(Protocol::socket::wait_write,
+                              net::bind_allocator(GetHandlerAllocator(),
+                                                  [self = GetSharedThis(), transfer](beast::error_code ec) {
+                                                      self->send_timer_.cancel();
+                                                      if (ec == net::error::operation_aborted) {
+                                                          ec = beast::error::timeout;
+                                                      }
+                                                      if (ec) {
+                                                          return self->OnWrite(ec, transfer->bytes_written);
+                                                      }
+                                                      self->SendFileRegion(transfer);
+                                                  }));
+            return;
+        }
+        if (errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP) {
+            // Файловая система или сокет не поддерживают sendfile
+            return CopyFileRegion(std::move(transfer));
+        }
+        return OnWrite(beast::error_code{errno, sys::system_category()}, transfer->bytes_written);
+    }
+    OnWrite({}, transfer->bytes_written);
+#else
+    CopyFileRegion(std::move(transfer));
+#endif
+}
+
+void SessionBase::CopyFileRegion(std::shared_ptr<FileTransfer> transfer) {
+    constexpr std::size_t BUFFER_SIZE = 64 * 1024;
+    if (transfer->remain == 0) {
+        return OnWrite({}, transfer->bytes_written);
+    }
+    transfer->buffer.resize(BUFFER_SIZE);
+    const auto amount = static_cast<std::size_t>(std::min<std::uint64_t>(transfer->remain, BUFFER_SIZE));
 
-void SessionBase::OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+#ifdef BOOST_ASIO_HAS_FILE
+    // С бэкендом io_uring файл читается асинхронно и не блокирует поток сессии
+    if (!transfer->file) {
+        const int file_fd = ::dup(transfer->response->body().GetFile().native_handle());
+        if (file_fd < 0) {
+            return OnWrite(beast::error_code{errno, sys::system_category()}, transfer->bytes_written);
+        }
+        transfer->file.emplace(stream_.get_executor(), file_fd);
+    }
+    transfer->file->async_read_some_at(transfer->offset, net::buffer(transfer->buffer.data(), amount),
+                                       net::bind_allocator(GetHandlerAllocator(),
+                                                           [self = GetSharedThis(), transfer](beast::error_code ec, std::size_t bytes_read) {
+                                                               if (ec == net::error::eof) {
+                                                                   ec = http::error::short_read;
+                                                               }
+                                                               if (ec) {
+                                                                   return self->OnWrite(ec, transfer->bytes_written);
+                                                               }
+                                                               self->WriteFileChunk(transfer, bytes_read);
+                                                           }));
+#else
+    auto& file = transfer->response->body().GetFile();
+    beast::error_code ec;
+    file.seek(transfer->offset, ec);
+    std::size_t bytes_read = 0;
+    if (!ec) {
+        bytes_read = file.read(transfer->buffer.data(), amount, ec);
+    }
+    if (!ec && bytes_read == 0) {
+        ec = http::error::short_read;
+    }
+    if (ec) {
+        return OnWrite(ec, transfer->bytes_written);
+    }
+    WriteFileChunk(std::move(transfer), bytes_read);
+#endif
+}
+
+void SessionBase::WriteFileChunk(std::shared_ptr<FileTransfer> transfer, std::size_t size) {
+    net::async_write(stream_, net::buffer(transfer->buffer.data(), size),
+                     net::bind_allocator(GetHandlerAllocator(),
+                                         [self = GetSharedThis(), transfer](beast::error_code ec, std::size_t bytes_written) {
+                                             transfer->offset += bytes_written;
+                                             transfer->remain -= bytes_written;
+                                             transfer->bytes_written += bytes_written;
+                                             if (ec) {
+                                                 return self->OnWrite(ec, transfer->bytes_written);
+                                             }
+                                             self->CopyFileRegion(transfer);
+                                         }));
+}
+
+void SessionBase::OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
     using namespace std::literals;
+    write_in_progress_ = false;
     if (ec) {
         return ReportError(ec, "write"sv);
     }
 
+    bool close = false;
+    for (; writing_ > 0; --writing_, ++next_response_) {
+        auto& pending = GetPending(next_response_);
+        close = close || pending.close;
+        pending.data.clear();
+        pending.body = {};
+        pending.body_owner.reset();
+        if (pending.trace) {
+            pending.trace->Stamp(tracing::Stage::WRITE_COMPLETE);
+            tracer_->Finish(std::move(pending.trace));
+        }
+        pending.ready = false;
+        pending.close = false;
+    }
+
     if (close) {
         // Семантика ответа требует закрыть соединение
+        read_closed_ = true;
+        return Close();
+    }
+
+    if (read_closed_ && InFlight() == 0) {
+        if (upgrade_pending_) {
+            // Ответы на запросы, пришедшие до запроса смены протокола, отправлены
+            return Upgrade();
+        }
+        // Клиент закрыл соединение, и все ответы ему отправлены
         return Close();
     }
 
-    // Считываем следующий запрос
-    Read();
+    // В конвейере освободилось место - читаем следующие запросы
+    ResumeRead();
+    Flush();
+}
+
+void SessionBase::ResumeRead() {
+    if (!read_in_progress_ && !read_closed_ && InFlight() < pipeline_.size()) {
+        Read();
+    }
 }
 
 void SessionBase::Read() {
     using namespace std::literals;
-    // Очищаем запрос от прежнего значения (метод Read может быть вызван несколько раз)
-    request_ = {};
+    // Прежний запрос передан обработчику. Новый читается в поля с памятью сессии: парсер async_read
+    // принимает запрос вместе с аллокатором, поэтому поля занимают блоки, освобождённые прежними запросами
+    request_ = HttpRequest{std::piecewise_construct, std::make_tuple(), std::make_tuple(FieldsAllocator<char>{fields_memory_})};
+    read_in_progress_ = true;
     stream_.expires_after(30s);
     // Считываем request_ из stream_, используя buffer_ для хранения считанных данных
     http::async_read(stream_, buffer_, request_,
-            // По окончании операции будет вызван метод OnRead
-                     beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
+            // По окончании операции будет вызван метод OnRead. Состояние операции
+            // размещается в памяти сессии, а не в куче
+                     net::bind_allocator(GetHandlerAllocator(),
+                                         beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis())));
 }
 
 void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
     using namespace std::literals;
+    read_in_progress_ = false;
     if (ec == http::error::end_of_stream) {
-        // Нормальная ситуация - клиент закрыл соединение
-        return Close();
+        // Нормальная ситуация - клиент закрыл соединение.
+        // Если ответы на прочитанные запросы ещё не отправлены, соединение закроется после их записи
+        read_closed_ = true;
+        if (InFlight() == 0) {
+            Close();
+        }
+        return;
     }
     if (ec) {
+        read_closed_ = true;
         return ReportError(ec, "read"sv);
     }
-    HandleRequest(std::move(request_));
+    if (upgrade_ && beast::websocket::is_upgrade(request_)) {
+        // После запроса смены протокола по соединению идёт уже не HTTP, поэтому запросы больше не читаются.
+        // Соединение передаётся обработчику, когда отправлены ответы на все предыдущие запросы
+        read_closed_ = true;
+        if (InFlight() == 0) {
+            return Upgrade();
+        }
+        upgrade_pending_ = true;
+        return;
+    }
+    if (!request_.keep_alive()) {
+        read_closed_ = true;
+    }
+    // Не дожидаясь ответа, продолжаем читать запросы, пока в конвейере есть место.
+    // Обработчик может ответить сразу, поэтому номер запроса присваивается до вызова обработчика
+    const std::size_t request_number = next_request_++;
+    auto& trace = GetPending(request_number).trace;
+    trace = tracer_ ? tracer_->Start(request_.method_string(), request_.target()) : nullptr;
+    {
+        // Обработчик читает трассировку через tracing::CurrentTrace
+        tracing::ScopedTrace scope(trace.get());
+        HandleRequest(request_number, std::move(request_));
+    }
+    ResumeRead();
+}
+
+void SessionBase::Upgrade() {
+    upgrade_pending_ = false;
+    (*upgrade_)(stream_.release_socket(), std::move(request_));
 }
 
 void SessionBase::Close() {
-    stream_.socket().shutdown(tcp::socket::shutdown_send);
+    beast::error_code ec;
+    stream_.socket().shutdown(Protocol::socket::shutdown_send, ec);
 }
 
 }  // namespace http_server
@@ -1,14 +1,34 @@
 #pragma once
 #include "../sdk.h"
 
+#include <boost/asio/bind_allocator.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+#ifdef BOOST_ASIO_HAS_FILE
+#include <boost/asio/random_access_file.hpp>
+#endif
 
+#include <atomic>
+#include <functional>
 #include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
 
 #include "../logger/logger.h"
+#include "../tracing/tracer.h"
+#include "file_region_body.h"
+#include "handler_memory.h"
+#include "http_request.h"
+#include "shared_buffer_body.h"
 
 namespace http_server {
 
@@ -20,70 +40,324 @@ namespace http = beast::http;
 
 void ReportError(beast::error_code ec, std::string_view what);
 
+// Опция сокета SO_REUSEPORT: позволяет нескольким acceptor'ам слушать один и тот же порт,
+// ядро само распределяет входящие соединения между ними
+using ReusePort = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+// Listener и сессии работают с обобщённым потоковым протоколом: один и тот же код обслуживает
+// соединения TCP и Unix domain socket. Адрес TCP неявно преобразуется в Endpoint
+using Protocol = net::generic::stream_protocol;
+using Endpoint = Protocol::endpoint;
+using Acceptor = net::basic_socket_acceptor<Protocol>;
+
+// Сокет и поток сессии используют конкретный тип исполнителя (strand) вместо any_io_executor:
+// копирование стёртого any_io_executor со strand внутри выделяет память на каждой операции
+using Strand = net::strand<net::io_context::executor_type>;
+using StrandSocket = Protocol::socket::rebind_executor<Strand>::other;
+using Stream = beast::basic_stream<Protocol, Strand>;
+using StrandTimer = net::basic_waitable_timer<std::chrono::steady_clock, net::wait_traits<std::chrono::steady_clock>, Strand>;
+
+/**
+ * Преобразует обобщённый адрес в адрес TCP
+ * @param endpoint адрес
+ * @return адрес TCP или nullopt, если это адрес другого семейства (Unix domain socket)
+ */
+std::optional<tcp::endpoint> ToTcpEndpoint(const Endpoint& endpoint);
+
+/**
+ * Обработчик запроса на смену протокола (Upgrade: websocket). Получает сокет соединения
+ * вместе с запросом и дальше сам отвечает за соединение
+ */
+using UpgradeHandler = std::function<void(StrandSocket&& socket, HttpRequest&& request)>;
+
+/**
+ * Параметры HTTP-сервера
+ */
+struct ServerOptions {
+    // Установить SO_REUSEPORT (несколько Listener'ов на одном порту)
+    bool reuse_port = false;
+    // Максимальное количество запросов одной сессии, ответы на которые ещё не отправлены.
+    // При достижении предела сессия перестаёт читать новые запросы (backpressure)
+    std::size_t pipeline_depth = 16;
+    // Максимальное количество одновременно открытых сессий (0 - без ограничения).
+    // При достижении предела Listener приостанавливает приём соединений
+    std::size_t max_sessions = 0;
+    // Отправлять FileRegionBody системным вызовом sendfile(2). Если выключено или
+    // не поддерживается, файл копируется в сокет через буфер сессии
+    bool use_sendfile = true;
+    // Обработчик запросов на смену протокола. Если не задан, такие запросы обрабатываются
+    // как обычные. Запрос, пришедший в конвейере после других, передаётся обработчику после отправки ответов на них.
+    // Соединения, переданные обработчику, не учитываются в max_sessions: их число ограничивает обработчик
+    UpgradeHandler upgrade;
+    // Трассировка запросов (nullptr - выключена). Сессия отмечает чтение запроса, передачу ответа
+    // и завершение записи, обработчик - переходы в другие исполнители
+    std::shared_ptr<tracing::Tracer> tracer;
+};
+
+/**
+ * Тело ответа хранится в памяти и может быть заранее сериализовано в буфер сессии.
+ * Остальные тела (файлы) записываются в сокет потоково, отдельной операцией
+ */
+template <typename Body>
+constexpr bool IS_IN_MEMORY_BODY = !std::is_same_v<Body, http::file_body> && !std::is_same_v<Body, FileRegionBody>;
+
+using FileRegionResponse = http::response<FileRegionBody>;
+
+/**
+ * HTTP-сессия одного соединения. Память обработчиков операций, буферы ответов и поля запросов
+ * переиспользуются от запроса к запросу. В установившемся режиме keep-alive на запрос остаются
+ * три выделения памяти в таймере тайм-аута beast::basic_stream: таймер хранит исполнитель как any_io_executor
+ * и при каждом ожидании копирует в него strand, а операция ожидания не использует аллокатор обработчика.
+ * Тело запроса с содержимым передаётся обработчику и выделяется заново
+ */
 class SessionBase {
 public:
     // Запрещаем копирование и присваивание объектов SessionBase и его наследников
     SessionBase(const SessionBase&) = delete;
     SessionBase& operator=(const SessionBase&) = delete;
 
-    [[nodiscard]] tcp::endpoint GetEndpoint() const;
+    [[nodiscard]] Endpoint GetEndpoint() const;
+    [[nodiscard]] Stream::executor_type GetExecutor();
     void Run();
 
 protected:
-    using HttpRequest = http::request<http::string_body>;
-
-    explicit SessionBase(tcp::socket&& socket)
-        : stream_(std::move(socket)) {
+    SessionBase(StrandSocket&& socket, const ServerOptions& options)
+        : stream_(std::move(socket))
+        , send_timer_(stream_.get_executor())
+        , fields_memory_(std::make_shared<FieldsMemory>())
+        , pipeline_(std::max<std::size_t>(options.pipeline_depth, 1))
+        , use_sendfile_(options.use_sendfile)
+        , upgrade_(options.upgrade ? &options.upgrade : nullptr)
+        , tracer_(options.tracer.get()) {
+        // По два буфера на ответ: заголовок и разделяемое тело
+        write_buffers_.reserve(pipeline_.size() * 2);
     }
 
+    /**
+     * Ставит ответ в очередь отправки. Ответы отправляются строго в порядке поступления запросов
+     * @param request_number порядковый номер запроса, на который дан ответ
+     * @param response ответ
+     */
     template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields>&& response) {
-        // Запись выполняется асинхронно, поэтому response перемещаем в область кучи
-        auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
-
-        auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response,
-                          [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                            self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                          });
+    void Write(std::size_t request_number, http::response<Body, Fields>&& response) {
+        using namespace std::literals;
+        using Response = http::response<Body, Fields>;
+        auto& pending = GetPending(request_number);
+        pending.close = response.need_eof();
+
+        if constexpr (std::is_same_v<Body, SharedBufferBody>) {
+            // В буфер сессии сериализуем только заголовок, тело отправляется прямо из разделяемого буфера
+            if (auto ec = Serialize(response, pending.data, true)) {
+                ReportError(ec, "serialize"sv);
+                pending.data.clear();
+                pending.close = true;
+            } else {
+                pending.body = net::buffer(response.body().data.data(), response.body().data.size());
+                pending.body_owner = std::move(response.body().owner);
+            }
+        } else if constexpr (IS_IN_MEMORY_BODY<Body>) {
+            // Сериализуем ответ в буфер сессии, чтобы несколько готовых ответов
+            // отправить одной операцией записи. Память буфера переиспользуется
+            if (auto ec = Serialize(response, pending.data)) {
+                ReportError(ec, "serialize"sv);
+                pending.data.clear();
+                pending.close = true;
+            }
+        } else if constexpr (std::is_same_v<Response, FileRegionResponse>) {
+            // Заголовок отправляется обычной записью, тело - без копирования через sendfile
+            auto safe_response = std::make_shared<Response>(std::move(response));
+            pending.write = [safe_response](SessionBase& session) {
+                session.WriteFileRegion(safe_response);
+            };
+        } else {
+            // Запись выполняется асинхронно, поэтому response перемещаем в память сессии,
+            // которая переиспользуется от запроса к запросу
+            auto safe_response = std::allocate_shared<Response>(HandlerAllocator<Response>(handler_memory_), std::move(response));
+            pending.write = [safe_response](SessionBase& session) {
+                http::async_write(session.stream_, *safe_response,
+                                  net::bind_allocator(session.GetHandlerAllocator(),
+                                                      [safe_response, self = session.GetSharedThis()](beast::error_code ec, std::size_t bytes_written) {
+                                                          self->OnWrite(ec, bytes_written);
+                                                      }));
+            };
+        }
+        pending.ready = true;
+        Flush();
+    }
+
+    [[nodiscard]] HandlerAllocator<std::byte> GetHandlerAllocator() noexcept {
+        return HandlerAllocator<std::byte>(handler_memory_);
     }
 
     ~SessionBase() = default;
 private:
-    void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
+    // Ответ, ожидающий отправки
+    struct PendingResponse {
+        // Сериализованный ответ (заголовок и тело) или только заголовок
+        std::string data;
+        // Тело ответа в разделяемом буфере, которым владеет body_owner
+        net::const_buffer body;
+        std::shared_ptr<const void> body_owner;
+        // Потоковая запись ответа, который не сериализуется в память
+        std::function<void(SessionBase&)> write;
+        // Трассировка запроса, завершается после записи ответа
+        std::unique_ptr<tracing::RequestTrace> trace;
+        bool ready = false;
+        bool close = false;
+    };
+
+    /**
+     * Сериализует ответ в строку
+     * @param response ответ
+     * @param out строка, в конец которой дописываются данные
+     * @param header_only сериализовать только заголовок
+     * @return код ошибки
+     */
+    template <typename Body, typename Fields>
+    static beast::error_code Serialize(http::response<Body, Fields>& response, std::string& out, bool header_only = false) {
+        http::serializer<false, Body, Fields> serializer{response};
+        serializer.split(header_only);
+        beast::error_code ec;
+        while (!ec && !(header_only ? serializer.is_header_done() : serializer.is_done())) {
+            serializer.next(ec, [&serializer, &out](beast::error_code&, const auto& buffers) {
+                for (auto buffer : beast::buffers_range_ref(buffers)) {
+                    out.append(static_cast<const char*>(buffer.data()), buffer.size());
+                }
+                serializer.consume(beast::buffer_bytes(buffers));
+            });
+        }
+        return ec;
+    }
+
+    PendingResponse& GetPending(std::size_t request_number) {
+        return pipeline_[request_number % pipeline_.size()];
+    }
+
+    // Количество прочитанных запросов, ответы на которые ещё не отправлены
+    [[nodiscard]] std::size_t InFlight() const noexcept {
+        return next_request_ - next_response_;
+    }
+
+    // Состояние отправки участка файла
+    struct FileTransfer {
+        std::shared_ptr<FileRegionResponse> response;
+        // Сериализованный заголовок ответа
+        std::string header;
+        std::uint64_t offset = 0;
+        std::uint64_t remain = 0;
+        std::size_t bytes_written = 0;
+        // Буфер для копирования файла, если sendfile недоступен
+        std::vector<char> buffer;
+#ifdef BOOST_ASIO_HAS_FILE
+        // Файл, читаемый асинхронно через io_uring (копия дескриптора файла ответа)
+        std::optional<net::basic_random_access_file<Strand>> file;
+#endif
+    };
+
+    // Отправляет готовые ответы, идущие подряд с начала очереди
+    void Flush();
+
+    // Отправляет заголовок ответа, затем тело - через sendfile или копированием
+    void WriteFileRegion(std::shared_ptr<FileRegionResponse> response);
+    void SendFileRegion(std::shared_ptr<FileTransfer> transfer);
+    void CopyFileRegion(std::shared_ptr<FileTransfer> transfer);
+    // Отправляет прочитанную из файла порцию и читает следующую
+    void WriteFileChunk(std::shared_ptr<FileTransfer> transfer, std::size_t size);
+
+    void OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
+
+    // Читает следующий запрос, если в конвейере есть место
+    void ResumeRead();
 
     void Read();
 
     void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
 
+    // Передаёт соединение и запрос request_ обработчику смены протокола
+    void Upgrade();
+
     void Close();
 
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
     // Обработку запроса делегируем подклассу
-    virtual void HandleRequest(HttpRequest&& request) = 0;
-
-    // tcp_stream содержит внутри себя сокет и добавляет поддержку таймаутов
-    beast::tcp_stream stream_;
+    virtual void HandleRequest(std::size_t request_number, HttpRequest&& request) = 0;
+
+    // Память обработчиков асинхронных операций. Объявлена до stream_,
+    // чтобы пережить все операции сокета
+    HandlerMemory handler_memory_;
+    // Stream содержит внутри себя сокет и добавляет поддержку таймаутов
+    Stream stream_;
+    // Ограничивает ожидание готовности сокета при отправке через sendfile: таймаут stream_
+    // распространяется только на его собственные операции
+    StrandTimer send_timer_;
     beast::flat_buffer buffer_;
+    // Память полей запросов. Разделяется с запросами, переданными обработчику
+    std::shared_ptr<FieldsMemory> fields_memory_;
     HttpRequest request_;
+
+    // Кольцевой буфер ответов размером pipeline_depth, индексируемый номером запроса
+    std::vector<PendingResponse> pipeline_;
+    // Буферы текущей операции записи (по одному на ответ)
+    std::vector<net::const_buffer> write_buffers_;
+    // Номер следующего прочитанного запроса
+    std::size_t next_request_ = 0;
+    // Номер запроса, ответ на который будет отправлен следующим
+    std::size_t next_response_ = 0;
+    // Количество ответов в текущей операции записи
+    std::size_t writing_ = 0;
+    bool read_in_progress_ = false;
+    bool write_in_progress_ = false;
+    // Клиент закрыл соединение или запросил его закрытие - новые запросы не читаем
+    bool read_closed_ = false;
+    // Прочитан запрос смены протокола, который ждёт отправки ответов на предыдущие запросы
+    bool upgrade_pending_ = false;
+    bool use_sendfile_;
+    // Указывает на ServerOptions::upgrade Listener'а, который живёт дольше сессии
+    const UpgradeHandler* upgrade_;
+    // Указывает на ServerOptions::tracer Listener'а
+    tracing::Tracer* tracer_;
 };
 
+template <typename RequestHandler>
+class Listener;
+
 template <typename RequestHandler>
 class Session : public SessionBase, public std::enable_shared_from_this<Session<RequestHandler>> {
 public:
     template <typename Handler>
-    Session(tcp::socket&& socket, Handler&& request_handler)
-        : SessionBase(std::move(socket))
-        , request_handler_(std::forward<Handler>(request_handler)) {
+    Session(StrandSocket&& socket, Handler&& request_handler, const ServerOptions& options,
+            std::shared_ptr<Listener<RequestHandler>> listener)
+        : SessionBase(std::move(socket), options)
+        , request_handler_(std::forward<Handler>(request_handler))
+        , listener_(std::move(listener)) {
+    }
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+    ~Session() {
+        // Сообщаем Listener'у о закрытии сессии, чтобы он мог возобновить приём соединений
+        listener_->OnSessionClosed();
     }
 
 private:
-    void HandleRequest(HttpRequest&& request) override {
+    void HandleRequest(std::size_t request_number, HttpRequest&& request) override {
         // Захватываем умный указатель на текущий объект Session в лямбде,
         // чтобы продлить время жизни сессии до вызова лямбды.
         // Используется generic-лямбда функция, способная принять response произвольного типа
-        request_handler_(GetEndpoint(),  std::move(request), [self = this->shared_from_this()](auto&& response) {
-            self->Write(std::move(response));
+        // Ответ может быть сформирован в другом исполнителе (например, в api_strand),
+        // поэтому запись в сокет выполняем в исполнителе сессии.
+        // Номер запроса определяет место ответа в очереди отправки.
+        // Трассировка принадлежит очереди отправки и живёт до записи ответа, поэтому лямбда хранит указатель
+        request_handler_(GetEndpoint(),  std::move(request), [self = this->shared_from_this(), request_number,
+                                                              trace = tracing::CurrentTrace()](auto&& response) {
+            if (trace) {
+                trace->SetStatus(response.result_int());
+                trace->Stamp(tracing::Stage::HANDLER_END);
+            }
+            net::dispatch(self->GetExecutor(), [self, request_number, safe_response = std::move(response)]() mutable {
+                self->Write(request_number, std::move(safe_response));
+            });
         });
     }
 
@@ -93,6 +367,7 @@ private:
 
 private:
     RequestHandler request_handler_;
+    std::shared_ptr<Listener<RequestHandler>> listener_;
 };
 
 /// Listener принимает соединения клиентов и асинхронно выполняет обработку запросов
@@ -100,28 +375,45 @@ template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
 public:
     template <typename Handler>
-    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler);
+    Listener(net::io_context& ioc, const Endpoint& endpoint, Handler&& request_handler, ServerOptions options = {});
 
     void Run() { DoAccept(); }
 
+    [[nodiscard]] Endpoint GetLocalEndpoint() const { return acceptor_.local_endpoint(); }
+
+    /// Количество открытых сессий
+    [[nodiscard]] std::size_t GetActiveSessions() const noexcept { return active_sessions_.load(std::memory_order_relaxed); }
+
+    /// Сколько раз приём соединений приостанавливался из-за предела max_sessions
+    [[nodiscard]] std::size_t GetAcceptPauses() const noexcept { return accept_pauses_.load(std::memory_order_relaxed); }
+
+    /// Вызывается сессией при её разрушении
+    void OnSessionClosed();
+
 private:
     net::io_context& ioc_;
-    tcp::acceptor acceptor_;
+    Acceptor acceptor_;
     RequestHandler request_handler_;
+    ServerOptions options_;
+    std::atomic<std::size_t> active_sessions_{0};
+    std::atomic<std::size_t> accept_pauses_{0};
+    // Приём соединений приостановлен. Изменяется только в strand acceptor_
+    bool accept_paused_ = false;
 
     void DoAccept();
-    void OnAccept(sys::error_code ec, tcp::socket socket);
-    void AsyncRunSession(tcp::socket&& socket);
+    void OnAccept(sys::error_code ec, StrandSocket socket);
+    void AsyncRunSession(StrandSocket&& socket);
 };
 
 template <typename RequestHandler>
 template <typename Handler>
-Listener<RequestHandler>::Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler)
+Listener<RequestHandler>::Listener(net::io_context& ioc, const Endpoint& endpoint, Handler&& request_handler, ServerOptions options)
         : ioc_(ioc)
         // Обработчики асинхронных операций acceptor_ будут вызываться в своём strand
         ,
           acceptor_(net::make_strand(ioc)),
-          request_handler_(std::forward<Handler>(request_handler)) {
+          request_handler_(std::forward<Handler>(request_handler)),
+          options_(options) {
     // Открываем acceptor, используя протокол (IPv4 или IPv6), указанный в endpoint
     acceptor_.open(endpoint.protocol());
 
@@ -130,6 +422,10 @@ Listener<RequestHandler>::Listener(net::io_context& ioc, const tcp::endpoint& en
     // Однако это может помешать повторно открыть сокет в полузакрытом состоянии.
     // Флаг reuse_address разрешает открыть сокет, когда он "наполовину закрыт"
     acceptor_.set_option(net::socket_base::reuse_address(true));
+    // В шардированном режиме на одном порту слушают несколько acceptor'ов (по одному на io_context)
+    if (options_.reuse_port) {
+        acceptor_.set_option(ReusePort(true));
+    }
     // Привязываем acceptor к адресу и порту endpoint
     acceptor_.bind(endpoint);
     // Переводим acceptor в состояние, в котором он способен принимать новые соединения
@@ -155,7 +451,7 @@ void Listener<RequestHandler>::DoAccept() {
 }
 
 template <typename RequestHandler>
-void Listener<RequestHandler>::OnAccept(sys::error_code ec, tcp::socket socket) {
+void Listener<RequestHandler>::OnAccept(sys::error_code ec, StrandSocket socket) {
     using namespace std::literals;
 
     if (ec) {
@@ -165,22 +461,60 @@ void Listener<RequestHandler>::OnAccept(sys::error_code ec, tcp::socket socket)
     // Асинхронно обрабатываем сессию
     AsyncRunSession(std::move(socket));
 
+    if (options_.max_sessions != 0 && active_sessions_.load() >= options_.max_sessions) {
+        // Новые соединения остаются в очереди ядра, пока одна из сессий не закроется
+        accept_paused_ = true;
+        ++accept_pauses_;
+        server_logging::Logger::LogInfo(boost::json::value{{"active_sessions"s, active_sessions_.load()},
+                                                           {"max_sessions"s, options_.max_sessions}},
+                                        "accept paused"sv);
+        return;
+    }
+
     // Принимаем новое соединение
     DoAccept();
 }
 
 template <typename RequestHandler>
-void Listener<RequestHandler>::AsyncRunSession(tcp::socket&& socket) {
-    std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_)->Run();
+void Listener<RequestHandler>::OnSessionClosed() {
+    using namespace std::literals;
+    // Флаг accept_paused_ и запуск приёма соединений обрабатываются в strand acceptor_,
+    // поэтому закрытие сессии не может разойтись с решением о приостановке приёма
+    net::post(acceptor_.get_executor(), [self = this->shared_from_this()] {
+        --self->active_sessions_;
+        if (self->accept_paused_ && self->active_sessions_.load() < self->options_.max_sessions) {
+            self->accept_paused_ = false;
+            server_logging::Logger::LogInfo(boost::json::value{{"active_sessions"s, self->active_sessions_.load()}},
+                                            "accept resumed"sv);
+            self->DoAccept();
+        }
+    });
+}
+
+template <typename RequestHandler>
+void Listener<RequestHandler>::AsyncRunSession(StrandSocket&& socket) {
+    ++active_sessions_;
+    std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_, options_,
+                                              this->shared_from_this())->Run();
 }
 
+/**
+ * Запускает приём HTTP-соединений
+ * @param ioc контекст, в котором будут работать acceptor и сессии
+ * @param endpoint адрес и порт
+ * @param handler обработчик запросов
+ * @param options параметры сервера
+ * @return Listener, через который можно получить счётчики сессий
+ */
 template <typename RequestHandler>
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler) {
+auto ServeHttp(net::io_context& ioc, const Endpoint& endpoint, RequestHandler&& handler, ServerOptions options = {}) {
     // При помощи decay_t исключим ссылки из типа RequestHandler,
     // чтобы Listener хранил RequestHandler по значению
     using MyListener = Listener<std::decay_t<RequestHandler>>;
 
-    std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler))->Run();
+    auto listener = std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler), options);
+    listener->Run();
+    return listener;
 }
 
 }  // namespace http_server
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core/error.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+
+namespace http_server {
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+/**
+ * Тело ответа - участок неизменяемого буфера в памяти, которым владеет owner.
+ * Несколько ответов разделяют один буфер без копирования, а сессия отправляет
+ * тело прямо из него, сериализуя в свой буфер только заголовок
+ */
+struct SharedBufferBody {
+    struct value_type {
+        // Владелец памяти, на которую указывает data
+        std::shared_ptr<const void> owner;
+        std::string_view data;
+    };
+
+    static std::uint64_t size(const value_type& body) {
+        return body.data.size();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(http::header<isRequest, Fields>& /*header*/, const value_type& body)
+            : body_(body) {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            return {{const_buffers_type{body_.data.data(), body_.data.size()}, false}};
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+}  // namespace http_server
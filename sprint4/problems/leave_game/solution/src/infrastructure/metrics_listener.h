@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../app/application.h"
+#include "../metrics/server_metrics.h"
+
+namespace infrastructure {
+    /**
+     * Обновляет после каждого тика количество игровых сессий, собак и потерянных предметов.
+     * OnTick вызывается в api_strand, поэтому модель игры читается без блокировок
+     */
+    class MetricsListener: public app::ApplicationListener {
+    public:
+        MetricsListener(app::Application& application, metrics::ServerMetrics& metrics):
+            application_(application), metrics_(metrics) {
+        }
+
+        void OnTick([[maybe_unused]] std::chrono::milliseconds tick) override {
+            const auto& sessions = application_.GetGameModel().GetSessions();
+            std::size_t dogs = 0;
+            std::size_t lost_objects = 0;
+            for (const auto& session : sessions) {
+                dogs += session->GetDogs().size();
+                lost_objects += session->GetLoots().size();
+            }
+            metrics_.GetSessions().Set(static_cast<double>(sessions.size()));
+            metrics_.GetDogs().Set(static_cast<double>(dogs));
+            metrics_.GetLostObjects().Set(static_cast<double>(lost_objects));
+        }
+
+    private:
+        app::Application& application_;
+        metrics::ServerMetrics& metrics_;
+    };
+}
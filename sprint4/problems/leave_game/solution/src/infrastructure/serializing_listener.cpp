@@ -1,11 +1,22 @@
 #include "serializing_listener.h"
 
+#include <sstream>
+
 namespace infrastructure {
+namespace sys = boost::system;
 
 void SerializingListener::OnTick(std::chrono::milliseconds tick) {
     time_since_save_ += tick;
     if (time_since_save_ >= save_period_) {
+#ifdef BOOST_ASIO_HAS_FILE
+    if (executor_) {
+        SaveAsync();
+    } else {
+        Save();
+    }
+#else
     Save();
+#endif
     time_since_save_ = 0ms;
     }
 }
@@ -15,6 +26,7 @@ void SerializingListener::Save() const {
     if (state_file_.empty()){
         return;
     }
+    const auto start = std::chrono::steady_clock::now();
     std::filesystem::path temp_file = state_file_;
     temp_file += ".temp";
     std::ofstream state_strm(temp_file);
@@ -23,8 +35,23 @@ void SerializingListener::Save() const {
         throw std::logic_error("The "s + temp_file.string() + " file was not opened");
     }
 
+    WriteState(state_strm);
+    state_strm.close();
+
+    std::filesystem::rename(temp_file, state_file_);
+    if (save_histogram_) {
+        save_histogram_->Record(std::chrono::steady_clock::now() - start);
+    }
+}
+
+void SerializingListener::SetSaveHistogram(metrics::Histogram* histogram) noexcept {
+    save_histogram_ = histogram;
+}
+
+void SerializingListener::WriteState(std::ostream& strm) const {
+    using namespace std::string_literals;
     try {
-        OutputArchive output_archive{state_strm};
+        OutputArchive output_archive{strm};
         output_archive << serialization::ApplicationRepr{application_};
 
         /*Логирование*/{
@@ -34,15 +61,65 @@ void SerializingListener::Save() const {
             server_logging::Logger::LogInfo(obj, "serialization");
         }
 
-    } catch (const std::system_error& e) {
+    } catch (const sys::system_error& e) {
         server_logging::Logger::LogError(e.code(), "Serialization error "s + e.what());
         throw std::runtime_error("Save:: serialization error"s + e.what());
     } catch (const std::exception& e) {
         throw std::runtime_error("Save:: serialization error"s + e.what());
     }
+}
 
-    std::filesystem::rename(temp_file, state_file_);
+#ifdef BOOST_ASIO_HAS_FILE
+/**
+ * Сериализует приложение в память и записывает файл через io_uring.
+ * Если предыдущая запись ещё не завершилась, сохранение пропускается до следующего периода
+ */
+void SerializingListener::SaveAsync() {
+    using namespace std::string_literals;
+    if (state_file_.empty() || *save_in_progress_) {
+        return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::ostringstream state_strm;
+    WriteState(state_strm);
+    auto data = std::make_shared<std::string>(std::move(state_strm).str());
+
+    // Отдельный временный файл: синхронное сохранение при остановке сервера не пересекается с незавершённой записью
+    std::filesystem::path temp_file = state_file_;
+    temp_file += ".async.temp";
+    auto file = std::make_shared<net::stream_file>(executor_);
+    sys::error_code open_ec;
+    file->open(temp_file.string(), net::file_base::write_only | net::file_base::create | net::file_base::truncate, open_ec);
+    if (open_ec) {
+        server_logging::Logger::LogError(open_ec, "state file open");
+        throw std::logic_error("The "s + temp_file.string() + " file was not opened");
+    }
+
+    *save_in_progress_ = true;
+    net::async_write(*file, net::buffer(*data),
+                     [file, data, temp_file, state_file = state_file_, in_progress = save_in_progress_,
+                      histogram = save_histogram_, start](sys::error_code ec, std::size_t) {
+                         *in_progress = false;
+                         sys::error_code close_ec;
+                         file->close(close_ec);
+                         if (!ec) {
+                             ec = close_ec;
+                         }
+                         if (ec) {
+                             return server_logging::Logger::LogError(ec, "state file write");
+                         }
+                         std::error_code rename_ec;
+                         std::filesystem::rename(temp_file, state_file, rename_ec);
+                         if (rename_ec) {
+                             return server_logging::Logger::LogError(sys::error_code{rename_ec.value(), sys::system_category()},
+                                                                     "state file rename");
+                         }
+                         if (histogram) {
+                             histogram->Record(std::chrono::steady_clock::now() - start);
+                         }
+                     });
 }
+#endif
 
 void SerializingListener::Load(){
     using namespace std::string_literals;
@@ -68,7 +145,7 @@ void SerializingListener::Load(){
             }
         }
         application_ = application;
-    } catch (const std::system_error& e) {
+    } catch (const sys::system_error& e) {
         server_logging::Logger::LogError(e.code(), "Serialization error "s + e.what());
         throw std::runtime_error("Load:: serialization error"s + e.what());
     } catch (const std::exception& e) {
@@ -10,33 +10,60 @@
 #include "../app/application.h"
 #include "../app_serialize/ser_app.h"
 #include "../logger/logger.h"
+#include "../metrics/metrics.h"
 
 namespace infrastructure {
 using milliseconds = std::chrono::milliseconds;
 using namespace std::literals;
 
 namespace fs = std::filesystem;
+namespace net = boost::asio;
 class SerializingListener: public app::ApplicationListener {
 public:
     using InputArchive = boost::archive::text_iarchive;
     using OutputArchive = boost::archive::text_oarchive;
 
-    SerializingListener(app::Application& application, fs::path state_file, milliseconds save_period):
+    /**
+     * @param application приложение
+     * @param state_file файл состояния
+     * @param save_period период сохранения
+     * @param executor исполнитель, в котором вызывается OnTick (api_strand). Если задан и Asio
+     * собран с поддержкой файлов (бэкенд io_uring), периодическое сохранение записывает файл
+     * асинхронно, не блокируя игровой strand. Иначе файл записывается синхронно
+     */
+    SerializingListener(app::Application& application, fs::path state_file, milliseconds save_period,
+                        net::any_io_executor executor = {}):
             application_(application), state_file_(std::move(state_file)),
-            save_period_(save_period), time_since_save_(0ms) {
+            save_period_(save_period), time_since_save_(0ms), executor_(std::move(executor)) {
     }
 
     void OnTick(std::chrono::milliseconds tick) override;
     void Save() const;
     void Load();
 
+    /**
+     * Включает учёт времени сохранения: от начала сериализации до записи файла
+     * @param histogram гистограмма времени сохранения (nullptr - без учёта)
+     */
+    void SetSaveHistogram(metrics::Histogram* histogram) noexcept;
+
     [[nodiscard]] const fs::path& GetStateFilePath() const noexcept;
 
 private:
+    // Сериализует приложение в поток
+    void WriteState(std::ostream& strm) const;
+#ifdef BOOST_ASIO_HAS_FILE
+    void SaveAsync();
+#endif
+
     app::Application& application_;
     fs::path state_file_;
     milliseconds save_period_;
     milliseconds time_since_save_;
+    net::any_io_executor executor_;
+    // Выполняется асинхронная запись. Общий для копий слушателя, изменяется только в executor_
+    std::shared_ptr<bool> save_in_progress_ = std::make_shared<bool>(false);
+    metrics::Histogram* save_histogram_ = nullptr;
 };
 
 } // namespace infrastructure
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "json_model_writer.h"
+
+#include <optional>
+#include <type_traits>
+
+#include "tag_invoke_utils.h"
+
+namespace model {
+    using namespace detail;
+
+    namespace {
+        template <typename T>
+        void WriteOptional(JsonWriter& writer, std::string_view key, const std::optional<T>& value) {
+            if (!value) {
+                return;
+            }
+            writer.Key(key);
+            if constexpr (std::is_same_v<T, std::string>) {
+                writer.String(*value);
+            } else if constexpr (std::is_floating_point_v<T>) {
+                writer.Double(*value);
+            } else {
+                writer.Int(*value);
+            }
+        }
+
+        template <typename Container>
+        void WriteArray(JsonWriter& writer, std::string_view key, const Container& container) {
+            writer.Key(key);
+            writer.StartArray();
+            for (const auto& element : container) {
+                WriteJson(writer, element);
+            }
+            writer.EndArray();
+        }
+    }  // namespace
+
+    void WriteJson(JsonWriter& writer, const Road& road) {
+        writer.StartObject();
+        writer.Key(MapKey::START_X);
+        writer.Int(road.GetStart().x);
+        writer.Key(MapKey::START_Y);
+        writer.Int(road.GetStart().y);
+        if (road.IsHorizontal()) {
+            writer.Key(MapKey::END_X);
+            writer.Int(road.GetEnd().x);
+        } else if (road.IsVertical()) {
+            writer.Key(MapKey::END_Y);
+            writer.Int(road.GetEnd().y);
+        }
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const Building& building) {
+        const auto& bounds = building.GetBounds();
+        writer.StartObject();
+        writer.Key(MapKey::POS_X);
+        writer.Int(bounds.position.x);
+        writer.Key(MapKey::POS_Y);
+        writer.Int(bounds.position.y);
+        writer.Key(MapKey::WIDTH);
+        writer.Int(bounds.size.width);
+        writer.Key(MapKey::HEIGHT);
+        writer.Int(bounds.size.height);
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const Office& office) {
+        writer.StartObject();
+        writer.Key(MapKey::ID);
+        writer.String(*office.GetId());
+        writer.Key(MapKey::POS_X);
+        writer.Double(office.GetPosition().x);
+        writer.Key(MapKey::POS_Y);
+        writer.Double(office.GetPosition().y);
+        writer.Key(MapKey::OFFSET_X);
+        writer.Int(office.GetOffset().dx);
+        writer.Key(MapKey::OFFSET_Y);
+        writer.Int(office.GetOffset().dy);
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const Loot& loot) {
+        writer.StartObject();
+        writer.Key(LootKey::TYPE);
+        writer.Uint(loot.GetType());
+        writer.Key(LootKey::POSITION);
+        writer.StartArray();
+        writer.Double(loot.GetPosition().x);
+        writer.Double(loot.GetPosition().y);
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const LootType& loot_type) {
+        writer.StartObject();
+        WriteOptional(writer, LootKey::NAME, loot_type.name);
+        WriteOptional(writer, LootKey::FILE, loot_type.file);
+        WriteOptional(writer, LootKey::TYPE, loot_type.type);
+        WriteOptional(writer, LootKey::ROTATION, loot_type.rotation);
+        WriteOptional(writer, LootKey::COLOR, loot_type.color);
+        WriteOptional(writer, LootKey::SCALE, loot_type.scale);
+        writer.Key(LootKey::VALUE);
+        writer.Int(loot_type.value);
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const Map& map) {
+        writer.StartObject();
+        writer.Key(MapKey::ID);
+        writer.String(*map.GetId());
+        writer.Key(MapKey::NAME);
+        writer.String(map.GetName());
+        WriteArray(writer, MapKey::ROADS, map.GetRoads());
+        WriteArray(writer, MapKey::BUILDINGS, map.GetBuildings());
+        WriteArray(writer, MapKey::OFFICES, map.GetOffices());
+        WriteArray(writer, LootKey::LOOT_TYPES, map.GetLootTypes());
+        writer.EndObject();
+    }
+
+    void WriteJson(JsonWriter& writer, const Game::Maps& maps) {
+        writer.StartArray();
+        for (const auto& map : maps) {
+            writer.StartObject();
+            writer.Key(MapKey::ID);
+            writer.String(*map->GetId());
+            writer.Key(MapKey::NAME);
+            writer.String(map->GetName());
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+
+    void WriteJson(JsonWriter& writer, const Dog::Bag& bag) {
+        writer.StartArray();
+        for (const auto& loot : bag) {
+            writer.StartObject();
+            writer.Key(LootKey::ID);
+            writer.Uint(*loot.id);
+            writer.Key(LootKey::TYPE);
+            writer.Uint(loot.type);
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+
+    void WriteJson(JsonWriter& writer, const Dog& dog) {
+        writer.StartObject();
+        writer.Key(UserKey::POSITION);
+        writer.StartArray();
+        writer.Double(dog.GetPosition().x);
+        writer.Double(dog.GetPosition().y);
+        writer.EndArray();
+        writer.Key(UserKey::SPEED);
+        writer.StartArray();
+        writer.Double(dog.GetSpeed().dx);
+        writer.Double(dog.GetSpeed().dy);
+        writer.EndArray();
+        writer.Key(UserKey::DIRECTION);
+        writer.String(dog.GetDirection());
+        writer.Key(LootKey::BAG);
+        WriteJson(writer, dog.GetBag());
+        writer.Key(LootKey::SCORE);
+        writer.Int(dog.GetScore());
+        writer.EndObject();
+    }
+} // namespace model
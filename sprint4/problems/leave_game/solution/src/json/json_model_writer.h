@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+
+#include "json_writer.h"
+#include "../model/model.h"
+
+namespace model {
+    // Потоковые сериализаторы модели. Записывают те же документы, что и tag_invoke из tag_invoke_model.h,
+    // но сразу в текст, без boost::json::value. tag_invoke остаются для кода, которому нужен документ
+    void WriteJson(detail::JsonWriter& writer, const Road& road);
+    void WriteJson(detail::JsonWriter& writer, const Building& building);
+    void WriteJson(detail::JsonWriter& writer, const Office& office);
+    void WriteJson(detail::JsonWriter& writer, const Loot& loot);
+    void WriteJson(detail::JsonWriter& writer, const LootType& loot_type);
+    void WriteJson(detail::JsonWriter& writer, const Map& map);
+    void WriteJson(detail::JsonWriter& writer, const Game::Maps& maps);
+    void WriteJson(detail::JsonWriter& writer, const Dog::Bag& bag);
+    void WriteJson(detail::JsonWriter& writer, const Dog& dog);
+
+    /**
+     * Сериализует объект модели в строку
+     * @param value объект, для которого есть перегрузка WriteJson
+     * @return JSON-текст
+     */
+    template <typename T>
+    std::string SerializeJson(const T& value) {
+        std::string out;
+        detail::JsonWriter writer(out);
+        WriteJson(writer, value);
+        return out;
+    }
+} // namespace model
@@ -0,0 +1,452 @@
+#include "json_object_reader.h"
+
+#include <climits>
+#include <limits>
+
+namespace detail {
+
+namespace {
+
+constexpr bool IsDigit(char c) noexcept {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool InRange(unsigned char c, unsigned char low, unsigned char high) noexcept {
+    return c >= low && c <= high;
+}
+
+/**
+ * Длина корректной последовательности UTF-8 (таблица 3-7 стандарта Unicode: без избыточных форм и суррогатов)
+ * @param text текст, начинающийся с первого байта последовательности не из ASCII
+ * @return длина последовательности или 0, если она некорректна
+ */
+std::size_t Utf8SequenceSize(std::string_view text) noexcept {
+    auto byte = [&text](std::size_t i) {
+        return static_cast<unsigned char>(text[i]);
+    };
+    auto tail = [&text, &byte](std::size_t from, std::size_t size) {
+        if (text.size() < size) {
+            return false;
+        }
+        for (std::size_t i = from; i < size; ++i) {
+            if (!InRange(byte(i), 0x80, 0xbf)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    const unsigned char lead = byte(0);
+    if (InRange(lead, 0xc2, 0xdf)) {
+        return tail(1, 2) ? 2 : 0;
+    }
+    if (InRange(lead, 0xe0, 0xef)) {
+        if (text.size() < 3) {
+            return 0;
+        }
+        const unsigned char low = lead == 0xe0 ? 0xa0 : 0x80;
+        const unsigned char high = lead == 0xed ? 0x9f : 0xbf;
+        return InRange(byte(1), low, high) && tail(2, 3) ? 3 : 0;
+    }
+    if (InRange(lead, 0xf0, 0xf4)) {
+        if (text.size() < 4) {
+            return 0;
+        }
+        const unsigned char low = lead == 0xf0 ? 0x90 : 0x80;
+        const unsigned char high = lead == 0xf4 ? 0x8f : 0xbf;
+        return InRange(byte(1), low, high) && tail(2, 4) ? 4 : 0;
+    }
+    return 0;
+}
+
+void AppendUtf8(std::string& out, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+        out.push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else if (code_point < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+    }
+}
+
+}  // namespace
+
+bool JsonObjectReader::Next() {
+    switch (state_) {
+        case State::START:
+            SkipWhitespace();
+            if (AtEnd() || Peek() != '{') {
+                break;
+            }
+            ++pos_;
+            SkipWhitespace();
+            if (!AtEnd() && Peek() == '}') {
+                ++pos_;
+                Finish();
+                return false;
+            }
+            state_ = State::MEMBERS;
+            if (ReadMember()) {
+                return true;
+            }
+            break;
+        case State::MEMBERS:
+            SkipWhitespace();
+            if (AtEnd()) {
+                break;
+            }
+            if (Peek() == '}') {
+                ++pos_;
+                Finish();
+                return false;
+            }
+            if (Peek() == ',') {
+                ++pos_;
+                SkipWhitespace();
+                if (ReadMember()) {
+                    return true;
+                }
+            }
+            break;
+        case State::DONE:
+        case State::FAILED:
+            return false;
+    }
+    state_ = State::FAILED;
+    return false;
+}
+
+bool JsonObjectReader::ReadMember() {
+    if (!ReadString(key_buffer_, key_)) {
+        return false;
+    }
+    SkipWhitespace();
+    if (AtEnd() || Peek() != ':') {
+        return false;
+    }
+    ++pos_;
+    SkipWhitespace();
+    return ReadValue();
+}
+
+bool JsonObjectReader::ReadValue() {
+    if (AtEnd()) {
+        return false;
+    }
+    switch (Peek()) {
+        case '"':
+            kind_ = Kind::STRING;
+            return ReadString(string_buffer_, string_);
+        case '{':
+        case '[': {
+            // Вложенные значения перезаписывают kind_, поэтому вид поля задаётся после пропуска
+            const Kind kind = Peek() == '{' ? Kind::OBJECT : Kind::ARRAY;
+            if (!SkipContainer(2)) {
+                return false;
+            }
+            kind_ = kind;
+            return true;
+        }
+        case 't':
+            kind_ = Kind::BOOL;
+            return ReadLiteral("true");
+        case 'f':
+            kind_ = Kind::BOOL;
+            return ReadLiteral("false");
+        case 'n':
+            kind_ = Kind::NUL;
+            return ReadLiteral("null");
+        default:
+            return ReadNumber();
+    }
+}
+
+/**
+ * Читает строку. Строка без escape-последовательностей возвращается как часть тела,
+ * иначе раскодируется в buffer
+ * @param buffer буфер для раскодированной строки
+ * @param value прочитанное значение
+ * @return false, если строка некорректна
+ */
+bool JsonObjectReader::ReadString(std::string& buffer, std::string_view& value) {
+    if (AtEnd() || Peek() != '"') {
+        return false;
+    }
+    const std::size_t begin = ++pos_;
+    bool escaped = false;
+    while (!AtEnd()) {
+        const auto c = static_cast<unsigned char>(Peek());
+        if (c == '"') {
+            if (!escaped) {
+                value = body_.substr(begin, pos_ - begin);
+            } else {
+                value = buffer;
+            }
+            ++pos_;
+            return true;
+        }
+        if (c < 0x20) {
+            return false;
+        }
+        if (c == '\\') {
+            if (!escaped) {
+                buffer.assign(body_.substr(begin, pos_ - begin));
+                escaped = true;
+            }
+            ++pos_;
+            if (!ReadEscape(buffer)) {
+                return false;
+            }
+            continue;
+        }
+        const std::size_t size = c < 0x80 ? 1 : Utf8SequenceSize(body_.substr(pos_));
+        if (size == 0) {
+            return false;
+        }
+        if (escaped) {
+            buffer.append(body_.substr(pos_, size));
+        }
+        pos_ += size;
+    }
+    return false;
+}
+
+/**
+ * Раскодирует escape-последовательность после обратной косой черты. Суррогаты UTF-16
+ * должны образовывать пару, как и в boost::json
+ * @param buffer строка, в конец которой дописывается символ
+ * @return false, если последовательность некорректна
+ */
+bool JsonObjectReader::ReadEscape(std::string& buffer) {
+    auto read_hex4 = [this](std::uint32_t& code) {
+        if (body_.size() - pos_ < 4) {
+            return false;
+        }
+        code = 0;
+        for (std::size_t i = 0; i < 4; ++i) {
+            const char c = body_[pos_++];
+            code <<= 4;
+            if (IsDigit(c)) {
+                code |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                code |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                code |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (AtEnd()) {
+        return false;
+    }
+    switch (body_[pos_++]) {
+        case '"':
+            buffer.push_back('"');
+            return true;
+        case '\\':
+            buffer.push_back('\\');
+            return true;
+        case '/':
+            buffer.push_back('/');
+            return true;
+        case 'b':
+            buffer.push_back('\b');
+            return true;
+        case 'f':
+            buffer.push_back('\f');
+            return true;
+        case 'n':
+            buffer.push_back('\n');
+            return true;
+        case 'r':
+            buffer.push_back('\r');
+            return true;
+        case 't':
+            buffer.push_back('\t');
+            return true;
+        case 'u':
+            break;
+        default:
+            return false;
+    }
+    std::uint32_t code = 0;
+    if (!read_hex4(code)) {
+        return false;
+    }
+    if (code >= 0xdc00 && code <= 0xdfff) {
+        return false;
+    }
+    if (code >= 0xd800 && code <= 0xdbff) {
+        std::uint32_t low = 0;
+        if (body_.substr(pos_, 2) != "\\u" || (pos_ += 2, !read_hex4(low)) || low < 0xdc00 || low > 0xdfff) {
+            return false;
+        }
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+    }
+    AppendUtf8(buffer, code);
+    return true;
+}
+
+/**
+ * Читает число и определяет его тип так же, как boost::json: целые без дробной части и экспоненты
+ * становятся int64, если помещаются в него, затем uint64, остальные - double
+ * @return false, если число некорректно
+ */
+bool JsonObjectReader::ReadNumber() {
+    const bool negative = Peek() == '-';
+    if (negative) {
+        ++pos_;
+    }
+    if (AtEnd() || !IsDigit(Peek())) {
+        return false;
+    }
+    std::uint64_t mantissa = 0;
+    bool is_double = false;
+    if (Peek() == '0') {
+        ++pos_;
+    } else {
+        constexpr std::uint64_t MAX = std::numeric_limits<std::uint64_t>::max();
+        while (!AtEnd() && IsDigit(Peek())) {
+            const unsigned digit = Peek() - '0';
+            if (mantissa > MAX / 10 || (mantissa == MAX / 10 && digit > MAX % 10)) {
+                is_double = true;
+            } else {
+                mantissa = mantissa * 10 + digit;
+            }
+            ++pos_;
+        }
+    }
+    if (!AtEnd() && Peek() == '.') {
+        is_double = true;
+        ++pos_;
+        if (AtEnd() || !IsDigit(Peek())) {
+            return false;
+        }
+        while (!AtEnd() && IsDigit(Peek())) {
+            ++pos_;
+        }
+    }
+    if (!AtEnd() && (Peek() == 'e' || Peek() == 'E')) {
+        is_double = true;
+        ++pos_;
+        if (!AtEnd() && (Peek() == '+' || Peek() == '-')) {
+            ++pos_;
+        }
+        if (AtEnd() || !IsDigit(Peek())) {
+            return false;
+        }
+        // boost::json отвергает показатель, не помещающийся в int
+        unsigned exponent = 0;
+        while (!AtEnd() && IsDigit(Peek())) {
+            const unsigned digit = Peek() - '0';
+            if (exponent > INT_MAX / 10 || (exponent == INT_MAX / 10 && digit > INT_MAX % 10)) {
+                return false;
+            }
+            exponent = exponent * 10 + digit;
+            ++pos_;
+        }
+    }
+
+    constexpr auto INT64_LIMIT = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+    if (is_double || (negative && mantissa > INT64_LIMIT + 1)) {
+        kind_ = Kind::DOUBLE;
+    } else if (negative) {
+        kind_ = Kind::INT64;
+        int64_ = static_cast<std::int64_t>(~mantissa + 1);
+    } else if (mantissa <= INT64_LIMIT) {
+        kind_ = Kind::INT64;
+        int64_ = static_cast<std::int64_t>(mantissa);
+    } else {
+        kind_ = Kind::UINT64;
+    }
+    return true;
+}
+
+bool JsonObjectReader::ReadLiteral(std::string_view literal) {
+    if (body_.substr(pos_, literal.size()) != literal) {
+        return false;
+    }
+    pos_ += literal.size();
+    return true;
+}
+
+/**
+ * Проверяет и пропускает вложенный массив или объект
+ * @param depth глубина пропускаемого контейнера, у читаемого объекта она равна 1
+ * @return false, если контейнер некорректен или вложен глубже MAX_DEPTH
+ */
+bool JsonObjectReader::SkipContainer(std::size_t depth) {
+    if (depth > MAX_DEPTH) {
+        return false;
+    }
+    const char close = Peek() == '{' ? '}' : ']';
+    const bool is_object = close == '}';
+    ++pos_;
+    SkipWhitespace();
+    if (!AtEnd() && Peek() == close) {
+        ++pos_;
+        return true;
+    }
+    std::string_view unused;
+    while (true) {
+        if (is_object) {
+            if (!ReadString(string_buffer_, unused)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (AtEnd() || Peek() != ':') {
+                return false;
+            }
+            ++pos_;
+            SkipWhitespace();
+        }
+        if (AtEnd()) {
+            return false;
+        }
+        if (Peek() == '{' || Peek() == '[') {
+            if (!SkipContainer(depth + 1)) {
+                return false;
+            }
+        } else if (!ReadValue()) {
+            return false;
+        }
+        SkipWhitespace();
+        if (AtEnd()) {
+            return false;
+        }
+        if (Peek() == close) {
+            ++pos_;
+            return true;
+        }
+        if (Peek() != ',') {
+            return false;
+        }
+        ++pos_;
+        SkipWhitespace();
+    }
+}
+
+// После объекта допускаются только пробельные символы
+bool JsonObjectReader::Finish() {
+    SkipWhitespace();
+    state_ = AtEnd() ? State::DONE : State::FAILED;
+    return state_ == State::DONE;
+}
+
+void JsonObjectReader::SkipWhitespace() noexcept {
+    while (!AtEnd() && (Peek() == ' ' || Peek() == '\t' || Peek() == '\n' || Peek() == '\r')) {
+        ++pos_;
+    }
+}
+
+}  // namespace detail
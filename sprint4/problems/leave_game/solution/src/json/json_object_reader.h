@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace detail {
+
+/**
+ * Последовательное чтение полей верхнего уровня JSON-объекта из тела запроса без построения документа.
+ * Принимает те же документы, что и boost::json::parse с настройками по умолчанию: строгий JSON
+ * без комментариев и завершающих запятых, корректный UTF-8, вложенность не больше MAX_DEPTH.
+ * Вложенные массивы и объекты проверяются и пропускаются. Строки без escape-последовательностей
+ * возвращаются как части тела, поэтому разбор обычного запроса не выделяет память.
+ *
+ *     JsonObjectReader reader(body);
+ *     while (reader.Next()) {
+ *         if (reader.KeyIs("move")) { ... }
+ *     }
+ *     if (!reader.IsValid()) { ... }
+ *
+ * Поля читаются по порядку, поэтому при повторяющихся ключах, как и в boost::json, действует последнее.
+ * Поле нужно использовать только после проверки IsValid: ошибка может найтись дальше в теле
+ */
+class JsonObjectReader {
+public:
+    enum class Kind { NUL, BOOL, INT64, UINT64, DOUBLE, STRING, ARRAY, OBJECT };
+
+    // Как parse_options::max_depth в boost::json
+    constexpr static std::size_t MAX_DEPTH = 32;
+
+    explicit JsonObjectReader(std::string_view body) noexcept : body_(body) {}
+
+    /**
+     * Читает следующее поле объекта
+     * @return false, если поля закончились или документ некорректен
+     */
+    bool Next();
+
+    /**
+     * Проверяет, что документ прочитан до конца и является корректным JSON-объектом
+     */
+    [[nodiscard]] bool IsValid() const noexcept {
+        return state_ == State::DONE;
+    }
+
+    [[nodiscard]] bool KeyIs(std::string_view key) const noexcept {
+        return key_ == key;
+    }
+
+    [[nodiscard]] Kind GetKind() const noexcept {
+        return kind_;
+    }
+
+    /**
+     * Значение строкового поля. Действительно до следующего вызова Next
+     */
+    [[nodiscard]] std::string_view GetString() const noexcept {
+        return string_;
+    }
+
+    /**
+     * Значение поля вида Kind::INT64
+     */
+    [[nodiscard]] std::int64_t GetInt64() const noexcept {
+        return int64_;
+    }
+
+private:
+    enum class State { START, MEMBERS, DONE, FAILED };
+
+    bool ReadMember();
+    bool ReadValue();
+    bool ReadString(std::string& buffer, std::string_view& value);
+    bool ReadEscape(std::string& buffer);
+    bool ReadNumber();
+    bool ReadLiteral(std::string_view literal);
+    bool SkipContainer(std::size_t depth);
+    bool Finish();
+    void SkipWhitespace() noexcept;
+
+    [[nodiscard]] bool AtEnd() const noexcept {
+        return pos_ == body_.size();
+    }
+
+    [[nodiscard]] char Peek() const noexcept {
+        return body_[pos_];
+    }
+
+    std::string_view body_;
+    std::size_t pos_ = 0;
+    State state_ = State::START;
+
+    std::string_view key_;
+    Kind kind_ = Kind::NUL;
+    std::string_view string_;
+    std::int64_t int64_ = 0;
+
+    // Сюда раскодируются ключ и строка со escape-последовательностями
+    std::string key_buffer_;
+    std::string string_buffer_;
+};
+
+}  // namespace detail
@@ -0,0 +1,119 @@
+#include "json_writer.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace detail {
+
+namespace {
+
+constexpr std::uint64_t ONES = 0x0101010101010101ull;
+constexpr std::uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+/**
+ * Проверяет восемь байт за одну операцию (SWAR): есть ли среди них байт, который нужно экранировать -
+ * '"', '\\' или управляющий символ меньше 0x20. Байты UTF-8 больше 0x7f экранировать не нужно
+ * @param word восемь байт строки
+ * @return true, если хотя бы один байт нужно экранировать
+ */
+constexpr bool HasEscapedByte(std::uint64_t word) noexcept {
+    auto has_zero_byte = [](std::uint64_t v) {
+        return (v - ONES) & ~v & HIGH_BITS;
+    };
+    const std::uint64_t less_than_space = (word - ONES * 0x20) & ~word & HIGH_BITS;
+    return (less_than_space | has_zero_byte(word ^ (ONES * '"')) | has_zero_byte(word ^ (ONES * '\\'))) != 0;
+}
+
+constexpr bool IsEscaped(char c) noexcept {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+void AppendEscape(std::string& out, char c) {
+    switch (c) {
+        case '"':
+            out.append("\\\"");
+            return;
+        case '\\':
+            out.append("\\\\");
+            return;
+        case '\b':
+            out.append("\\b");
+            return;
+        case '\f':
+            out.append("\\f");
+            return;
+        case '\n':
+            out.append("\\n");
+            return;
+        case '\r':
+            out.append("\\r");
+            return;
+        case '\t':
+            out.append("\\t");
+            return;
+        default: {
+            constexpr std::string_view HEX = "0123456789abcdef";
+            const auto byte = static_cast<unsigned char>(c);
+            out.append("\\u00");
+            out.push_back(HEX[byte >> 4]);
+            out.push_back(HEX[byte & 0x0f]);
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * Записывает вещественное число. У JSON нет представления бесконечностей и NaN, они записываются как null
+ * @param value число
+ */
+void JsonWriter::Double(double value) {
+    if (!std::isfinite(value)) {
+        Null();
+        return;
+    }
+    Separate();
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    const std::string_view text(buffer, result.ptr - buffer);
+    out_.append(text);
+    if (text.find_first_of(".e") == std::string_view::npos) {
+        out_.append(".0");
+    }
+    need_comma_ = true;
+}
+
+/**
+ * Записывает строку в кавычках. Строка просматривается по восемь байт, и участки без экранируемых
+ * символов копируются целиком
+ * @param value строка
+ */
+void JsonWriter::WriteEscaped(std::string_view value) {
+    out_.push_back('"');
+    const char* data = value.data();
+    std::size_t run_start = 0;
+    std::size_t i = 0;
+    auto flush_escaped = [&](std::size_t end) {
+        for (; i < end; ++i) {
+            if (IsEscaped(data[i])) {
+                out_.append(data + run_start, i - run_start);
+                AppendEscape(out_, data[i]);
+                run_start = i + 1;
+            }
+        }
+    };
+    while (i + sizeof(std::uint64_t) <= value.size()) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (HasEscapedByte(word)) {
+            flush_escaped(i + sizeof(word));
+        } else {
+            i += sizeof(word);
+        }
+    }
+    flush_escaped(value.size());
+    out_.append(data + run_start, value.size() - run_start);
+    out_.push_back('"');
+}
+
+}  // namespace detail
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace detail {
+
+/**
+ * Потоковая запись JSON в конец строки без построения документа.
+ * Запятые между элементами расставляются автоматически, поэтому вызывающий код только описывает
+ * структуру: StartObject, Key, значение, ..., EndObject. Строку можно переиспользовать между документами,
+ * тогда после первых документов запись не выделяет память.
+ * Вещественные числа записываются кратчайшим представлением, которое читается обратно в то же значение,
+ * и всегда содержат точку или экспоненту, чтобы при разборе оставаться вещественными
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) noexcept : out_(out) {}
+
+    void StartObject() {
+        Separate();
+        out_.push_back('{');
+        need_comma_ = false;
+    }
+
+    void EndObject() {
+        out_.push_back('}');
+        need_comma_ = true;
+    }
+
+    void StartArray() {
+        Separate();
+        out_.push_back('[');
+        need_comma_ = false;
+    }
+
+    void EndArray() {
+        out_.push_back(']');
+        need_comma_ = true;
+    }
+
+    void Key(std::string_view key) {
+        Separate();
+        WriteEscaped(key);
+        out_.push_back(':');
+        need_comma_ = false;
+    }
+
+    void String(std::string_view value) {
+        Separate();
+        WriteEscaped(value);
+        need_comma_ = true;
+    }
+
+    void Int(std::int64_t value) {
+        WriteNumber(value);
+    }
+
+    void Uint(std::uint64_t value) {
+        WriteNumber(value);
+    }
+
+    void Double(double value);
+
+    void Bool(bool value) {
+        Separate();
+        out_.append(value ? "true" : "false");
+        need_comma_ = true;
+    }
+
+    void Null() {
+        Separate();
+        out_.append("null");
+        need_comma_ = true;
+    }
+
+private:
+    void Separate() {
+        if (need_comma_) {
+            out_.push_back(',');
+        }
+    }
+
+    template <typename T>
+    void WriteNumber(T value) {
+        Separate();
+        char buffer[24];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out_.append(buffer, result.ptr);
+        need_comma_ = true;
+    }
+
+    void WriteEscaped(std::string_view value);
+
+    std::string& out_;
+    bool need_comma_ = false;
+};
+
+}  // namespace detail
@@ -79,23 +79,25 @@ namespace model {
         json_value = std::move(arr);
     }
 
+    // Состояние собак формируется на каждый запрос, поэтому элементы размещаются в ресурсе памяти json_value
+
     void tag_invoke(boost::json::value_from_tag, boost::json::value& json_value, const Dog::Bag& bag){
-        array js_bag;
+        array js_bag(json_value.storage());
         for (const auto& loot : bag) {
-            object js_loot;
+            object js_loot(json_value.storage());
             js_loot[LootKey::ID] = *loot.id;
             js_loot[LootKey::TYPE] = loot.type;
-            js_bag.push_back(js_loot);
+            js_bag.push_back(std::move(js_loot));
         }
-        json_value = js_bag;
+        json_value = std::move(js_bag);
     }
 
     void tag_invoke(boost::json::value_from_tag, boost::json::value& json_value, const Dog& dog){
-        object obj;
+        object obj(json_value.storage());
         obj[UserKey::POSITION] = {dog.GetPosition().x, dog.GetPosition().y};
         obj[UserKey::SPEED] = {dog.GetSpeed().dx, dog.GetSpeed().dy};
         obj[UserKey::DIRECTION] = std::string{dog.GetDirection()};
-        obj[LootKey::BAG] = value_from(dog.GetBag());
+        obj[LootKey::BAG] = value_from(dog.GetBag(), json_value.storage());
         obj[LootKey::SCORE] = dog.GetScore();
         json_value = std::move(obj);
     }
@@ -68,6 +68,7 @@ struct LootKey{
     static constexpr boost::json::string_view COLOR                = "color";
     static constexpr boost::json::string_view SCALE                = "scale";
     static constexpr boost::json::string_view LOST                 = "lostObjects";
+    static constexpr boost::json::string_view REMOVED_LOST         = "removedObjects";
     static constexpr boost::json::string_view DEFAULT_BAG_CAPACITY = "defaultBagCapacity";
     static constexpr boost::json::string_view BAG_CAPACITY         = "bagCapacity";
     static constexpr boost::json::string_view BAG                  = "bag";
@@ -84,6 +85,9 @@ struct UserKey {
     static constexpr boost::json::string_view MAP_ID               = "mapId";
     static constexpr boost::json::string_view PLAYER_ID            = "playerId";
     static constexpr boost::json::string_view PLAYERS              = "players";
+    static constexpr boost::json::string_view REMOVED_PLAYERS      = "removedPlayers";
+    static constexpr boost::json::string_view VERSION              = "version";
+    static constexpr boost::json::string_view FULL_STATE           = "full";
     static constexpr boost::json::string_view POSITION             = "pos";
     static constexpr boost::json::string_view SPEED                = "speed";
     static constexpr boost::json::string_view DIRECTION            = "dir";
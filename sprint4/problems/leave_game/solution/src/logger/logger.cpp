@@ -1,5 +1,7 @@
 #include "logger.h"
 
+#include <cstring>
+
 namespace server_logging {
 /**
  * Логирование выхода из программы
@@ -23,9 +25,54 @@ void Logger::LogExit(const std::exception& ex) {
     BOOST_LOG_TRIVIAL(error) << boost::log::add_value(additional_data, obj) << "server exited"sv;
 }
 
-void Logger::LogStart(const net::ip::address& address, int port) {
-    boost::json::value js_port_address{{"port"s, port}, {"address"s, address.to_string()}};
-    LogInfo(js_port_address, "server started"sv);
+/**
+ * Возвращает адрес клиента для журнала
+ * @param endpoint адрес клиента
+ * @return IP-адрес клиента или "unix" для соединения через Unix domain socket
+ */
+std::string Logger::GetClientAddress(const net::generic::stream_protocol::endpoint& endpoint) {
+    const int family = endpoint.protocol().family();
+    if (family != AF_INET && family != AF_INET6) {
+        return "unix"s;
+    }
+    net::ip::tcp::endpoint tcp_endpoint;
+    std::memcpy(tcp_endpoint.data(), endpoint.data(), endpoint.size());
+    tcp_endpoint.resize(endpoint.size());
+    return tcp_endpoint.address().to_string();
+}
+
+/**
+ * Логирование запуска сервера. Адрес и порт первого TCP-адреса дублируются на верхнем уровне, как раньше
+ * @param endpoints адреса, которые слушает сервер
+ */
+void Logger::LogStart(const std::vector<net::generic::stream_protocol::endpoint>& endpoints) {
+    boost::json::object obj;
+    boost::json::array listening;
+    for (const auto& endpoint : endpoints) {
+        const int family = endpoint.protocol().family();
+        if (family != AF_INET && family != AF_INET6) {
+            net::local::stream_protocol::endpoint unix_endpoint;
+            std::memcpy(unix_endpoint.data(), endpoint.data(), endpoint.size());
+            unix_endpoint.resize(endpoint.size());
+            std::string path = unix_endpoint.path();
+            // Имя в абстрактном пространстве имён начинается с нулевого байта, в журнал оно пишется как '@name'
+            if (!path.empty() && path.front() == '\0') {
+                path.front() = '@';
+            }
+            listening.push_back(boost::json::object{{"path"s, path}});
+            continue;
+        }
+        net::ip::tcp::endpoint tcp_endpoint;
+        std::memcpy(tcp_endpoint.data(), endpoint.data(), endpoint.size());
+        tcp_endpoint.resize(endpoint.size());
+        if (!obj.contains("port"sv)) {
+            obj["port"s] = tcp_endpoint.port();
+            obj["address"s] = tcp_endpoint.address().to_string();
+        }
+        listening.push_back(boost::json::object{{"port"s, tcp_endpoint.port()}, {"address"s, tcp_endpoint.address().to_string()}});
+    }
+    obj["endpoints"s] = std::move(listening);
+    LogInfo(obj, "server started"sv);
 }
 
 /**
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <boost/asio/generic/stream_protocol.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/date_time.hpp>
 #include <boost/json.hpp>
@@ -16,6 +18,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 namespace server_logging {
 namespace json = boost::json;
@@ -32,9 +35,10 @@ public:
     static void Init();
     static void LogExit(int code);
     static void LogExit(const std::exception& ex);
-    static void LogStart(const net::ip::address& address, int port);
+    static void LogStart(const std::vector<net::generic::stream_protocol::endpoint>& endpoints);
     static void LogError(const boost::system::error_code& ec, std::string_view where);
     static void LogInfo(boost::json::value const& data, std::string_view message);
+    static std::string GetClientAddress(const net::generic::stream_protocol::endpoint& endpoint);
 
 
     Logger() = default;
@@ -49,18 +53,18 @@ public:
     explicit LoggingRequestHandler(RequestHandler& handler) : decorated_(handler) {}
 
     template <typename Body, typename Allocator, typename Send>
-    void operator()(const boost::asio::ip::tcp::endpoint& endpoint, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+    void operator()(const net::generic::stream_protocol::endpoint& endpoint, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        // Время ответа отсчитывается от получения запроса, а не от вызова send: в него входят ожидание
+        // api_strand и обработка запроса. Разбивку по этапам вплоть до записи в сокет даёт трассировка (tracing::Tracer)
+        const auto start = std::chrono::steady_clock::now();
         LogRequest(endpoint, req);
-        decorated_(endpoint, std::move(req), [s = std::forward<Send>(send)](auto&& response) {
-            std::chrono::high_resolution_clock timer;
-            auto start = std::chrono::high_resolution_clock::now();
-
+        decorated_(endpoint, std::move(req), [s = std::forward<Send>(send), start](auto&& response) {
             const int code_result = response.result_int();
-            const std::string content_type = static_cast<std::string>(response.at(http::field::content_type));
+            const std::string content_type = static_cast<std::string>(response[http::field::content_type]);
 
             s(response);
 
-            auto stop = std::chrono::high_resolution_clock::now();
+            auto stop = std::chrono::steady_clock::now();
             auto response_time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
 
             LoggingRequestHandler::LogResponse(response_time, code_result, content_type);
@@ -75,14 +79,14 @@ private:
      * @param req Запрос
      */
     template <typename Body, typename Allocator>
-    static void LogRequest(const boost::asio::ip::tcp::endpoint &endpoint , const http::request<Body, http::basic_fields<Allocator>>& req) {
+    static void LogRequest(const net::generic::stream_protocol::endpoint &endpoint , const http::request<Body, http::basic_fields<Allocator>>& req) {
         /** message — строка request received
             data    — объект с полями:
-            ip      — IP-адрес клиента (полученный через endpoint.address().to_string()),
+            ip      — IP-адрес клиента или "unix" для соединений через Unix domain socket,
             URI     — запрошенный адрес,
             method  — использованный метод HTTP.
         */
-        json::value value{{"ip"s,     endpoint.address().to_string()},
+        json::value value{{"ip"s,     Logger::GetClientAddress(endpoint)},
                           {"URI"s,    req.target()},
                           {"method"s, req.method_string()}};
         BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, value) << "request received"sv;
@@ -90,7 +94,7 @@ private:
 
     /**
      * Выполняет логирование ответов на запросы
-     * @param response_time время формирования ответа в миллисекундах (целое число).
+     * @param response_time время от получения запроса до передачи ответа сессии в микросекундах (целое число).
      * @param code статус-код ответа, например, 200 (http::response<T>::result_int()).
      * @param content строка или null, если заголовок в ответе отсутствует.
      */
@@ -2,17 +2,28 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/thread_pool.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include "json/json_loader.h"
+#include "request_handler/game_state_hub.h"
+#include "request_handler/metrics_request_handler.h"
 #include "request_handler/request_handler.h"
+#include "request_handler/static_asset_watcher.h"
+#include "request_handler/trace_request_handler.h"
 #include "request_handler/ticker.h"
 #include "logger/logger.h"
 #include "parse/parse.h"
 #include "infrastructure/serializing_listener.h"
 #include "infrastructure/db_listener.h"
+#include "infrastructure/metrics_listener.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
@@ -33,6 +44,50 @@ void RunWorkers(unsigned num_threads, const Fn& fn) {
     fn();
 }
 
+// Закрепляет текущий поток за ядром core
+void PinCurrentThread([[maybe_unused]] unsigned core) {
+#ifdef __linux__
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#endif
+}
+
+using IoShards = std::vector<std::unique_ptr<net::io_context>>;
+
+// Запускает каждый шард в отдельном потоке, закреплённом за своим ядром,
+// а функцию fn - в текущем потоке
+template <typename Fn>
+void RunShards(IoShards& shards, const Fn& fn) {
+    const unsigned num_cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::jthread> workers;
+    workers.reserve(shards.size());
+    for (size_t i = 0; i < shards.size(); ++i) {
+        workers.emplace_back([&shard = *shards[i], core = static_cast<unsigned>(i % num_cores)] {
+            PinCurrentThread(core);
+            shard.run();
+        });
+    }
+    fn();
+}
+
+/**
+ * Создаёт адрес Unix domain socket
+ * @param path путь к сокету или "@имя" для сокета в абстрактном пространстве имён Linux.
+ * Оставшийся от предыдущего запуска файл сокета удаляется
+ * @return адрес для http_server::ServeHttp
+ */
+http_server::Endpoint MakeUnixEndpoint(const std::string& path) {
+    if (path.starts_with('@')) {
+        return net::local::stream_protocol::endpoint{"\0"s + path.substr(1)};
+    }
+    if (fs::is_socket(path)) {
+        fs::remove(path);
+    }
+    return net::local::stream_protocol::endpoint{path};
+}
+
 constexpr const char DB_URL_ENV_NAME[]{"GAME_DB_URL"};
 
 std::string GetDataBaseConfigFromEnv() {
@@ -68,27 +123,68 @@ int main(int argc, const char* argv[]) {
     server_logging::Logger::Init();
 
     try {
-        // 1. Загружаем карту из файла и построить модель игры
+        // 1. Инициализируем io_context
+        const unsigned num_threads = std::thread::hardware_concurrency();
+        // В шардированном режиме HTTP-сессии работают в собственных io_context (по одному на поток),
+        // а общий io_context обслуживает только api_strand, тикер и сигналы
+        const bool sharded = args.io_shards > 0;
+        net::io_context ioc(sharded ? 1 : num_threads);
+        IoShards shards;
+        for (uint32_t i = 0; i < args.io_shards; ++i) {
+            shards.emplace_back(std::make_unique<net::io_context>(1));
+        }
+        // strand для выполнения запросов к API
+        auto api_strand = net::make_strand(ioc);
+
+        // 2. Загружаем карту из файла и построить модель игры
         fs::path config_file = args.config;
         fs::path static_files_root = args.www_root;
         data_base::postgres::Database db(CAPACITY_CONNECTION_POOL, GetDataBaseConfigFromEnv());
         app::Application app(config_file);
+        // Метрики собираются, только если включены. Гистограммы подключаются до запуска рабочих потоков
+        std::unique_ptr<metrics::ServerMetrics> server_metrics;
+        if (args.metrics) {
+            server_metrics = std::make_unique<metrics::ServerMetrics>(http_handler::MetricsEndpoints::Labels());
+            db.GetConnectionPool().SetWaitHistogram(&server_metrics->GetDbPoolWait());
+        }
         infrastructure::DataBaseListener db_listener(app, db);
-        infrastructure::SerializingListener listener(app, args.state_file, std::chrono::milliseconds{args.save_state_period});
+        // Периодическое сохранение выполняется в api_strand. С бэкендом io_uring файл записывается асинхронно
+        infrastructure::SerializingListener listener(app, args.state_file, std::chrono::milliseconds{args.save_state_period},
+                                                     api_strand);
+        if (server_metrics) {
+            listener.SetSaveHistogram(&server_metrics->GetStateSaveDuration());
+        }
         app.AddApplicationListener(std::make_shared<infrastructure::DataBaseListener>(db_listener));
         app.AddApplicationListener(std::make_shared<infrastructure::SerializingListener>(listener));
         listener.Load();
 
-        // 2. Инициализируем io_context
-        const unsigned num_threads = std::thread::hardware_concurrency();
-        net::io_context ioc(num_threads);
-        // strand для выполнения запросов к API
-        auto api_strand = net::make_strand(ioc);
+        // Снимки игры для запросов на чтение публикуются после тика, когда слушатели, меняющие игру, уже отработали
+        auto game_snapshots = std::make_shared<http_handler::GameSnapshotPublisher>(app);
+        app.AddApplicationListener(game_snapshots);
+
+        // Рассылка состояния по WebSocket после каждого тика. Кадры берутся из только что опубликованного снимка
+        auto game_state_hub = std::make_shared<http_handler::GameStateHub>(app, api_strand, args.max_websockets);
+        game_state_hub->SetSnapshotPublisher(game_snapshots);
+        app.AddApplicationListener(game_state_hub);
+        if (server_metrics) {
+            app.AddApplicationListener(std::make_shared<infrastructure::MetricsListener>(app, *server_metrics));
+        }
 
         std::shared_ptr<http_handler::Ticker> ticker;
         if(args.tick_period.has_value()) {
-            ticker = std::make_shared<http_handler::Ticker>(api_strand, std::chrono::milliseconds{*args.tick_period},
-                                                            [&app](std::chrono::milliseconds delta) { app.Tick(delta); });
+            const std::chrono::milliseconds tick_period{*args.tick_period};
+            ticker = std::make_shared<http_handler::Ticker>(api_strand, tick_period,
+                                                            [&app, metrics = server_metrics.get(), tick_period](std::chrono::milliseconds delta) {
+                const auto start = std::chrono::steady_clock::now();
+                app.Tick(delta);
+                if (metrics) {
+                    const auto duration = std::chrono::steady_clock::now() - start;
+                    metrics->GetTickDuration().Record(duration);
+                    if (duration > tick_period) {
+                        metrics->GetTickOverruns().Add();
+                    }
+                }
+            });
             ticker->Start();
         }else {
             app.SetTickMode(true);
@@ -97,32 +193,168 @@ int main(int argc, const char* argv[]) {
 
         // 3. Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
         net::signal_set signals(ioc, SIGINT, SIGTERM);
-        signals.async_wait([&ioc](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
+        signals.async_wait([&ioc, &shards](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
           if (!ec) {
+              for (auto& shard : shards) {
+                  shard->stop();
+              }
               ioc.stop();
           }
         });
 
         // 4. Создаём обработчик HTTP-запросов и связываем его с приложением
-        auto handler = std::make_shared<http_handler::RequestHandler>(static_files_root, api_strand, app, db);
-        // 4.1 Использование паттерна 'Декоратор', чтобы залогировать получение запросов и формирование ответов
+        // 4.0 Запросы к базе данных и перестроение индекса статических файлов выполняются в отдельном пуле,
+        // чтобы не блокировать api_strand и потоки сессий. Потоков столько же, сколько соединений с базой
+        net::thread_pool blocking_pool(CAPACITY_CONNECTION_POOL);
+        // 4.1 Индекс статических файлов строится при запуске и перестраивается при изменениях с --static-watch
+        std::shared_ptr<http_handler::StaticAssetCache> static_assets;
+        if (args.static_cache) {
+            static_assets = std::make_shared<http_handler::StaticAssetCache>(static_files_root);
+            if (args.static_watch) {
+                std::make_shared<http_handler::StaticAssetWatcher>(ioc, static_assets, blocking_pool.get_executor())->Start();
+            }
+        }
+        // 4.2 Ограничение частоты запросов к API проверяется до api_strand
+        std::shared_ptr<http_handler::RateLimiter> rate_limiter;
+        if (args.token_rate_limit > 0 || args.ip_rate_limit > 0) {
+            auto limits = [](uint32_t rate, uint32_t burst) -> std::optional<http_handler::RateLimiter::Limits> {
+                if (rate == 0) {
+                    return std::nullopt;
+                }
+                return http_handler::RateLimiter::Limits{static_cast<double>(rate), burst > 0 ? burst : rate};
+            };
+            rate_limiter = std::make_shared<http_handler::RateLimiter>(http_handler::RateLimiter::Options{
+                    limits(args.token_rate_limit, args.token_rate_burst), limits(args.ip_rate_limit, args.ip_rate_burst)});
+            // Корзины заводятся только для токенов игроков из опубликованного снимка
+            rate_limiter->SetSnapshotPublisher(game_snapshots);
+            // Команды движения по WebSocket ограничиваются теми же корзинами, что и запросы к API
+            game_state_hub->SetRateLimiter(rate_limiter);
+        }
+        auto handler = std::make_shared<http_handler::RequestHandler>(static_files_root, api_strand, app, db.GetUnitOfWorkFactory(),
+                                                                      args.api_queue_limit, static_assets, game_snapshots,
+                                                                      blocking_pool.get_executor(), rate_limiter);
+        // 4.3 Использование паттерна 'Декоратор', чтобы залогировать получение запросов и формирование ответов
         server_logging::LoggingRequestHandler logging_handler{(*handler)};
+        // 4.4 Ещё один декоратор измеряет время обработки запросов и отвечает на GET /metrics
+        std::optional<http_handler::MetricsRequestHandler<decltype(logging_handler)>> metrics_handler;
+        if (server_metrics) {
+            server_metrics->AddGauge("api_queue_depth"s, "API requests queued to the game strand"s,
+                                     [handler] { return static_cast<double>(handler->GetApiInFlight()); });
+            server_metrics->AddCounter("api_rejected"s, "API requests rejected with 503 because the game strand queue is full"s,
+                                       [handler] { return static_cast<double>(handler->GetApiRejected()); });
+            server_metrics->AddCounter("rate_limited"s, "API requests rejected with 429 by the rate limiter"s,
+                                       [rate_limiter] { return rate_limiter ? static_cast<double>(rate_limiter->GetRejected()) : 0.0; });
+            metrics_handler.emplace(logging_handler, *server_metrics);
+        }
 
 
         // 5. Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
         const auto address = net::ip::make_address("0.0.0.0");
         constexpr net::ip::port_type port = 8080;
-        http_server::ServeHttp(ioc, {address, port}, [&logging_handler](auto&& endpoint, auto&& req, auto&& send) {
+        auto decorated = [&logging_handler, &metrics_handler](auto&& endpoint, auto&& req, auto&& send) {
+            if (metrics_handler) {
+                return (*metrics_handler)(std::forward<decltype(endpoint)>(endpoint), std::forward<decltype(req)>(req),
+                                          std::forward<decltype(send)>(send));
+            }
             logging_handler(std::forward<decltype(endpoint)>(endpoint), std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
-        });
+        };
+        // 4.5 Трассировка выбранных запросов: сессии ставят отметки, последние трассировки отдаются на GET /admin/traces
+        std::shared_ptr<tracing::Tracer> tracer;
+        if (args.trace_sample_period > 0) {
+            tracer = std::make_shared<tracing::Tracer>(tracing::TracerOptions{args.trace_sample_period, args.trace_buffer, args.trace_log});
+        }
+        http_handler::TraceRequestHandler trace_handler{decorated, tracer};
+        // С --admin-socket метрики и трассировки отдаются только на нём, публичные адреса отвечают на них 404.
+        // Обработчики обоих видов - один тип замыкания, поэтому Listener'ы хранятся в одном списке
+        auto make_serve = [&trace_handler, admin_separate = !args.admin_socket.empty()](bool admin) {
+            return [&trace_handler, admin_separate, admin](auto&& endpoint, auto&& req, auto&& send) {
+                if (admin_separate && !admin &&
+                    (req.target() == http_handler::EndPoint::METRICS || req.target() == http_handler::EndPoint::TRACES)) {
+                    return send(http_handler::MakeTextResponse(req, boost::beast::http::status::not_found, http_handler::ErrorResponse::FILE_NOT_FOUND,
+                                                               http_handler::CacheControl::NO_CACHE));
+                }
+                trace_handler(std::forward<decltype(endpoint)>(endpoint), std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
+            };
+        };
+        auto serve = make_serve(false);
+        http_server::ServerOptions server_options{.reuse_port = sharded,
+                                                  .pipeline_depth = args.pipeline_depth,
+                                                  .max_sessions = args.max_sessions,
+                                                  .use_sendfile = args.use_sendfile,
+                                                  .upgrade = [game_state_hub](http_server::StrandSocket&& socket,
+                                                                              http_handler::StringRequest&& req) {
+                                                      game_state_hub->Accept(std::move(socket), std::move(req));
+                                                  },
+                                                  .tracer = tracer};
+        // Listener'ы хранятся, чтобы их счётчики сессий попадали в метрики
+        std::vector<std::shared_ptr<http_server::Listener<decltype(serve)>>> listeners;
+        if (args.tcp) {
+            const http_server::Endpoint endpoint = net::ip::tcp::endpoint{address, port};
+            if (sharded) {
+                // Каждый шард принимает соединения своим acceptor'ом, ядро распределяет их через SO_REUSEPORT
+                for (auto& shard : shards) {
+                    listeners.push_back(http_server::ServeHttp(*shard, endpoint, serve, server_options));
+                }
+            } else {
+                listeners.push_back(http_server::ServeHttp(ioc, endpoint, serve, server_options));
+            }
+        }
+        if (!args.unix_socket.empty()) {
+            // SO_REUSEPORT не распространяется на Unix domain socket, поэтому его слушает один acceptor
+            auto unix_options = server_options;
+            unix_options.reuse_port = false;
+            listeners.push_back(http_server::ServeHttp(sharded ? *shards.front() : ioc, MakeUnixEndpoint(args.unix_socket),
+                                                       serve, unix_options));
+            server_logging::Logger::LogInfo(boost::json::value{{"path"s, args.unix_socket}}, "unix socket listening"sv);
+        }
+        if (!args.admin_socket.empty()) {
+            auto admin_options = server_options;
+            admin_options.reuse_port = false;
+            admin_options.upgrade = nullptr;
+            listeners.push_back(http_server::ServeHttp(sharded ? *shards.front() : ioc, MakeUnixEndpoint(args.admin_socket),
+                                                       make_serve(true), admin_options));
+        }
+        // Рабочие потоки ещё не запущены, поэтому измерения можно добавить после запуска приёма соединений
+        if (server_metrics) {
+            server_metrics->AddGauge("http_sessions"s, "Open HTTP sessions on all listeners"s, [listeners] {
+                std::size_t sessions = 0;
+                for (const auto& listener : listeners) {
+                    sessions += listener->GetActiveSessions();
+                }
+                return static_cast<double>(sessions);
+            });
+            server_metrics->AddCounter("accept_pauses"s, "Times accepting connections was paused because of --max-sessions"s,
+                                       [listeners] {
+                std::size_t pauses = 0;
+                for (const auto& listener : listeners) {
+                    pauses += listener->GetAcceptPauses();
+                }
+                return static_cast<double>(pauses);
+            });
+        }
 
-        // Эта надпись сообщает тестам о том, что сервер запущен и готов обрабатывать запросы
-        server_logging::Logger::LogStart(address, port);
+        // Эта надпись сообщает тестам о том, что сервер запущен и готов обрабатывать запросы.
+        // В журнал попадают адреса, которые действительно слушаются (без TCP при --disable-tcp)
+        std::vector<http_server::Endpoint> bound_endpoints;
+        for (const auto& listener : listeners) {
+            // Шарды слушают один и тот же адрес через SO_REUSEPORT
+            auto endpoint = listener->GetLocalEndpoint();
+            if (std::find(bound_endpoints.begin(), bound_endpoints.end(), endpoint) == bound_endpoints.end()) {
+                bound_endpoints.push_back(std::move(endpoint));
+            }
+        }
+        server_logging::Logger::LogStart(bound_endpoints);
 
         // 6. Запускаем обработку асинхронных операций
-        RunWorkers(std::max(1u, num_threads), [&ioc] {
-            ioc.run();
-        });
+        if (sharded) {
+            RunShards(shards, [&ioc] {
+                ioc.run();
+            });
+        } else {
+            RunWorkers(std::max(1u, num_threads), [&ioc] {
+                ioc.run();
+            });
+        }
         listener.Save();
     } catch (const std::exception& ex) {
         server_logging::Logger::LogExit(ex);
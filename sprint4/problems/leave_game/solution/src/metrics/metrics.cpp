@@ -0,0 +1,158 @@
+#include "metrics.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace metrics {
+
+using namespace std::literals;
+
+std::int64_t Counter::Get() const noexcept {
+    std::int64_t sum = 0;
+    for (const auto& shard : shards_) {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+Histogram::~Histogram() {
+    for (auto& slot : shards_) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+Histogram::Shard* Histogram::CreateShard(std::atomic<Shard*>& slot) {
+    auto* shard = new Shard{};
+    Shard* expected = nullptr;
+    // Общий шард SHARED_SLOT могут одновременно создавать несколько потоков, остаётся созданный первым
+    if (!slot.compare_exchange_strong(expected, shard, std::memory_order_acq_rel)) {
+        delete shard;
+        return expected;
+    }
+    return shard;
+}
+
+Histogram::Snapshot Histogram::Collect() const {
+    Snapshot snapshot;
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) {
+            continue;
+        }
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            snapshot.counts[i] += shard->counts[i].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+    }
+    for (const auto count : snapshot.counts) {
+        snapshot.count += count;
+    }
+    return snapshot;
+}
+
+void ExpositionWriter::Header(std::string_view name, std::string_view help, std::string_view type) {
+    out_.append("# HELP "sv).append(name).append(" "sv);
+    // В описании экранируются только '\' и перевод строки
+    for (const char c : help) {
+        if (c == '\\') {
+            out_.append("\\\\"sv);
+        } else if (c == '\n') {
+            out_.append("\\n"sv);
+        } else {
+            out_.push_back(c);
+        }
+    }
+    out_.append("\n# TYPE "sv).append(name).append(" "sv).append(type).push_back('\n');
+}
+
+void ExpositionWriter::Sample(std::string_view name, Labels labels, double value) {
+    WriteSeries(name, {}, labels);
+    WriteNumber(value);
+    out_.push_back('\n');
+}
+
+void ExpositionWriter::DurationHistogram(std::string_view name, Labels labels, const Histogram::Snapshot& snapshot) {
+    char le[32];
+    std::size_t bucket = 0;
+    std::uint64_t cumulative = 0;
+    for (const double bound : SECONDS_BOUNDS) {
+        const auto bound_ns = static_cast<std::uint64_t>(std::llround(bound * 1e9));
+        for (; bucket < Histogram::BUCKETS && Histogram::BucketUpperBound(bucket) <= bound_ns; ++bucket) {
+            cumulative += snapshot.counts[bucket];
+        }
+        // Фиксированная запись, как в клиентских библиотеках Prometheus: le="0.0001", а не le="1e-04"
+        const auto [end, ec] = std::to_chars(std::begin(le), std::end(le), bound, std::chars_format::fixed);
+        WriteSeries(name, "_bucket"sv, labels, std::string_view(le, end - le));
+        WriteNumber(cumulative);
+        out_.push_back('\n');
+    }
+    WriteSeries(name, "_bucket"sv, labels, "+Inf"sv);
+    WriteNumber(snapshot.count);
+    out_.push_back('\n');
+    WriteSeries(name, "_sum"sv, labels);
+    WriteNumber(static_cast<double>(snapshot.sum) / 1e9);
+    out_.push_back('\n');
+    WriteSeries(name, "_count"sv, labels);
+    WriteNumber(snapshot.count);
+    out_.push_back('\n');
+}
+
+/**
+ * Записывает имя ряда и метки: name_suffix{label="value",le="..."} с пробелом перед значением
+ * @param name имя метрики
+ * @param suffix суффикс ряда гистограммы
+ * @param labels метки
+ * @param le граница корзины гистограммы (пустая - без метки le)
+ */
+void ExpositionWriter::WriteSeries(std::string_view name, std::string_view suffix, Labels labels, std::string_view le) {
+    out_.append(name).append(suffix);
+    if (labels.size() > 0 || !le.empty()) {
+        char separator = '{';
+        auto write_label = [this, &separator](std::string_view label, std::string_view value) {
+            out_.push_back(separator);
+            out_.append(label).append("=\""sv);
+            for (const char c : value) {
+                if (c == '\\' || c == '"') {
+                    out_.push_back('\\');
+                    out_.push_back(c);
+                } else if (c == '\n') {
+                    out_.append("\\n"sv);
+                } else {
+                    out_.push_back(c);
+                }
+            }
+            out_.push_back('"');
+            separator = ',';
+        };
+        for (const auto& label : labels) {
+            write_label(label.name, label.value);
+        }
+        if (!le.empty()) {
+            write_label("le"sv, le);
+        }
+        out_.push_back('}');
+    }
+    out_.push_back(' ');
+}
+
+void ExpositionWriter::WriteNumber(double value) {
+    if (std::isnan(value)) {
+        out_.append("NaN"sv);
+        return;
+    }
+    if (std::isinf(value)) {
+        out_.append(value > 0 ? "+Inf"sv : "-Inf"sv);
+        return;
+    }
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out_.append(buffer, end);
+}
+
+void ExpositionWriter::WriteNumber(std::uint64_t value) {
+    char buffer[24];
+    const auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value);
+    out_.append(buffer, end);
+}
+
+}  // namespace metrics
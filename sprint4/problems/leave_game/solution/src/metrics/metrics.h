@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+
+namespace metrics {
+
+// Количество шардов счётчиков. Потоков сервера обычно меньше, потоки сверх MAX_THREADS - 1 делят последний шард
+constexpr std::size_t MAX_THREADS = 64;
+constexpr std::size_t SHARED_SLOT = MAX_THREADS - 1;
+constexpr std::size_t CACHE_LINE = 64;
+
+/**
+ * Номер шарда текущего потока. Назначается при первом обращении и не меняется.
+ * Шарды с номером меньше SHARED_SLOT принадлежат одному потоку
+ */
+inline std::size_t ThreadSlot() noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t slot = std::min(next.fetch_add(1, std::memory_order_relaxed), SHARED_SLOT);
+    return slot;
+}
+
+/**
+ * Прибавляет delta к значению в шарде. В шард одного потока пишет только он, поэтому вместо
+ * атомарного сложения (lock xadd) достаточно чтения и записи, атомарность нужна лишь для чтения при сборе
+ * @param value значение в шарде slot
+ * @param delta приращение
+ * @param slot номер шарда текущего потока
+ */
+template <typename T>
+inline void AddToSlot(std::atomic<T>& value, T delta, std::size_t slot) noexcept {
+    if (slot != SHARED_SLOT) [[likely]] {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    } else {
+        value.fetch_add(delta, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Счётчик, разбитый по потокам. Запись - сложение в строке кэша своего потока без блокировок шины,
+ * сумма шардов вычисляется только при чтении. Допускает отрицательные приращения,
+ * поэтому подходит и для количества выполняющихся запросов
+ */
+class Counter {
+public:
+    void Add(std::int64_t delta = 1) noexcept {
+        const std::size_t slot = ThreadSlot();
+        AddToSlot(shards_[slot].value, delta, slot);
+    }
+
+    [[nodiscard]] std::int64_t Get() const noexcept;
+
+private:
+    struct alignas(CACHE_LINE) Shard {
+        std::atomic<std::int64_t> value{0};
+    };
+
+    std::array<Shard, MAX_THREADS> shards_;
+};
+
+/**
+ * Значение, которое задаётся целиком (количество сессий, собак и т.п.)
+ */
+class Gauge {
+public:
+    void Set(double value) noexcept { value_.store(value, std::memory_order_relaxed); }
+    [[nodiscard]] double Get() const noexcept { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * Гистограмма с логарифмически-линейными корзинами (как в HdrHistogram). Значения меньше 2 * SUB_COUNT
+ * хранятся точно, остальные - в корзинах шириной не больше 1/SUB_COUNT от значения.
+ * Значения - целые числа, для времени - наносекунды.
+ *
+ * Каждый поток пишет в свой шард, шарды создаются при первой записи потока.
+ * Запись - вычисление номера корзины и два сложения в шарде потока, объединение шардов выполняется в Collect
+ */
+class Histogram {
+public:
+    constexpr static unsigned SUB_BITS = 4;
+    constexpr static std::uint64_t SUB_COUNT = std::uint64_t{1} << SUB_BITS;
+    // Значения больше MAX_VALUE (около 18 минут в наносекундах) попадают в последнюю корзину
+    constexpr static unsigned MAX_BITS = 40;
+    constexpr static std::uint64_t MAX_VALUE = (std::uint64_t{1} << MAX_BITS) - 1;
+    constexpr static std::size_t BUCKETS = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+    /**
+     * Объединённые данные шардов
+     */
+    struct Snapshot {
+        std::array<std::uint64_t, BUCKETS> counts{};
+        std::uint64_t count = 0;
+        std::uint64_t sum = 0;
+    };
+
+    Histogram() = default;
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+    ~Histogram();
+
+    /**
+     * @param value значение
+     * @return номер корзины значения
+     */
+    static constexpr std::size_t BucketIndex(std::uint64_t value) noexcept {
+        if (value > MAX_VALUE) {
+            value = MAX_VALUE;
+        }
+        if (value < 2 * SUB_COUNT) {
+            return static_cast<std::size_t>(value);
+        }
+        const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BITS;
+        return static_cast<std::size_t>((shift + 1) * SUB_COUNT + (value >> shift) - SUB_COUNT);
+    }
+
+    /**
+     * @param index номер корзины
+     * @return наибольшее значение, попадающее в корзину
+     */
+    static constexpr std::uint64_t BucketUpperBound(std::size_t index) noexcept {
+        if (index < 2 * SUB_COUNT) {
+            return index;
+        }
+        const std::size_t shift = index / SUB_COUNT - 1;
+        const std::uint64_t sub = index % SUB_COUNT + SUB_COUNT;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    void Record(std::uint64_t value) {
+        const std::size_t slot = ThreadSlot();
+        Shard& shard = GetShard(slot);
+        AddToSlot<std::uint64_t>(shard.counts[BucketIndex(value)], 1, slot);
+        AddToSlot(shard.sum, value, slot);
+    }
+
+    void Record(std::chrono::nanoseconds duration) {
+        Record(static_cast<std::uint64_t>(std::max<std::chrono::nanoseconds::rep>(duration.count(), 0)));
+    }
+
+    /**
+     * Объединяет шарды. Записи, выполняемые одновременно со сбором, могут попасть в снимок частично
+     */
+    [[nodiscard]] Snapshot Collect() const;
+
+private:
+    struct alignas(CACHE_LINE) Shard {
+        std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+        std::atomic<std::uint64_t> sum{0};
+    };
+
+    Shard& GetShard(std::size_t slot) {
+        Shard* shard = shards_[slot].load(std::memory_order_acquire);
+        if (!shard) [[unlikely]] {
+            shard = CreateShard(shards_[slot]);
+        }
+        return *shard;
+    }
+
+    static Shard* CreateShard(std::atomic<Shard*>& slot);
+
+    std::array<std::atomic<Shard*>, MAX_THREADS> shards_{};
+};
+
+/**
+ * Метка метрики
+ */
+struct Label {
+    std::string_view name;
+    std::string_view value;
+};
+
+using Labels = std::initializer_list<Label>;
+
+/**
+ * Записывает метрики в текстовом формате Prometheus (exposition format 0.0.4)
+ */
+class ExpositionWriter {
+public:
+    // Границы корзин гистограмм времени в секундах (le). Границы, как в клиентских библиотеках Prometheus,
+    // дополнены 0.1 и 0.25 мс: большинство запросов к API обслуживаются быстрее миллисекунды
+    constexpr static std::array<double, 16> SECONDS_BOUNDS{0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+                                                           0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0};
+
+    explicit ExpositionWriter(std::string& out) : out_(out) {}
+
+    /**
+     * Записывает строки # HELP и # TYPE. Вызывается один раз перед значениями метрики
+     * @param name имя метрики
+     * @param help описание
+     * @param type counter, gauge или histogram
+     */
+    void Header(std::string_view name, std::string_view help, std::string_view type);
+
+    /**
+     * Записывает значение счётчика или измерения
+     * @param name имя метрики
+     * @param labels метки
+     * @param value значение
+     */
+    void Sample(std::string_view name, Labels labels, double value);
+
+    /**
+     * Записывает гистограмму времени: накопленные количества по границам SECONDS_BOUNDS, _sum и _count.
+     * Корзина учитывается в границе le, только если все её значения не больше le, поэтому значения
+     * в пределах ширины корзины от границы относятся к следующей границе
+     * @param name имя метрики
+     * @param labels метки
+     * @param snapshot данные гистограммы со значениями в наносекундах
+     */
+    void DurationHistogram(std::string_view name, Labels labels, const Histogram::Snapshot& snapshot);
+
+private:
+    void WriteSeries(std::string_view name, std::string_view suffix, Labels labels, std::string_view le = {});
+    void WriteNumber(double value);
+    void WriteNumber(std::uint64_t value);
+
+    std::string& out_;
+};
+
+}  // namespace metrics
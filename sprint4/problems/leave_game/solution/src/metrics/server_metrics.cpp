@@ -0,0 +1,99 @@
+#include "server_metrics.h"
+
+namespace metrics {
+
+using namespace std::literals;
+
+namespace {
+constexpr std::string_view PREFIX = "game_server_"sv;
+}  // namespace
+
+ServerMetrics::ServerMetrics(std::vector<std::string> endpoints)
+    : endpoints_(std::move(endpoints))
+    , request_latency_(std::make_unique<std::atomic<Histogram*>[]>(endpoints_.size() * STATUSES)) {
+}
+
+ServerMetrics::~ServerMetrics() {
+    for (std::size_t i = 0; i < endpoints_.size() * STATUSES; ++i) {
+        delete request_latency_[i].load(std::memory_order_relaxed);
+    }
+}
+
+void ServerMetrics::RecordRequest(std::size_t endpoint, unsigned status, std::chrono::nanoseconds latency) {
+    if (endpoint >= endpoints_.size() || status < MIN_STATUS || status > MAX_STATUS) {
+        return;
+    }
+    auto& slot = request_latency_[endpoint * STATUSES + (status - MIN_STATUS)];
+    Histogram* histogram = slot.load(std::memory_order_acquire);
+    if (!histogram) [[unlikely]] {
+        auto created = std::make_unique<Histogram>();
+        if (slot.compare_exchange_strong(histogram, created.get(), std::memory_order_acq_rel)) {
+            histogram = created.release();
+        }
+    }
+    histogram->Record(latency);
+}
+
+void ServerMetrics::AddGauge(std::string name, std::string help, std::function<double()> read) {
+    callbacks_.push_back({std::move(name), std::move(help), "gauge"sv, std::move(read)});
+}
+
+void ServerMetrics::AddCounter(std::string name, std::string help, std::function<double()> read) {
+    callbacks_.push_back({std::move(name) + "_total"s, std::move(help), "counter"sv, std::move(read)});
+}
+
+std::string ServerMetrics::Scrape() const {
+    std::string out;
+    out.reserve(16 * 1024);
+    ExpositionWriter writer(out);
+    std::string name;
+    auto full_name = [&name](std::string_view short_name) -> std::string_view {
+        name.assign(PREFIX).append(short_name);
+        return name;
+    };
+
+    writer.Header(full_name("http_request_duration_seconds"sv),
+                  "Time from receiving a request to passing the response to the connection"sv, "histogram"sv);
+    char code[4];
+    for (std::size_t endpoint = 0; endpoint < endpoints_.size(); ++endpoint) {
+        for (unsigned status = MIN_STATUS; status <= MAX_STATUS; ++status) {
+            const Histogram* histogram = request_latency_[endpoint * STATUSES + (status - MIN_STATUS)].load(std::memory_order_acquire);
+            if (!histogram) {
+                continue;
+            }
+            code[0] = static_cast<char>('0' + status / 100);
+            code[1] = static_cast<char>('0' + status / 10 % 10);
+            code[2] = static_cast<char>('0' + status % 10);
+            writer.DurationHistogram(name, {{"endpoint"sv, endpoints_[endpoint]}, {"code"sv, std::string_view(code, 3)}},
+                                     histogram->Collect());
+        }
+    }
+
+    writer.Header(full_name("http_requests_in_flight"sv), "Requests waiting for a response"sv, "gauge"sv);
+    writer.Sample(name, {}, static_cast<double>(requests_in_flight_.Get()));
+
+    writer.Header(full_name("tick_duration_seconds"sv), "Game tick duration"sv, "histogram"sv);
+    writer.DurationHistogram(name, {}, tick_duration_.Collect());
+    writer.Header(full_name("tick_overruns_total"sv), "Game ticks that took longer than the tick period"sv, "counter"sv);
+    writer.Sample(name, {}, static_cast<double>(tick_overruns_.Get()));
+
+    writer.Header(full_name("sessions"sv), "Game sessions"sv, "gauge"sv);
+    writer.Sample(name, {}, sessions_.Get());
+    writer.Header(full_name("dogs"sv), "Dogs in all game sessions"sv, "gauge"sv);
+    writer.Sample(name, {}, dogs_.Get());
+    writer.Header(full_name("lost_objects"sv), "Lost objects on all maps"sv, "gauge"sv);
+    writer.Sample(name, {}, lost_objects_.Get());
+
+    writer.Header(full_name("db_pool_wait_seconds"sv), "Wait for a free database connection"sv, "histogram"sv);
+    writer.DurationHistogram(name, {}, db_pool_wait_.Collect());
+    writer.Header(full_name("state_save_duration_seconds"sv), "Game state save duration"sv, "histogram"sv);
+    writer.DurationHistogram(name, {}, state_save_duration_.Collect());
+
+    for (const auto& metric : callbacks_) {
+        writer.Header(full_name(metric.name), metric.help, metric.type);
+        writer.Sample(name, {}, metric.read());
+    }
+    return out;
+}
+
+}  // namespace metrics
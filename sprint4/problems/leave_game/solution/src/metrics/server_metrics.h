@@ -0,0 +1,102 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "metrics.h"
+
+namespace metrics {
+
+/**
+ * Метрики игрового сервера. Запись безопасна из любого потока,
+ * Scrape собирает значения и формирует ответ на GET /metrics
+ */
+class ServerMetrics {
+public:
+    // Коды ответа HTTP, для которых хранятся гистограммы, - от 100 до 599
+    constexpr static unsigned MIN_STATUS = 100;
+    constexpr static unsigned MAX_STATUS = 599;
+
+    /**
+     * @param endpoints метки эндпоинтов. Запросы учитываются по номеру метки в этом списке
+     */
+    explicit ServerMetrics(std::vector<std::string> endpoints);
+
+    ServerMetrics(const ServerMetrics&) = delete;
+    ServerMetrics& operator=(const ServerMetrics&) = delete;
+    ~ServerMetrics();
+
+    /**
+     * Учитывает обработанный запрос. Гистограмма пары эндпоинт и код ответа создаётся при первом запросе
+     * @param endpoint номер метки эндпоинта
+     * @param status код ответа. Коды вне MIN_STATUS..MAX_STATUS не учитываются
+     * @param latency время от получения запроса до передачи ответа сессии
+     */
+    void RecordRequest(std::size_t endpoint, unsigned status, std::chrono::nanoseconds latency);
+
+    /// Количество запросов, для которых ещё не сформирован ответ
+    Counter& GetRequestsInFlight() noexcept { return requests_in_flight_; }
+    /// Длительность тика
+    Histogram& GetTickDuration() noexcept { return tick_duration_; }
+    /// Тики, выполнявшиеся дольше периода тикера
+    Counter& GetTickOverruns() noexcept { return tick_overruns_; }
+    Gauge& GetSessions() noexcept { return sessions_; }
+    Gauge& GetDogs() noexcept { return dogs_; }
+    Gauge& GetLostObjects() noexcept { return lost_objects_; }
+    /// Ожидание свободного соединения в пуле соединений с базой данных
+    Histogram& GetDbPoolWait() noexcept { return db_pool_wait_; }
+    /// Сохранение состояния игры в файл
+    Histogram& GetStateSaveDuration() noexcept { return state_save_duration_; }
+
+    /**
+     * Добавляет измерение, значение которого читается при сборе метрик (например, длина очереди).
+     * Вызывается до начала обслуживания запросов
+     * @param name имя метрики без префикса game_server_
+     * @param help описание
+     * @param read функция чтения значения, вызывается из потока, обслуживающего /metrics
+     */
+    void AddGauge(std::string name, std::string help, std::function<double()> read);
+
+    /**
+     * Добавляет счётчик, значение которого читается при сборе метрик.
+     * Вызывается до начала обслуживания запросов
+     * @param name имя метрики без префикса game_server_ и суффикса _total
+     * @param help описание
+     * @param read функция чтения значения
+     */
+    void AddCounter(std::string name, std::string help, std::function<double()> read);
+
+    /**
+     * Собирает значения всех метрик
+     * @return текст в формате Prometheus
+     */
+    [[nodiscard]] std::string Scrape() const;
+
+private:
+    struct CallbackMetric {
+        std::string name;
+        std::string help;
+        std::string_view type;
+        std::function<double()> read;
+    };
+
+    constexpr static std::size_t STATUSES = MAX_STATUS - MIN_STATUS + 1;
+
+    std::vector<std::string> endpoints_;
+    // Гистограммы [эндпоинт][код ответа - MIN_STATUS], создаются лениво
+    std::unique_ptr<std::atomic<Histogram*>[]> request_latency_;
+    Counter requests_in_flight_;
+    Histogram tick_duration_;
+    Counter tick_overruns_;
+    Gauge sessions_;
+    Gauge dogs_;
+    Gauge lost_objects_;
+    Histogram db_pool_wait_;
+    Histogram state_save_duration_;
+    std::vector<CallbackMetric> callbacks_;
+};
+
+}  // namespace metrics
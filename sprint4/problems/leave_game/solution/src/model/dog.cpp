@@ -1,5 +1,7 @@
 #include "dog.h"
 
+#include <utility>
+
 namespace model {
 
 /**
@@ -22,12 +24,18 @@ const std::string& Dog::GetName() const noexcept {
 * Двигает собаку в направлении dir со скоростью speed
 * @param direction Направление
 * @param speed Скорость
+* @return true, если изменились направление или скорость собаки
 */
-void Dog::Move(std::string_view direction, DimensionDouble speed) {
+bool Dog::Move(std::string_view direction, DimensionDouble speed) {
     using namespace std::string_literals;
     auto it = Movement::MOVEMENT_VIEW.find(direction);
-    direction_ = (direction != Movement::STOP) ? *it : direction_;
-    speed_ = Movement::MOVEMENT.at(direction)(speed);
+    const auto new_direction = (direction != Movement::STOP) ? *it : direction_;
+    const auto new_speed = Movement::MOVEMENT.at(direction)(speed);
+    const bool moved = new_direction != direction_ || new_speed != speed_;
+    changed_ = changed_ || moved;
+    direction_ = new_direction;
+    speed_ = new_speed;
+    return moved;
 }
 
 
@@ -36,6 +44,7 @@ void Dog::Move(std::string_view direction, DimensionDouble speed) {
 * @param new_point Позиция
 */
 void Dog::SetPosition(Point2d new_point){
+    changed_ = changed_ || new_point != position_;
     position_ = new_point;
 }
 
@@ -43,6 +52,7 @@ void Dog::SetPosition(Point2d new_point){
 * Останавливает собаку
 */
 void Dog::Stand(){
+    changed_ = changed_ || speed_ != Movement::Stand();
     speed_ = Movement::Stand();
 }
 
@@ -52,15 +62,19 @@ void Dog::Stand(){
  */
 void Dog::PutToBag(const FoundObject& loot) {
     bag_.push_back(loot);
+    changed_ = true;
 }
 
 void Dog::SetSpeed(Velocity2d speed) noexcept {
+    changed_ = changed_ || speed != speed_;
     speed_ = speed;
 }
 
 void Dog::SetDirection(std::string_view direction) {
     auto it = Movement::MOVEMENT_VIEW.find(direction);
-    direction_ = (direction != Movement::STOP) ? *it : direction_;
+    const auto new_direction = (direction != Movement::STOP) ? *it : direction_;
+    changed_ = changed_ || new_direction != direction_;
+    direction_ = new_direction;
 }
 
 /**
@@ -68,6 +82,7 @@ void Dog::SetDirection(std::string_view direction) {
  */
 void Dog::AddScore(std::int32_t score) noexcept {
     score_ += score;
+    changed_ = changed_ || score != 0;
 }
 
 /**
@@ -109,6 +124,7 @@ void Dog::BagClear() noexcept {
     score_ += std::accumulate(bag_.begin(), bag_.end(), 0, [](std::int32_t lhs, FoundObject& el){
         return lhs + el.value;
     });
+    changed_ = changed_ || !bag_.empty();
     bag_.clear();
 }
 
@@ -138,5 +154,13 @@ std::chrono::milliseconds Dog::GetLifeTime() const {
     return life_time_;
 }
 
+/**
+ * Сбрасывает признак изменения собаки
+ * @return true, если собака изменилась с прошлого вызова
+ */
+bool Dog::TakeChanged() noexcept {
+    return std::exchange(changed_, false);
+}
+
 
 } // namespace model
\ No newline at end of file
@@ -36,7 +36,7 @@ public:
 
     [[nodiscard]] Id GetId() const noexcept;
     [[nodiscard]] const std::string& GetName() const noexcept;
-    void Move(std::string_view direction, DimensionDouble speed);
+    bool Move(std::string_view direction, DimensionDouble speed);
     void SetPosition(Point2d new_point);
     void Stand();
     void PutToBag(const FoundObject& loot);
@@ -53,6 +53,12 @@ public:
     std::chrono::milliseconds GetStayTime() const;
     std::chrono::milliseconds GetLifeTime() const;
 
+    /**
+     * Сбрасывает признак изменения собаки
+     * @return true, если с прошлого вызова изменились позиция, скорость, направление, сумка или счёт собаки
+     */
+    bool TakeChanged() noexcept;
+
 private:
     using milliseconds = std::chrono::milliseconds;
     Id id_;
@@ -63,5 +69,7 @@ private:
     std::int32_t score_;
     milliseconds stay_time_;
     milliseconds life_time_;
+    // Изменилось ли состояние собаки, которое видят клиенты (время жизни к нему не относится)
+    bool changed_ = true;
 };
 } // namespace model
\ No newline at end of file
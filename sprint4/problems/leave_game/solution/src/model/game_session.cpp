@@ -84,6 +84,9 @@ std::optional<std::shared_ptr<model::Dog>> GameSession::FindDog(const Dog::Id& i
 std::shared_ptr<model::Dog> GameSession::AddDog(const model::Dog& dog) {
     auto shrd_dog = std::make_shared<model::Dog>(dog);
     if(dogs_.size() < limit_ && !dogs_.contains(shrd_dog->GetId())){
+        // Новая собака целиком входит в изменения, поэтому её признак изменения сбрасывается
+        shrd_dog->TakeChanged();
+        RecordChange().dogs.insert(shrd_dog->GetId());
         return (dogs_.emplace(shrd_dog->GetId(), std::move(shrd_dog)).first)->second;
     }
     return nullptr;
@@ -94,7 +97,7 @@ std::shared_ptr<model::Dog> GameSession::AddDog(const model::Dog& dog) {
  * @param dog_id id собаки
  */
 void GameSession::DeleteDog(const Dog::Id& dog_id) {
-    dogs_.erase(dog_id);
+    EraseDog(dog_id);
 }
 
 /**
@@ -104,6 +107,7 @@ void GameSession::DeleteDog(const Dog::Id& dog_id) {
  */
 const Loot& GameSession::AddLoot(const Loot& loot) {
     loot_id_ = (*loot.GetId() >= loot_id_ ) ?  *loot.GetId() + 1 : loot_id_;
+    RecordChange().loots.insert(loot.GetId());
     return (loots_.emplace(loot.GetId(), loot).first)->second;
 }
 
@@ -113,7 +117,11 @@ const Loot& GameSession::AddLoot(const Loot& loot) {
 * @return количество удалённых объектов
 */
 size_t GameSession::EraseDog(const Dog::Id& id){
-    return dogs_.erase(id);
+    const size_t erased = dogs_.erase(id);
+    if (erased != 0) {
+        RecordChange().removed_dogs.insert(id);
+    }
+    return erased;
 }
 
 /**
@@ -140,6 +148,103 @@ const GameSession::Dogs& GameSession::GetDogs() const noexcept {
         return loot_generator_.GetProbability();
 }
 
+/**
+ * Возвращает версию состояния сессии
+ * @return версия состояния
+ */
+std::uint64_t GameSession::GetVersion() const noexcept {
+    return version_;
+}
+
+/**
+ * Копирует состояние сессии без истории изменений
+ * @return копия состояния сессии
+ */
+GameSession GameSession::CopyState() const {
+    GameSession copy{id_, map_, loot_generator_};
+    copy.dogs_.reserve(dogs_.size());
+    for (const auto& [id, dog] : dogs_) {
+        copy.dogs_.emplace(id, std::make_shared<Dog>(*dog));
+    }
+    copy.loots_ = loots_;
+    copy.loot_id_ = loot_id_;
+    copy.version_ = version_;
+    return copy;
+}
+
+/**
+ * Отмечает изменение состояния сессии и запоминает изменившихся собак
+ */
+void GameSession::MarkChanged() {
+    CollectChangedDogs(RecordChange());
+}
+
+/**
+ * Отмечает изменение состояния сессии одной собакой
+ * @param id id собаки
+ */
+void GameSession::MarkDogChanged(const Dog::Id& id) {
+    RecordChange().dogs.insert(id);
+}
+
+/**
+ * Собирает изменения сессии после версии version из истории изменений.
+ * Собаки и предметы, удалённые после version, в добавленные и изменённые не попадают
+ * @param version версия состояния, известная клиенту
+ * @return изменения или nullopt, если версии нет в истории
+ */
+std::optional<GameSession::Changes> GameSession::GetChangesSince(std::uint64_t version) const {
+    const std::uint64_t oldest = history_.empty() ? version_ : history_.front().base_version;
+    if (version > version_ || version < oldest) {
+        return std::nullopt;
+    }
+    Changes result;
+    for (const auto& change_set : history_) {
+        if (change_set.version <= version) {
+            continue;
+        }
+        const auto& changes = change_set.changes;
+        result.dogs.insert(changes.dogs.begin(), changes.dogs.end());
+        result.removed_dogs.insert(changes.removed_dogs.begin(), changes.removed_dogs.end());
+        result.loots.insert(changes.loots.begin(), changes.loots.end());
+        result.removed_loots.insert(changes.removed_loots.begin(), changes.removed_loots.end());
+    }
+    // Id собак и предметов не используются повторно, поэтому удаление всегда последнее изменение
+    for (const auto& id : result.removed_dogs) {
+        result.dogs.erase(id);
+    }
+    for (const auto& id : result.removed_loots) {
+        result.loots.erase(id);
+    }
+    return result;
+}
+
+/**
+ * Увеличивает версию состояния и возвращает набор изменений текущего тика, открывая его при необходимости
+ * @return изменения текущего тика
+ */
+GameSession::Changes& GameSession::RecordChange() {
+    if (!change_set_open_) {
+        history_.push_back(ChangeSet{version_, version_, {}});
+        change_set_open_ = true;
+    }
+    auto& change_set = history_.back();
+    change_set.version = ++version_;
+    return change_set.changes;
+}
+
+/**
+ * Добавляет в изменения собак, у которых установлен признак изменения, и сбрасывает его
+ * @param changes изменения текущего тика
+ */
+void GameSession::CollectChangedDogs(Changes& changes) {
+    for (const auto& [id, dog] : dogs_) {
+        if (dog && dog->TakeChanged()) {
+            changes.dogs.insert(id);
+        }
+    }
+}
+
 /**
 * Генерирует позицию объекта на дороге
 * @param enable true - включить генератор, false - возвращать всегда стартовую точку дороги
@@ -166,9 +271,14 @@ void GameSession::GenerateLoot(std::chrono::milliseconds tick, bool enable) {
         type = GenerateInRange(0ul, loot_types.size() - 1);
     }
 
+    if (count == 0) {
+        return;
+    }
+    auto& changes = RecordChange();
     for(size_t i = 0; i < count; ++i) {
         auto id = Loot::Id{loot_id_++};
         loots_.emplace(id, Loot{id, map_->GetLootTypes().at(type).value, GenerateNewPosition(enable), type});
+        changes.loots.insert(id);
     }
 }
 
@@ -233,6 +343,7 @@ void GameSession::CollectingAndReturningLoot(ItemGatherer& item_gatherer, std::u
             auto& loot = loot_numb_to_item.at(gatherring_event.item_id);
             dog->PutToBag(loot);
             loots_.erase(Loot::Id{*loot.id});
+            RecordChange().removed_loots.insert(Loot::Id{*loot.id});
             loot_numb_to_item.erase(gatherring_event.item_id);
         }
     }
@@ -270,6 +381,13 @@ void GameSession::Update(std::chrono::milliseconds tick){
     }
     CollectingAndReturningLoot(item_gatherer, gather_by_index);
     GenerateLoot(tick);
+
+    // Тик закрывает свой набор изменений, даже если собаки стояли: версия растёт каждый тик
+    CollectChangedDogs(RecordChange());
+    change_set_open_ = false;
+    while (history_.size() > CHANGE_HISTORY_SIZE) {
+        history_.pop_front();
+    }
 }
 
 
@@ -1,4 +1,7 @@
 #pragma once
+#include <cstdint>
+#include <deque>
+#include <optional>
 #include <stdexcept>
 #include <unordered_set>
 
@@ -16,6 +19,21 @@ public:
     using Dogs = std::unordered_map<Dog::Id, std::shared_ptr<model::Dog>, Dog::IdHasher>;
     using Loots = std::unordered_map<Loot::Id, Loot, Loot::IdHasher>;
 
+    /**
+     * Изменения состояния сессии: добавленные или изменённые и удалённые собаки и потерянные предметы.
+     * Потерянные предметы не меняются, поэтому для них учитываются только добавление и удаление
+     */
+    struct Changes {
+        std::unordered_set<Dog::Id, Dog::IdHasher> dogs;
+        std::unordered_set<Dog::Id, Dog::IdHasher> removed_dogs;
+        std::unordered_set<Loot::Id, Loot::IdHasher> loots;
+        std::unordered_set<Loot::Id, Loot::IdHasher> removed_loots;
+    };
+
+    // Сколько последних тиков хранится в истории изменений. Клиенту, отставшему сильнее,
+    // нужно полное состояние сессии
+    constexpr static std::size_t CHANGE_HISTORY_SIZE = 64;
+
     GameSession(Id id, std::shared_ptr<const Map> map, loot_gen::LootGenerator gen):
             id_(id), map_(std::move(map)), loot_generator_(std::move(gen)), limit_(map_->GetLimitPlayers()) {}
 
@@ -41,7 +59,53 @@ public:
     void Update(std::chrono::milliseconds tick);
     const Loot& AddLoot(const Loot& loot);
 
+    /**
+     * Версия состояния сессии. Увеличивается при каждом изменении собак и потерянных предметов,
+     * поэтому представления состояния, построенные для одной версии, можно использовать повторно
+     * @return версия состояния
+     */
+    [[nodiscard]] std::uint64_t GetVersion() const noexcept;
+
+    /**
+     * Отмечает изменение состояния, сделанное в обход методов сессии (например, смену направления собаки)
+     */
+    void MarkChanged();
+
+    /**
+     * Отмечает изменение одной собаки, сделанное в обход методов сессии (например, смену направления).
+     * В отличие от MarkChanged не обходит остальных собак
+     * @param id id изменившейся собаки
+     */
+    void MarkDogChanged(const Dog::Id& id);
+
+    /**
+     * Собирает изменения сессии, сделанные после версии version
+     * @param version версия состояния, известная клиенту
+     * @return изменения или nullopt, если версии нет в истории изменений (слишком старая или из будущего)
+     */
+    [[nodiscard]] std::optional<Changes> GetChangesSince(std::uint64_t version) const;
+
+    /**
+     * Копирует собак, потерянные предметы и версию сессии без истории изменений.
+     * Копия не разделяет собак с сессией, поэтому её можно читать из других потоков, пока сессия меняется
+     * @return копия состояния сессии
+     */
+    [[nodiscard]] GameSession CopyState() const;
+
 private:
+    /**
+     * Изменения одного тика. Изменения между тиками (вход игроков, команды движения)
+     * добавляются в набор следующего тика
+     */
+    struct ChangeSet {
+        std::uint64_t base_version = 0;  // Версия до первого изменения набора
+        std::uint64_t version = 0;       // Версия после последнего изменения набора
+        Changes changes;
+    };
+
+    Changes& RecordChange();
+    void CollectChangedDogs(Changes& changes);
+
     void DetectCollisionWithRoadBorders(const std::shared_ptr<model::Dog>& dog, Point2d current_position, Point2d new_position);
     void CollectingAndReturningLoot(ItemGatherer& item_gatherer, std::unordered_map<size_t, std::shared_ptr<model::Dog>>& gather_by_index);
 
@@ -53,6 +117,9 @@ private:
     Dogs dogs_;
     Loots loots_;
     size_t loot_id_ = 0;
+    std::uint64_t version_ = 0;
+    std::deque<ChangeSet> history_;
+    bool change_set_open_ = false;
 };
 
 class DogDropOffGenerator {
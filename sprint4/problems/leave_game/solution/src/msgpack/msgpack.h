@@ -0,0 +1,293 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace msgpack {
+
+/**
+ * Запись значений в формате MessagePack (https://msgpack.org) в конец строки.
+ * Каждое значение записывается в самой короткой подходящей форме. Длины массивов и словарей
+ * записываются до их элементов, поэтому документ собирается без промежуточного дерева
+ */
+class Writer {
+public:
+    explicit Writer(std::string& out) noexcept : out_(out) {}
+
+    void Nil() {
+        Put(0xc0);
+    }
+
+    void Bool(bool value) {
+        Put(value ? 0xc3 : 0xc2);
+    }
+
+    void Uint(std::uint64_t value) {
+        if (value < 0x80) {
+            Put(static_cast<std::uint8_t>(value));
+        } else if (value <= UINT8_MAX) {
+            Put(0xcc);
+            Put(static_cast<std::uint8_t>(value));
+        } else if (value <= UINT16_MAX) {
+            Put(0xcd);
+            PutBigEndian(static_cast<std::uint16_t>(value));
+        } else if (value <= UINT32_MAX) {
+            Put(0xce);
+            PutBigEndian(static_cast<std::uint32_t>(value));
+        } else {
+            Put(0xcf);
+            PutBigEndian(value);
+        }
+    }
+
+    void Int(std::int64_t value) {
+        if (value >= 0) {
+            Uint(static_cast<std::uint64_t>(value));
+        } else if (value >= -32) {
+            Put(static_cast<std::uint8_t>(value));
+        } else if (value >= INT8_MIN) {
+            Put(0xd0);
+            Put(static_cast<std::uint8_t>(value));
+        } else if (value >= INT16_MIN) {
+            Put(0xd1);
+            PutBigEndian(static_cast<std::uint16_t>(value));
+        } else if (value >= INT32_MIN) {
+            Put(0xd2);
+            PutBigEndian(static_cast<std::uint32_t>(value));
+        } else {
+            Put(0xd3);
+            PutBigEndian(static_cast<std::uint64_t>(value));
+        }
+    }
+
+    void Double(double value) {
+        Put(0xcb);
+        PutBigEndian(std::bit_cast<std::uint64_t>(value));
+    }
+
+    void String(std::string_view value) {
+        if (value.size() < 32) {
+            Put(static_cast<std::uint8_t>(0xa0 | value.size()));
+        } else if (value.size() <= UINT8_MAX) {
+            Put(0xd9);
+            Put(static_cast<std::uint8_t>(value.size()));
+        } else if (value.size() <= UINT16_MAX) {
+            Put(0xda);
+            PutBigEndian(static_cast<std::uint16_t>(value.size()));
+        } else {
+            Put(0xdb);
+            PutBigEndian(static_cast<std::uint32_t>(value.size()));
+        }
+        out_.append(value);
+    }
+
+    /**
+     * Начинает массив. За ним должны следовать size значений
+     */
+    void Array(std::size_t size) {
+        PutContainer(size, 0x90, 0xdc);
+    }
+
+    /**
+     * Начинает словарь. За ним должны следовать size пар ключ-значение
+     */
+    void Map(std::size_t size) {
+        PutContainer(size, 0x80, 0xde);
+    }
+
+private:
+    void Put(std::uint8_t byte) {
+        out_.push_back(static_cast<char>(byte));
+    }
+
+    template <typename T>
+    void PutBigEndian(T value) {
+        for (int shift = static_cast<int>(sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+            Put(static_cast<std::uint8_t>(value >> shift));
+        }
+    }
+
+    // Маркер 16-битной длины, за ним следует маркер 32-битной
+    void PutContainer(std::size_t size, std::uint8_t fix_marker, std::uint8_t marker16) {
+        if (size < 16) {
+            Put(static_cast<std::uint8_t>(fix_marker | size));
+        } else if (size <= UINT16_MAX) {
+            Put(marker16);
+            PutBigEndian(static_cast<std::uint16_t>(size));
+        } else {
+            Put(marker16 + 1);
+            PutBigEndian(static_cast<std::uint32_t>(size));
+        }
+    }
+
+    std::string& out_;
+};
+
+/**
+ * Последовательное чтение значений MessagePack, записанных Writer.
+ * Если очередное значение имеет другой тип или данные закончились, бросает std::invalid_argument
+ */
+class Reader {
+public:
+    explicit Reader(std::string_view data) noexcept : data_(data) {}
+
+    [[nodiscard]] bool AtEnd() const noexcept {
+        return pos_ == data_.size();
+    }
+
+    bool Bool() {
+        switch (Take()) {
+            case 0xc2:
+                return false;
+            case 0xc3:
+                return true;
+            default:
+                throw std::invalid_argument("msgpack: bool expected");
+        }
+    }
+
+    std::uint64_t Uint() {
+        const auto value = Int64();
+        if (value.negative) {
+            throw std::invalid_argument("msgpack: unsigned integer expected");
+        }
+        return value.bits;
+    }
+
+    std::int64_t Int() {
+        const auto value = Int64();
+        if (!value.negative && value.bits > static_cast<std::uint64_t>(INT64_MAX)) {
+            throw std::invalid_argument("msgpack: integer is out of range");
+        }
+        return static_cast<std::int64_t>(value.bits);
+    }
+
+    double Double() {
+        switch (Take()) {
+            case 0xca:
+                return std::bit_cast<float>(TakeBigEndian<std::uint32_t>());
+            case 0xcb:
+                return std::bit_cast<double>(TakeBigEndian<std::uint64_t>());
+            default:
+                throw std::invalid_argument("msgpack: float expected");
+        }
+    }
+
+    std::string_view String() {
+        const std::uint8_t marker = Take();
+        std::size_t size = 0;
+        if ((marker & 0xe0) == 0xa0) {
+            size = marker & 0x1f;
+        } else if (marker == 0xd9) {
+            size = Take();
+        } else if (marker == 0xda) {
+            size = TakeBigEndian<std::uint16_t>();
+        } else if (marker == 0xdb) {
+            size = TakeBigEndian<std::uint32_t>();
+        } else {
+            throw std::invalid_argument("msgpack: string expected");
+        }
+        Require(size);
+        const auto value = data_.substr(pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    /**
+     * Читает заголовок массива
+     * @return количество элементов
+     */
+    std::size_t Array() {
+        return Container(0x90, 0xdc, "msgpack: array expected");
+    }
+
+    /**
+     * Читает заголовок словаря
+     * @return количество пар ключ-значение
+     */
+    std::size_t Map() {
+        return Container(0x80, 0xde, "msgpack: map expected");
+    }
+
+private:
+    struct Integer {
+        std::uint64_t bits = 0;
+        bool negative = false;
+    };
+
+    Integer Int64() {
+        const std::uint8_t marker = Take();
+        if (marker < 0x80) {
+            return {marker};
+        }
+        if (marker >= 0xe0) {
+            return {static_cast<std::uint64_t>(static_cast<std::int8_t>(marker)), true};
+        }
+        auto signed_value = [](std::int64_t value) {
+            return Integer{static_cast<std::uint64_t>(value), value < 0};
+        };
+        switch (marker) {
+            case 0xcc:
+                return {Take()};
+            case 0xcd:
+                return {TakeBigEndian<std::uint16_t>()};
+            case 0xce:
+                return {TakeBigEndian<std::uint32_t>()};
+            case 0xcf:
+                return {TakeBigEndian<std::uint64_t>()};
+            case 0xd0:
+                return signed_value(static_cast<std::int8_t>(Take()));
+            case 0xd1:
+                return signed_value(static_cast<std::int16_t>(TakeBigEndian<std::uint16_t>()));
+            case 0xd2:
+                return signed_value(static_cast<std::int32_t>(TakeBigEndian<std::uint32_t>()));
+            case 0xd3:
+                return signed_value(static_cast<std::int64_t>(TakeBigEndian<std::uint64_t>()));
+            default:
+                throw std::invalid_argument("msgpack: integer expected");
+        }
+    }
+
+    std::size_t Container(std::uint8_t fix_marker, std::uint8_t marker16, const char* error) {
+        const std::uint8_t marker = Take();
+        if ((marker & 0xf0) == fix_marker) {
+            return marker & 0x0f;
+        }
+        if (marker == marker16) {
+            return TakeBigEndian<std::uint16_t>();
+        }
+        if (marker == marker16 + 1) {
+            return TakeBigEndian<std::uint32_t>();
+        }
+        throw std::invalid_argument(error);
+    }
+
+    void Require(std::size_t size) const {
+        if (data_.size() - pos_ < size) {
+            throw std::invalid_argument("msgpack: unexpected end of data");
+        }
+    }
+
+    std::uint8_t Take() {
+        Require(1);
+        return static_cast<std::uint8_t>(data_[pos_++]);
+    }
+
+    template <typename T>
+    T TakeBigEndian() {
+        Require(sizeof(T));
+        T value = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            value = static_cast<T>((value << 8) | static_cast<std::uint8_t>(data_[pos_++]));
+        }
+        return value;
+    }
+
+    std::string_view data_;
+    std::size_t pos_ = 0;
+};
+
+}  // namespace msgpack
@@ -0,0 +1,101 @@
+#include "msgpack_model.h"
+
+#include "../json/tag_invoke_utils.h"
+
+namespace msgpack {
+
+namespace {
+
+// Ключи верхнего уровня совпадают с ключами JSON-ответа
+const std::string_view PLAYERS_KEY = detail::UserKey::PLAYERS;
+const std::string_view LOST_KEY = detail::LootKey::LOST;
+
+// Количество полей в записи собаки и клада
+constexpr std::size_t DOG_FIELDS = 7;
+constexpr std::size_t LOOT_FIELDS = 3;
+constexpr std::size_t BAG_ITEM_FIELDS = 2;
+
+void Expect(bool condition, const char* error) {
+    if (!condition) {
+        throw std::invalid_argument(error);
+    }
+}
+
+}  // namespace
+
+void EncodeGameState(const model::GameSession& session, std::string& out) {
+    Writer writer(out);
+    writer.Map(2);
+
+    const auto& dogs = session.GetDogs();
+    writer.String(PLAYERS_KEY);
+    writer.Map(dogs.size());
+    for (const auto& [id, dog] : dogs) {
+        writer.Uint(*id);
+        writer.Array(DOG_FIELDS);
+        writer.Double(dog->GetPosition().x);
+        writer.Double(dog->GetPosition().y);
+        writer.Double(dog->GetSpeed().dx);
+        writer.Double(dog->GetSpeed().dy);
+        writer.String(dog->GetDirection());
+        writer.Int(dog->GetScore());
+        writer.Array(dog->GetBag().size());
+        for (const auto& item : dog->GetBag()) {
+            writer.Array(BAG_ITEM_FIELDS);
+            writer.Uint(*item.id);
+            writer.Uint(item.type);
+        }
+    }
+
+    const auto& loots = session.GetLoots();
+    writer.String(LOST_KEY);
+    writer.Map(loots.size());
+    for (const auto& [id, loot] : loots) {
+        writer.Uint(*id);
+        writer.Array(LOOT_FIELDS);
+        writer.Uint(loot.GetType());
+        writer.Double(loot.GetPosition().x);
+        writer.Double(loot.GetPosition().y);
+    }
+}
+
+GameState DecodeGameState(std::string_view data) {
+    Reader reader(data);
+    GameState state;
+    const std::size_t keys = reader.Map();
+    for (std::size_t key = 0; key < keys; ++key) {
+        const auto name = reader.String();
+        const std::size_t size = reader.Map();
+        if (name == PLAYERS_KEY) {
+            for (std::size_t i = 0; i < size; ++i) {
+                const auto id = reader.Uint();
+                Expect(reader.Array() == DOG_FIELDS, "msgpack: invalid dog record");
+                auto& dog = state.dogs[id];
+                dog.position = {reader.Double(), reader.Double()};
+                dog.speed = {reader.Double(), reader.Double()};
+                dog.direction = reader.String();
+                dog.score = static_cast<std::int32_t>(reader.Int());
+                dog.bag.resize(reader.Array());
+                for (auto& item : dog.bag) {
+                    Expect(reader.Array() == BAG_ITEM_FIELDS, "msgpack: invalid bag item");
+                    item.id = reader.Uint();
+                    item.type = reader.Uint();
+                }
+            }
+        } else if (name == LOST_KEY) {
+            for (std::size_t i = 0; i < size; ++i) {
+                const auto id = reader.Uint();
+                Expect(reader.Array() == LOOT_FIELDS, "msgpack: invalid lost object record");
+                auto& loot = state.loots[id];
+                loot.type = reader.Uint();
+                loot.position = {reader.Double(), reader.Double()};
+            }
+        } else {
+            throw std::invalid_argument("msgpack: unknown game state key");
+        }
+    }
+    Expect(reader.AtEnd(), "msgpack: trailing data after game state");
+    return state;
+}
+
+}  // namespace msgpack
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "msgpack.h"
+#include "../model/game_session.h"
+
+namespace msgpack {
+
+/**
+ * Состояние игровой сессии, прочитанное из MessagePack. Используется в тестах и клиентах для проверки кодирования
+ */
+struct GameState {
+    struct BagItem {
+        std::uint64_t id = 0;
+        std::uint64_t type = 0;
+
+        [[nodiscard]] auto operator<=>(const BagItem&) const = default;
+    };
+
+    struct Dog {
+        model::Point2d position;
+        model::Velocity2d speed{};
+        std::string direction;
+        std::int32_t score = 0;
+        std::vector<BagItem> bag;
+    };
+
+    struct Loot {
+        std::uint64_t type = 0;
+        model::Point2d position;
+    };
+
+    std::map<std::uint64_t, Dog> dogs;
+    std::map<std::uint64_t, Loot> loots;
+};
+
+/**
+ * Кодирует состояние сессии (ответ /api/v1/game/state) в MessagePack прямо из модели, без промежуточного документа:
+ *
+ *     {"players":     {<id собаки>: [x, y, dx, dy, "dir", score, [[id клада, тип], ...]], ...},
+ *      "lostObjects": {<id клада>: [тип, x, y], ...}}
+ *
+ * Ключи верхнего уровня совпадают с JSON-ответом, id - целые числа, координаты и скорости - float64
+ * @param session игровая сессия
+ * @param out строка, в конец которой дописывается документ
+ */
+void EncodeGameState(const model::GameSession& session, std::string& out);
+
+/**
+ * Декодирует состояние сессии, закодированное EncodeGameState
+ * @param data документ
+ * @return состояние сессии. При ошибке формата бросает std::invalid_argument
+ */
+GameState DecodeGameState(std::string_view data);
+
+}  // namespace msgpack
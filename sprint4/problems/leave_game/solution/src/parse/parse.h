@@ -20,6 +20,25 @@ struct Args {
     bool randomize_spawn = false;
     std::string state_file;
     uint32_t save_state_period{0};
+    uint32_t io_shards{0};
+    uint32_t pipeline_depth{16};
+    uint32_t max_sessions{0};
+    uint32_t max_websockets{0};
+    uint32_t api_queue_limit{0};
+    uint32_t token_rate_limit{0};
+    uint32_t token_rate_burst{0};
+    uint32_t ip_rate_limit{0};
+    uint32_t ip_rate_burst{0};
+    bool use_sendfile = true;
+    bool static_cache = true;
+    bool static_watch = false;
+    std::string unix_socket;
+    std::string admin_socket;
+    bool tcp = true;
+    bool metrics = false;
+    uint32_t trace_sample_period{0};
+    uint32_t trace_buffer{1024};
+    bool trace_log = false;
 };
 
 /**
@@ -41,7 +60,39 @@ struct Args {
             ("www-root,w", po::value(&args.www_root)->value_name("directory path"), "set static files root")
             ("randomize-spawn-points", "spawn dogs at random positions")
             ("state-file", po::value(&args.state_file)->value_name("file"), "set game save file")
-            ("save-state-period", po::value<uint32_t>(&args.save_state_period)->value_name("milliseconds"), "set period for autosave");
+            ("save-state-period", po::value<uint32_t>(&args.save_state_period)->value_name("milliseconds"), "set period for autosave")
+            ("io-shards", po::value<uint32_t>(&args.io_shards)->value_name("count"),
+                    "run count independent io_context shards with SO_REUSEPORT acceptors (0 - one shared io_context)")
+            ("pipeline-depth", po::value<uint32_t>(&args.pipeline_depth)->value_name("requests"),
+                    "set max pipelined requests per connection awaiting response (default 16)")
+            ("max-sessions", po::value<uint32_t>(&args.max_sessions)->value_name("count"),
+                    "set max concurrent sessions per listener, accept is paused above it (0 - unlimited)")
+            ("max-websockets", po::value<uint32_t>(&args.max_websockets)->value_name("count"),
+                    "set max open WebSocket connections, above it upgrade is answered 503 (default - --max-sessions, 0 - unlimited)")
+            ("api-queue-limit", po::value<uint32_t>(&args.api_queue_limit)->value_name("requests"),
+                    "set max API requests queued to the game strand, above it 503 is returned (0 - unlimited)")
+            ("token-rate-limit", po::value<uint32_t>(&args.token_rate_limit)->value_name("requests/s"),
+                    "set max API request rate per player token, above it 429 is returned (0 - unlimited)")
+            ("token-rate-burst", po::value<uint32_t>(&args.token_rate_burst)->value_name("requests"),
+                    "set burst allowed above --token-rate-limit (default - one second of requests)")
+            ("ip-rate-limit", po::value<uint32_t>(&args.ip_rate_limit)->value_name("requests/s"),
+                    "set max API request rate per client IP address, above it 429 is returned (0 - unlimited)")
+            ("ip-rate-burst", po::value<uint32_t>(&args.ip_rate_burst)->value_name("requests"),
+                    "set burst allowed above --ip-rate-limit (default - one second of requests)")
+            ("disable-sendfile", "copy static files to the socket through user-space buffers instead of sendfile")
+            ("disable-static-cache", "read static files from disk on every request instead of the in-memory index")
+            ("static-watch", "rebuild the static files index when files in www-root change (inotify)")
+            ("unix-socket", po::value(&args.unix_socket)->value_name("path"),
+                    "also listen on a Unix domain stream socket ('@name' - Linux abstract namespace)")
+            ("disable-tcp", "do not listen on TCP port 8080, only on --unix-socket")
+            ("admin-socket", po::value(&args.admin_socket)->value_name("path"),
+                    "serve /metrics and /admin/traces only on this Unix domain socket, not on the public listeners ('@name' - abstract namespace)")
+            ("metrics", "collect server metrics and serve them in Prometheus format on GET /metrics")
+            ("trace-sample-period", po::value<uint32_t>(&args.trace_sample_period)->value_name("requests"),
+                    "trace every N-th request of each thread, recent traces are served on GET /admin/traces (0 - off)")
+            ("trace-buffer", po::value<uint32_t>(&args.trace_buffer)->value_name("count"),
+                    "set number of recent traces kept for /admin/traces (default 1024)")
+            ("trace-log", "also write every request trace to the log");
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -51,6 +102,35 @@ struct Args {
         args.randomize_spawn = true;
     }
 
+    if (vm.contains("disable-sendfile")) {
+        args.use_sendfile = false;
+    }
+
+    if (vm.contains("disable-static-cache")) {
+        args.static_cache = false;
+    }
+
+    if (vm.contains("static-watch")) {
+        args.static_watch = true;
+    }
+
+    if (vm.contains("disable-tcp")) {
+        args.tcp = false;
+    }
+
+    if (vm.contains("metrics")) {
+        args.metrics = true;
+    }
+
+    if (vm.contains("trace-log")) {
+        args.trace_log = true;
+    }
+
+    // WebSocket-соединения не учитываются в --max-sessions, по умолчанию для них тот же предел
+    if (!vm.contains("max-websockets")) {
+        args.max_websockets = args.max_sessions;
+    }
+
     if (vm.contains("tick-period")) {
         args.tick_period = tick_period;
     }
@@ -65,6 +145,10 @@ struct Args {
         throw std::runtime_error("Usage: game_server --config-file <config-path> --www-root <static-files-dir>");
     }
 
+    if (!args.tcp && args.unix_socket.empty()) {
+        throw std::runtime_error("--disable-tcp requires --unix-socket");
+    }
+
     return args;
 }
 } // namespace parse
\ No newline at end of file
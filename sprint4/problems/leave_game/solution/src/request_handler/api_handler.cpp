@@ -1,142 +1,130 @@
 
 #include "api_handler.h"
+#include "static_asset_index.h"
+
+#include <array>
+#include <charconv>
 
 using namespace detail;
 
 namespace http_handler {
-bool ApiHandler::IsAPIRequest(const StringRequest& req) {
-    return req.target().starts_with(EndPoint::API);
-}
+
+namespace {
 
 /**
- * Обработать запрос к API
- * @param req Запрос StringRequest {http::request<http::string_body>}
- * @return Возвращает ответ StringResponse{http::response<http::string_body>}
+ * Ключ объекта состояния - id в десятичной записи, без выделения памяти
  */
-StringResponse ApiHandler::HandleApiRequest(const StringRequest& req){
-    using namespace model;
-    using namespace std::literals::string_view_literals;
-
-    auto method_not_allowed = [&req](std::string_view text, std::string_view allow){
-        return MakeTextResponse(req, http::status::method_not_allowed, text, CacheControl::NO_CACHE, allow);
-    };
-
-    auto is_get_or_head_request = [&req](){
-        return (req.method() == http::verb::get || req.method() == http::verb::head);
-    };
-
-    auto is_post_request = [&req](){
-        return (req.method() == http::verb::post);
-    };
-
-    auto decoded_target = util::UrlDecode(std::string{req.target()});
+class IdKey {
+public:
+    explicit IdKey(std::uint64_t id) noexcept
+        : size_(std::to_chars(buffer_, buffer_ + sizeof(buffer_), id).ptr - buffer_) {
+    }
 
-    if (decoded_target.starts_with(EndPoint::MAPS)) {
-        return !is_get_or_head_request() ? method_not_allowed(ErrorResponse::INVALID_GET, Api::GET_HEAD) : RequestToMaps(req, decoded_target);
+    operator std::string_view() const noexcept {
+        return {buffer_, size_};
     }
 
-    if(decoded_target.starts_with(EndPoint::GAME)){
-        if (decoded_target == EndPoint::PLAYERS) {
-            return !is_get_or_head_request() ? method_not_allowed(ErrorResponse::INVALID_GET, Api::GET_HEAD) : RequestForListPlayers(req);
-        }
+private:
+    char buffer_[20];
+    std::size_t size_;
+};
 
-        if (decoded_target == EndPoint::JOIN) {
-            return !is_post_request() ? method_not_allowed(ErrorResponse::INVALID_POST, Api::POST) : RequestToJoin(req);
-        }
+}  // namespace
 
-        if (decoded_target == EndPoint::STATE) {
-            return !is_get_or_head_request() ? method_not_allowed(ErrorResponse::INVALID_GET, Api::GET_HEAD) : RequestToState(req);
-        }
+bool ApiHandler::IsAPIRequest(const StringRequest& req) {
+    return req.target().starts_with(EndPoint::API);
+}
 
-        if (decoded_target == EndPoint::ACTION) {
-            return !is_post_request() ? method_not_allowed(ErrorResponse::INVALID_POST, Api::POST) : RequestToAction(req);
-        }
+/**
+ * Обработать запрос к API
+ * @param req Запрос StringRequest {http::request<http::string_body>}
+ * @return ответ StringResponse или SharedBufferResponse со снимком состояния сессии
+ */
+VariantResponse ApiHandler::HandleApiRequest(const StringRequest& req){
+    using namespace std::literals;
 
-        if(app_.GetTickMode() && decoded_target == EndPoint::TICK){
-            return !is_post_request() ? method_not_allowed(ErrorResponse::INVALID_POST, Api::POST) : RequestToTick(req);
-        }
+    // Буфер заполняется, только если путь нужно декодировать
+    std::string decoded_path;
+    const auto match = ApiRouter::Match(req.target(), decoded_path);
+    if (!match || (match->spec->route == ApiRoute::TICK && !app_.GetTickMode())) {
+        return MakeTextResponse(req, http::status::bad_request,
+                                ErrorResponse::BAD_REQ("The request "s + std::string{req.target()} + " does not exist"s),
+                                CacheControl::NO_CACHE);
+    }
 
-        if(decoded_target.starts_with(EndPoint::RECORDS)){
-            return !is_get_or_head_request() ? method_not_allowed(ErrorResponse::INVALID_GET, Api::GET_HEAD) : RequestToRecords(req, decoded_target);
-        }
+    if (!ApiRouter::IsAllowed(match->spec->methods, req.method())) {
+        const bool get_head = match->spec->methods == ApiMethods::GET_HEAD;
+        return MakeTextResponse(req, http::status::method_not_allowed,
+                                get_head ? ErrorResponse::INVALID_GET : ErrorResponse::INVALID_POST,
+                                CacheControl::NO_CACHE, get_head ? Api::GET_HEAD : Api::POST);
     }
 
-    return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_REQ("The request "s+ decoded_target +" does not exist"s), CacheControl::NO_CACHE);
+    switch (match->spec->route) {
+        case ApiRoute::MAPS:
+            return RequestToMaps(req);
+        case ApiRoute::MAP:
+            return RequestToMap(req, match->param);
+        case ApiRoute::PLAYERS:
+            return RequestForListPlayers(req);
+        case ApiRoute::JOIN:
+            return RequestToJoin(req);
+        case ApiRoute::STATE:
+            return RequestToState(req, match->query);
+        case ApiRoute::ACTION:
+            return RequestToAction(req);
+        case ApiRoute::TICK:
+            return RequestToTick(req);
+        case ApiRoute::RECORDS:
+            return RequestToRecords(req, match->query, use_cases_);
+    }
+    return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_REQ(), CacheControl::NO_CACHE);
 }
 
 /**
  * Ответ на запрос получения списка игроков в той же сессии
  * @param req Запрос StringRequest {http::request<http::string_body>}
- * @return Возвращает ответ StringResponse{http::response<http::string_body>}
+ * @return ответ со снимком сессии игрока
  */
-StringResponse ApiHandler::RequestForListPlayers(const StringRequest& req){
-    using namespace model;
-
-    return ExecuteAuthorized(req, [&req](const std::shared_ptr<app::Player>& player) {
-        json::object obj;
-        if(player){
-            auto dogs = player->GetSession()->GetDogs();
-            for (const auto &[id, dog]: dogs) {
-                obj[std::to_string(*id)] = {UserKey::NAME, dog->GetName()};
-            }
-        }
-        return MakeTextResponse(req, http::status::ok, json::serialize(obj), CacheControl::NO_CACHE);
+VariantResponse ApiHandler::RequestForListPlayers(const StringRequest& req){
+    return ExecuteAuthorized(req, [this, &req](const std::shared_ptr<app::Player>& player) {
+        auto snapshot = snapshots_.GetPlayers(*player->GetSession());
+        const std::string_view body = snapshot->body;
+        return MakeSharedTextResponse(req, http::status::ok, std::move(snapshot), body, CacheControl::NO_CACHE);
     });
 }
 
 /**
- * Попытаться извлечь Токен аутентификации
+ * Формирует список игроков сессии
+ * @param session игровая сессия
+ * @param sp ресурс памяти для элементов документа
+ * @return JSON-объект: имена игроков по id собак
+ */
+json::object ApiHandler::MakePlayerList(const model::GameSession& session, json::storage_ptr sp) {
+    using namespace model;
+    json::object obj(sp);
+    for (const auto &[id, dog]: session.GetDogs()) {
+        obj[std::to_string(*id)] = {UserKey::NAME, dog->GetName()};
+    }
+    return obj;
+}
+
+/**
+ * Попытаться извлечь Токен аутентификации. Заголовок разбирается на месте, без промежуточных строк
  * @param req Запрос StringRequest {http::request<http::string_body>}
  * @return Возвращает токен, если структура запроса и токена выли верны, иначе nullopt
  */
 std::optional<app::Token> ApiHandler::TryExtractToken(const StringRequest& req) {
-    std::string authorization;
-
-    if (req.count(http::field::authorization)) {
-        authorization = req.at(http::field::authorization);
-    } else {
-        return std::nullopt;
-    }
-
-    const std::string bearer = "Bearer ";
-    if (authorization.starts_with(bearer)) {
-        authorization = authorization.substr(bearer.size());
-    } else {
-        return std::nullopt;
-    }
+    constexpr std::string_view BEARER = "Bearer "sv;
 
-    if (!std::all_of(authorization.begin(), authorization.end(), ::isxdigit)) {
+    const auto it = req.find(http::field::authorization);
+    if (it == req.end()) {
         return std::nullopt;
     }
-
-    if (authorization.size() != app::PlayerTokens::GetTokenLenght()) {
+    const std::string_view authorization = it->value();
+    if (!authorization.starts_with(BEARER)) {
         return std::nullopt;
     }
-
-    std::transform(authorization.begin(), authorization.end(), authorization.begin(),
-                   [](unsigned char c) {
-                       return std::tolower(c);
-                   });
-    return app::Token(authorization);
-}
-
-/**
- * Проверяет по токену, что пользователю разрешено выполнить некоторое действие
- * @param req Запрос StringRequest {http::request<http::string_body>}
- * @param action действие
- * @return Возвращает ответ StringResponse{http::response<http::string_body>}
- */
-StringResponse ApiHandler::ExecuteAuthorized(const StringRequest& req,
-                                              const std::function<StringResponse(std::shared_ptr<app::Player>&)>& action) {
-    if (auto token = ApiHandler::TryExtractToken(req); token.has_value()) {
-        auto player = app_.FindPlayer(*token);
-        if (player == nullptr) {
-            return MakeTextResponse(req, http::status::unauthorized, ErrorResponse::UNKNOWN_TOKEN, CacheControl::NO_CACHE);
-        }
-        return action(player);
-    } else {
-        return MakeTextResponse(req, http::status::unauthorized, ErrorResponse::INVALID_TOKEN, CacheControl::NO_CACHE);
-    }
+    return app::TokenFromHex(authorization.substr(BEARER.size()));
 }
 
 /**
@@ -148,15 +136,11 @@ StringResponse ApiHandler::RequestToJoin(const StringRequest& req){
     using namespace model;
     using namespace std::literals;
 
-    std::string user_name;
-    std::string map_id;
-    try {
-        auto obj = boost::json::parse(req.body()).as_object();
-        user_name = obj.at(UserKey::USER_NAME).as_string();
-        map_id = obj.at(UserKey::MAP_ID).as_string();
-    } catch (const std:: exception&) {
+    auto join = ParseJoin(req.body());
+    if (!join) {
         return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_PARSE_JOIN, CacheControl::NO_CACHE);
     }
+    auto& [user_name, map_id] = *join;
 
     if (user_name.empty()) {
         return MakeTextResponse(req, http::status::bad_request, ErrorResponse::USERNAME_EMPTY, CacheControl::NO_CACHE);
@@ -167,78 +151,290 @@ StringResponse ApiHandler::RequestToJoin(const StringRequest& req){
     }
 
     auto [token, player] = app_.JoinGame(Map::Id(map_id), user_name);
-    json::value value = {{UserKey::USER_TOKEN, *token},
+    json::value value = {{UserKey::USER_TOKEN, app::TokenToHex(token)},
                          {UserKey::PLAYER_ID,  *player.GetDog()->GetId()}};
     return MakeTextResponse(req, http::status::ok, boost::json::serialize(value), CacheControl::NO_CACHE);
 }
 
 /**
- * Ответ на запрос к картам
+ * Ответ на запрос списка карт
  * @param req Запрос StringRequest {http::request<http::string_body>}
- * @param decoded_target декодированный URI
  * @return Возвращает ответ StringResponse{http::response<http::string_body>}
  */
-StringResponse ApiHandler::RequestToMaps(const StringRequest& req, std::string& decoded_target) {
-    if (decoded_target == EndPoint::MAPS) {
-        return MakeTextResponse(req, http::status::ok, json::serialize(json::value_from(app_.GetMaps())), CacheControl::NO_CACHE);
-    }
-    if (decoded_target.starts_with(EndPoint::MAP_PREFIX)) {
-        std::string id = std::string{decoded_target.substr(EndPoint::MAP_PREFIX.size())};
-        auto map = app_.FindMap(model::Map::Id(id));
-        if (map) {
-            return MakeTextResponse(req, http::status::ok, json::serialize(json::value_from(*map)), CacheControl::NO_CACHE);
-        } else {
-            return MakeTextResponse(req, http::status::not_found, ErrorResponse::MAP_NOT_FOUND, CacheControl::NO_CACHE);
-        }
-    }
-    return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_REQ(), CacheControl::NO_CACHE);
+StringResponse ApiHandler::RequestToMaps(const StringRequest& req) {
+    return MakeTextResponse(req, http::status::ok, model::SerializeJson(app_.GetMaps()), CacheControl::NO_CACHE);
 }
 
 /**
- * Ответ на запрос о получении состояния игры
+ * Ответ на запрос карты
  * @param req Запрос StringRequest {http::request<http::string_body>}
+ * @param id id карты из пути запроса
  * @return Возвращает ответ StringResponse{http::response<http::string_body>}
  */
-StringResponse ApiHandler::RequestToState(const StringRequest& req) {
-    using namespace model;
-    return ExecuteAuthorized(req, [&req](const std::shared_ptr<app::Player>& player) {
-        json::object obj;
-        if(player) {
-            auto session = player->GetSession();
-            auto dogs = session->GetDogs();
-            json::object json_dogs, json_loots;
-            for (const auto &[id, dog]: dogs) {
-                json_dogs[std::to_string(*id)] = json::value_from(*dog);
-            }
-            obj[UserKey::PLAYERS] = json_dogs;
+StringResponse ApiHandler::RequestToMap(const StringRequest& req, std::string_view id) {
+    if (auto map = app_.FindMap(model::Map::Id(std::string{id}))) {
+        return MakeTextResponse(req, http::status::ok, model::SerializeJson(*map), CacheControl::NO_CACHE);
+    }
+    return MakeTextResponse(req, http::status::not_found, ErrorResponse::MAP_NOT_FOUND, CacheControl::NO_CACHE);
+}
 
-            auto& loots = session->GetLoots();
-            for (const auto &[id, loot]: loots) {
-                json_loots[std::to_string(*id)] = json::value_from(loot);
-            }
-            obj[LootKey::LOST] = json_loots;
+/**
+ * Ответ на запрос о получении состояния игры. С параметром Params::SINCE возвращает только изменения
+ * после переданной версии. Изменения зависят от версии клиента, поэтому общий снимок для них не строится.
+ * Полное состояние отправляется в MessagePack, если клиент его принимает
+ * @param req Запрос StringRequest {http::request<http::string_body>}
+ * @param query строка запроса
+ * @return ответ со снимком сессии игрока или с изменениями состояния
+ */
+VariantResponse ApiHandler::RequestToState(const StringRequest& req, std::string_view query) {
+    const auto state_query = ParseStateQuery(query);
+    if (!state_query) {
+        return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_STATE_CURSOR, CacheControl::NO_CACHE);
+    }
+    const auto since = state_query->since;
+    return ExecuteAuthorized(req, [this, &req, since](const std::shared_ptr<app::Player>& player) -> VariantResponse {
+        if (since) {
+            std::string body;
+            WriteGameStateDelta(*player->GetSession(), *since, body);
+            return MakeTextResponse(req, http::status::ok, std::move(body), CacheControl::NO_CACHE);
+        }
+        // Формат полного состояния выбирается по Accept, поэтому кэши должны различать ответы по нему
+        if (AcceptsMsgpack(req)) {
+            auto snapshot = snapshots_.GetStateMsgpack(*player->GetSession());
+            const std::string_view body = snapshot->body;
+            auto response = MakeSharedTextResponse(req, http::status::ok, std::move(snapshot), body, CacheControl::NO_CACHE,
+                                                   ContentType::APPLICATION_MSGPACK);
+            response.set(http::field::vary, "Accept"sv);
+            return response;
         }
-        return MakeTextResponse(req, http::status::ok, json::serialize(obj), CacheControl::NO_CACHE);
+        auto snapshot = snapshots_.GetState(*player->GetSession());
+        const std::string_view body = snapshot->body;
+        auto response = MakeSharedTextResponse(req, http::status::ok, std::move(snapshot), body, CacheControl::NO_CACHE);
+        response.set(http::field::vary, "Accept"sv);
+        return response;
     });
 }
 
-StringResponse ApiHandler::RequestToAction(const StringRequest& req) {
+bool ApiHandler::AcceptsMsgpack(const StringRequest& req) {
+    const auto it = req.find(http::field::accept);
+    if (it == req.end()) {
+        return false;
+    }
+    // JSON остаётся форматом по умолчанию: */* и application/* его не меняют
+    const auto msgpack = GetMediaTypeQuality(it->value(), ContentType::APPLICATION_MSGPACK);
+    return msgpack.exact && msgpack.quality > 0.0
+           && msgpack.quality >= GetMediaTypeQuality(it->value(), ContentType::APPLICATION_JSON).quality;
+}
+
+/**
+ * Формирует состояние игровой сессии: собак и потерянные предметы
+ * @param session игровая сессия
+ * @param sp ресурс памяти для элементов документа
+ * @return JSON-объект состояния
+ */
+json::object ApiHandler::MakeGameState(const model::GameSession& session, json::storage_ptr sp) {
     using namespace model;
-    return ExecuteAuthorized(req, [&req](std::shared_ptr<app::Player>& player) {
-        json::object obj;
-        if(player){
-            auto map = player->GetSession()->GetMap();
-            try{
-                json::object json_body = json::parse(req.body()).as_object();
-                player->DogMove(json_body.at(UserKey::MOVE).as_string(), map->GetDogSpeed());
-            } catch (const std:: exception&) {
-                return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_PARSE_ACTION, CacheControl::NO_CACHE );
+    json::object obj(sp);
+    json::object json_dogs(sp), json_loots(sp);
+    for (const auto &[id, dog]: session.GetDogs()) {
+        json_dogs[std::to_string(*id)] = json::value_from(*dog, sp);
+    }
+    obj[UserKey::PLAYERS] = std::move(json_dogs);
+
+    for (const auto &[id, loot]: session.GetLoots()) {
+        json_loots[std::to_string(*id)] = json::value_from(loot, sp);
+    }
+    obj[LootKey::LOST] = std::move(json_loots);
+    return obj;
+}
+
+/**
+ * Записывает состояние игровой сессии без построения документа
+ * @param session игровая сессия
+ * @param out строка, в конец которой дописывается JSON
+ */
+void ApiHandler::WriteGameState(const model::GameSession& session, std::string& out) {
+    detail::JsonWriter writer(out);
+    writer.StartObject();
+    writer.Key(UserKey::PLAYERS);
+    writer.StartObject();
+    for (const auto& [id, dog] : session.GetDogs()) {
+        writer.Key(IdKey{*id});
+        WriteJson(writer, *dog);
+    }
+    writer.EndObject();
+    writer.Key(LootKey::LOST);
+    writer.StartObject();
+    for (const auto& [id, loot] : session.GetLoots()) {
+        writer.Key(IdKey{*id});
+        WriteJson(writer, loot);
+    }
+    writer.EndObject();
+    writer.EndObject();
+}
+
+/**
+ * Записывает изменения состояния игровой сессии после версии since
+ * @param session игровая сессия
+ * @param since версия состояния, известная клиенту
+ * @param out строка, в конец которой дописывается JSON
+ */
+void ApiHandler::WriteGameStateDelta(const model::GameSession& session, std::uint64_t since, std::string& out) {
+    const auto changes = session.GetChangesSince(since);
+    detail::JsonWriter writer(out);
+    writer.StartObject();
+    writer.Key(UserKey::VERSION);
+    writer.Uint(session.GetVersion());
+    writer.Key(UserKey::FULL_STATE);
+    writer.Bool(!changes);
+
+    const auto& dogs = session.GetDogs();
+    writer.Key(UserKey::PLAYERS);
+    writer.StartObject();
+    if (changes) {
+        for (const auto& id : changes->dogs) {
+            if (const auto it = dogs.find(id); it != dogs.end() && it->second) {
+                writer.Key(IdKey{*id});
+                WriteJson(writer, *it->second);
             }
         }
-        return MakeTextResponse(req, http::status::ok, json::serialize(obj), CacheControl::NO_CACHE);
+    } else {
+        for (const auto& [id, dog] : dogs) {
+            writer.Key(IdKey{*id});
+            WriteJson(writer, *dog);
+        }
+    }
+    writer.EndObject();
+
+    const auto& loots = session.GetLoots();
+    writer.Key(LootKey::LOST);
+    writer.StartObject();
+    if (changes) {
+        for (const auto& id : changes->loots) {
+            if (const auto it = loots.find(id); it != loots.end()) {
+                writer.Key(IdKey{*id});
+                WriteJson(writer, it->second);
+            }
+        }
+    } else {
+        for (const auto& [id, loot] : loots) {
+            writer.Key(IdKey{*id});
+            WriteJson(writer, loot);
+        }
+    }
+    writer.EndObject();
+
+    if (changes) {
+        writer.Key(UserKey::REMOVED_PLAYERS);
+        writer.StartArray();
+        for (const auto& id : changes->removed_dogs) {
+            writer.String(IdKey{*id});
+        }
+        writer.EndArray();
+        writer.Key(LootKey::REMOVED_LOST);
+        writer.StartArray();
+        for (const auto& id : changes->removed_loots) {
+            writer.String(IdKey{*id});
+        }
+        writer.EndArray();
+    }
+    writer.EndObject();
+}
+
+std::optional<ApiHandler::StateQuery> ApiHandler::ParseStateQuery(std::string_view query) {
+    StateQuery result;
+    if (query.empty()) {
+        return result;
+    }
+    // Конструктор params_view бросает исключение на некорректной строке запроса, а разбор выполняется в потоке сессии
+    const auto parsed = boost::urls::parse_query(query);
+    if (!parsed) {
+        return std::nullopt;
+    }
+    const boost::urls::params_view params = *parsed;
+    if (const auto it = params.find(Params::SINCE); it != params.end()) {
+        const std::string value = (*it).value;
+        std::uint64_t version = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), version);
+        if (ec != std::errc{} || end != value.data() + value.size()) {
+            return std::nullopt;
+        }
+        result.since = version;
+    }
+    return result;
+}
+
+VariantResponse ApiHandler::RequestToAction(const StringRequest& req) {
+    return ExecuteAuthorized(req, [this, &req](const std::shared_ptr<app::Player>& player) {
+        return AcceptMove(req, player, app_.GetActionInbox());
     });
 }
 
+std::optional<ApiHandler::JoinRequest> ApiHandler::ParseJoin(std::string_view body) {
+    JsonObjectReader reader(body);
+    std::optional<std::string> user_name;
+    std::optional<std::string> map_id;
+    auto read_string = [&reader](std::optional<std::string>& field) {
+        if (reader.GetKind() == JsonObjectReader::Kind::STRING) {
+            field = reader.GetString();
+        } else {
+            field.reset();
+        }
+    };
+    while (reader.Next()) {
+        if (reader.KeyIs(UserKey::USER_NAME)) {
+            read_string(user_name);
+        } else if (reader.KeyIs(UserKey::MAP_ID)) {
+            read_string(map_id);
+        }
+    }
+    if (!reader.IsValid() || !user_name || !map_id) {
+        return std::nullopt;
+    }
+    return JoinRequest{std::move(*user_name), std::move(*map_id)};
+}
+
+std::optional<std::int64_t> ApiHandler::ParseTimeDelta(std::string_view body) {
+    JsonObjectReader reader(body);
+    std::optional<std::int64_t> time_delta;
+    while (reader.Next()) {
+        if (reader.KeyIs(UserKey::TIME_INTERVAL)) {
+            time_delta = reader.GetKind() == JsonObjectReader::Kind::INT64 ? std::optional{reader.GetInt64()} : std::nullopt;
+        }
+    }
+    return reader.IsValid() ? time_delta : std::nullopt;
+}
+
+std::optional<std::string_view> ApiHandler::ParseMove(std::string_view body) {
+    JsonObjectReader reader(body);
+    std::optional<std::string_view> direction;
+    while (reader.Next()) {
+        if (reader.KeyIs(UserKey::MOVE)) {
+            direction = reader.GetKind() == JsonObjectReader::Kind::STRING
+                    ? app::ActionInbox::ParseDirection(reader.GetString())
+                    : std::nullopt;
+        }
+    }
+    return reader.IsValid() ? direction : std::nullopt;
+}
+
+/**
+ * Ставит команду движения в очередь. Собака поворачивает в начале следующего тика
+ * @param req запрос
+ * @param player игрок
+ * @param inbox очередь команд
+ * @return ответ StringResponse{http::response<http::string_body>}
+ */
+StringResponse ApiHandler::AcceptMove(const StringRequest& req, const std::shared_ptr<app::Player>& player,
+                                      app::ActionInbox& inbox) {
+    const auto direction = ParseMove(req.body());
+    if (!direction) {
+        return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_PARSE_ACTION, CacheControl::NO_CACHE);
+    }
+    inbox.Push(player, *direction);
+    return MakeTextResponse(req, http::status::ok, "{}"sv, CacheControl::NO_CACHE);
+}
+
 /**
  * Ответ на запрос об обновлении игры
  * @param req Запрос StringRequest {http::request<http::string_body>}
@@ -249,13 +445,11 @@ StringResponse ApiHandler::RequestToTick(const StringRequest& req){
     using namespace std::string_literals;
 
         json::object obj;
-    std::chrono::milliseconds milliseconds;
-    try{
-        json::object json_body = json::parse(req.body()).as_object();
-        milliseconds = std::chrono::milliseconds(json_body.at(UserKey::TIME_INTERVAL).as_int64());
-    } catch (const std:: exception&) {
+    const auto time_delta = ParseTimeDelta(req.body());
+    if (!time_delta) {
         return MakeTextResponse(req, http::status::bad_request, ErrorResponse::BAD_PARSE_TICK, CacheControl::NO_CACHE );
     }
+    const std::chrono::milliseconds milliseconds{*time_delta};
 
     try {
         app_.Tick(milliseconds);
@@ -269,15 +463,16 @@ StringResponse ApiHandler::RequestToTick(const StringRequest& req){
 /**
  * Ответ на запрос получения рекордсмнов
  * @param req запрос
- * @param decoded_target декодированный URI
+ * @param query строка запроса
+ * @param use_cases сценарии работы с базой данных
  * @return Возвращает ответ StringResponse{http::response<http::string_body>}
  */
-StringResponse ApiHandler::RequestToRecords(const StringRequest& req, std::string& decoded_target) {
+StringResponse ApiHandler::RequestToRecords(const StringRequest& req, std::string_view query, app::UseCases& use_cases) {
     using namespace model;
     using namespace std::string_literals;
     std::int32_t start = 0, max_items = Restrictions::RECORD_MAX_ITEMS;
     try {
-        auto params = GetUriRecordsParams(decoded_target);
+        auto params = GetUriRecordsParams(query);
         start = params.first;
         max_items = params.second;
     } catch (const std::exception& e) {
@@ -291,7 +486,7 @@ StringResponse ApiHandler::RequestToRecords(const StringRequest& req, std::strin
     }
     data_base::domain::RetiredPlayers retired_players;
     try {
-        retired_players = use_cases_.GetRetiredPlayers(start, max_items);
+        retired_players = use_cases.GetRetiredPlayers(start, max_items);
     } catch (std::exception& ex){
         return MakeTextResponse(req, http::status::internal_server_error,
                                 ErrorResponse::SERVER_ERROR("The error of getting the record holders"s),
@@ -301,15 +496,15 @@ StringResponse ApiHandler::RequestToRecords(const StringRequest& req, std::strin
 }
 
 /**
- * Парсит URI, получает параметры Params::START и Params::MAX_ITEMS
- * @param decoded_target декодированный URI
+ * Парсит строку запроса, получает параметры Params::START и Params::MAX_ITEMS
+ * @param query строка запроса
  * @return параметры start, max_items
  */
-std::pair<std::int32_t, std::int32_t> ApiHandler::GetUriRecordsParams(std::string& decoded_target){
+std::pair<std::int32_t, std::int32_t> ApiHandler::GetUriRecordsParams(std::string_view query){
     std::int32_t start = 0;
     std::int32_t max_items = Restrictions::RECORD_MAX_ITEMS;
 
-    auto params = boost::urls::url_view(decoded_target).params();
+    const boost::urls::params_view params(query);
     if (auto it = params.find(Params::START); it != params.end()) {
         start = std::stoi((*it).value);
     }
@@ -4,12 +4,17 @@
 #include <boost/url.hpp>
 #include <string_view>
 #include <chrono>
+#include <type_traits>
 
+#include "api_router.h"
 #include "content_type.h"
 #include "error_response.h"
 #include "endpoint.h"
 #include "make_response.h"
+#include "session_snapshot.h"
 #include "../http_server/http_server.h"
+#include "../json/json_model_writer.h"
+#include "../json/json_object_reader.h"
 #include "../json/tag_invoke_model.h"
 #include "../json/tag_invoke_db.h"
 #include "../util/util.h"
@@ -42,6 +47,7 @@ struct Params {
     Params() = delete;
     static const inline std::string_view START = "start";
     static const inline std::string_view MAX_ITEMS = "maxItems";
+    static const inline std::string_view SINCE = "since";
 };
 
 struct Restrictions {
@@ -49,35 +55,160 @@ struct Restrictions {
     static const inline std::int32_t RECORD_MAX_ITEMS = 100;
 };
 
+/**
+ * Обработчик запросов к API. Один экземпляр обслуживает все запросы и используется только в api_strand,
+ * кроме запроса рекордов, который выполняется в пуле блокирующих задач
+ */
 class ApiHandler {
 public:
-    explicit ApiHandler(app::Application& app, data_base::postgres::Database& db): app_(app), db_(db) {}
+    ApiHandler(app::Application& app, app::UnitOfWorkFactory& unit_factory): app_(app), use_cases_(unit_factory) {}
+
+    // Размер буфера на стеке, в котором собираются JSON-документы ответа и разбирается тело запроса.
+    // Документы больше буфера дополнительно выделяют память в куче
+    constexpr static std::size_t JSON_BUFFER_SIZE = 4096;
 
     ApiHandler(const ApiHandler&) = delete;
     ApiHandler& operator=(const ApiHandler&) = delete;
 
     static bool IsAPIRequest(const StringRequest& req);
 
-    StringResponse HandleApiRequest(const StringRequest& req);
+    VariantResponse HandleApiRequest(const StringRequest& req);
 
-private:
-    StringResponse RequestForListPlayers(const StringRequest& req);
     static std::optional<app::Token> TryExtractToken(const StringRequest& req);
-    StringResponse ExecuteAuthorized(const StringRequest& req,
-                                     const std::function<StringResponse(std::shared_ptr<app::Player>& player)>& action);
+    static json::object MakeGameState(const model::GameSession& session, json::storage_ptr sp = {});
+    static json::object MakePlayerList(const model::GameSession& session, json::storage_ptr sp = {});
+
+    /**
+     * Записывает тело ответа /api/v1/game/state потоковым JSON-писателем. MakeGameState строит тот же документ
+     * в виде boost::json::object
+     * @param session игровая сессия
+     * @param out строка, в конец которой дописывается JSON
+     */
+    static void WriteGameState(const model::GameSession& session, std::string& out);
+
+    /**
+     * Записывает изменения состояния сессии после версии since: добавленных или изменённых собак и предметы,
+     * а также id удалённых. Если версии since нет в истории изменений, записывает полное состояние с "full": true
+     * @param session игровая сессия
+     * @param since версия состояния, известная клиенту
+     * @param out строка, в конец которой дописывается JSON с текущей версией состояния
+     */
+    static void WriteGameStateDelta(const model::GameSession& session, std::uint64_t since, std::string& out);
+
+    /**
+     * Параметры запроса состояния
+     */
+    struct StateQuery {
+        // Версия состояния, известная клиенту (параметр Params::SINCE)
+        std::optional<std::uint64_t> since;
+    };
+
+    /**
+     * Разбирает строку запроса состояния
+     * @param query строка запроса
+     * @return параметры или nullopt, если строка запроса некорректна или версия не целое число из uint64
+     */
+    static std::optional<StateQuery> ParseStateQuery(std::string_view query);
+
+    /**
+     * Проверяет, что клиент предпочитает состояние игры в формате MessagePack: ContentType::APPLICATION_MSGPACK
+     * указан в Accept явно, с ненулевым весом q и не ниже веса JSON
+     * @param req запрос
+     */
+    static bool AcceptsMsgpack(const StringRequest& req);
+
+    /**
+     * Поля запроса входа в игру
+     */
+    struct JoinRequest {
+        std::string user_name;
+        std::string map_id;
+
+        [[nodiscard]] bool operator==(const JoinRequest&) const = default;
+    };
+
+    /**
+     * Разбирает тело запроса входа в игру {"userName": "Шарик", "mapId": "map1"}
+     * @param body тело запроса
+     * @return поля запроса или nullopt, если тело не JSON-объект или поля отсутствуют либо не строки
+     */
+    static std::optional<JoinRequest> ParseJoin(std::string_view body);
+
+    /**
+     * Разбирает тело запроса обновления игры {"timeDelta": 100}
+     * @param body тело запроса
+     * @return интервал в миллисекундах или nullopt, если поле отсутствует или не целое число из int64
+     */
+    static std::optional<std::int64_t> ParseTimeDelta(std::string_view body);
+
+    /**
+     * Разбирает тело команды движения {"move": "L}
+     * @param body тело запроса
+     * @return направление в виде константы model::Movement или nullopt, если команда некорректна
+     */
+    static std::optional<std::string_view> ParseMove(std::string_view body);
+
+    /**
+     * Принимает команду движения авторизованного игрока в очередь команд. Можно вызывать из любого потока
+     * @param req запрос
+     * @param player игрок
+     * @param inbox очередь команд
+     * @return 200 или 400, если команда некорректна
+     */
+    static StringResponse AcceptMove(const StringRequest& req, const std::shared_ptr<app::Player>& player,
+                                     app::ActionInbox& inbox);
+
+    /**
+     * Отвечает на запрос рекордов. Не обращается к состоянию игры и к полям ApiHandler, поэтому,
+     * в отличие от остальных запросов, может выполняться в любом потоке со своим объектом use_cases
+     * @param req запрос
+     * @param query строка запроса
+     * @param use_cases сценарии работы с базой данных, не используемые одновременно в других потоках
+     * @return ответ со списком рекордов
+     */
+    static StringResponse RequestToRecords(const StringRequest& req, std::string_view query, app::UseCases& use_cases);
+
+private:
+    VariantResponse RequestForListPlayers(const StringRequest& req);
+    template <typename Action>
+    VariantResponse ExecuteAuthorized(const StringRequest& req, Action&& action);
     StringResponse RequestToJoin(const StringRequest& req);
-    StringResponse RequestToMaps(const StringRequest& req, std::string & decoded_target);
-    StringResponse RequestToState(const StringRequest& req);
-    StringResponse RequestToAction(const StringRequest& req);
+    StringResponse RequestToMaps(const StringRequest& req);
+    StringResponse RequestToMap(const StringRequest& req, std::string_view id);
+    VariantResponse RequestToState(const StringRequest& req, std::string_view query);
+    VariantResponse RequestToAction(const StringRequest& req);
     StringResponse RequestToTick(const StringRequest& req);
-    StringResponse RequestToRecords(const StringRequest& req, std::string& decoded_target);
 private:
-    static std::pair<std::int32_t, std::int32_t> GetUriRecordsParams(std::string& decoded_target);
+    static std::pair<std::int32_t, std::int32_t> GetUriRecordsParams(std::string_view query);
 
 private:
     app::Application& app_;
-    data_base::postgres::Database& db_;
-    app::UseCasesImpl use_cases_{db_.GetUnitOfWorkFactory()};
+    app::UseCasesImpl use_cases_;
+    // Сериализованные состояния сессий, общие для всех запросов одной версии сессии
+    SessionSnapshots snapshots_;
     bool is_first_tick = false;
 };
+
+/**
+ * Проверяет по токену, что пользователю разрешено выполнить некоторое действие
+ * @param req Запрос StringRequest {http::request<http::string_body>}
+ * @param action действие, принимающее std::shared_ptr<app::Player>& и, если нужно, токен игрока
+ * @return ответ с ошибкой авторизации или ответ action
+ */
+template <typename Action>
+VariantResponse ApiHandler::ExecuteAuthorized(const StringRequest& req, Action&& action) {
+    const auto token = TryExtractToken(req);
+    if (!token) {
+        return MakeTextResponse(req, http::status::unauthorized, ErrorResponse::INVALID_TOKEN, CacheControl::NO_CACHE);
+    }
+    auto player = app_.FindPlayer(*token);
+    if (player == nullptr) {
+        return MakeTextResponse(req, http::status::unauthorized, ErrorResponse::UNKNOWN_TOKEN, CacheControl::NO_CACHE);
+    }
+    if constexpr (std::is_invocable_v<Action, const std::shared_ptr<app::Player>&, const app::Token&>) {
+        return action(player, *token);
+    } else {
+        return action(player);
+    }
+}
 }  // namespace http_handler
\ No newline at end of file
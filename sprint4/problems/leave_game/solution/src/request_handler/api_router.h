@@ -0,0 +1,207 @@
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "endpoint.h"
+#include "../util/util.h"
+
+namespace http_handler {
+
+/**
+ * Маршруты API
+ */
+enum class ApiRoute : std::uint8_t {
+    MAPS,
+    MAP,
+    PLAYERS,
+    JOIN,
+    STATE,
+    ACTION,
+    TICK,
+    RECORDS
+};
+
+/**
+ * Наборы методов, разрешённых маршрутам API
+ */
+enum class ApiMethods : std::uint8_t {
+    GET_HEAD,
+    POST
+};
+
+/**
+ * Описание маршрута API
+ */
+struct ApiRouteSpec {
+    std::string_view path;  // Путь маршрута с параметром заканчивается на '/'
+    ApiRoute route;
+    ApiMethods methods;
+    bool has_param = false;  // Последний сегмент пути - параметр (id карты)
+};
+
+/**
+ * Маршрут, сопоставленный запросу
+ */
+struct ApiRouteMatch {
+    const ApiRouteSpec* spec = nullptr;
+    std::string_view param;  // Параметр пути
+    std::string_view query;  // Строка запроса без '?'
+};
+
+inline constexpr std::array API_ROUTES{
+    ApiRouteSpec{EndPoint::MAPS,       ApiRoute::MAPS,    ApiMethods::GET_HEAD},
+    ApiRouteSpec{EndPoint::MAP_PREFIX, ApiRoute::MAP,     ApiMethods::GET_HEAD, true},
+    ApiRouteSpec{EndPoint::PLAYERS,    ApiRoute::PLAYERS, ApiMethods::GET_HEAD},
+    ApiRouteSpec{EndPoint::JOIN,       ApiRoute::JOIN,    ApiMethods::POST},
+    ApiRouteSpec{EndPoint::STATE,      ApiRoute::STATE,   ApiMethods::GET_HEAD},
+    ApiRouteSpec{EndPoint::ACTION,     ApiRoute::ACTION,  ApiMethods::POST},
+    ApiRouteSpec{EndPoint::TICK,       ApiRoute::TICK,    ApiMethods::POST},
+    ApiRouteSpec{EndPoint::RECORDS,    ApiRoute::RECORDS, ApiMethods::GET_HEAD},
+};
+
+namespace route_table {
+
+// Размер таблицы - степень двойки, номер ячейки берётся маской
+constexpr std::size_t SIZE = 16;
+static_assert(API_ROUTES.size() <= SIZE);
+
+/**
+ * Хеш пути по его длине и двум последним символам: этого достаточно, чтобы различить пути маршрутов,
+ * и время вычисления не зависит от длины пути. Совпадение пути проверяется сравнением
+ * @param path путь
+ * @param seed затравка
+ * @return номер ячейки таблицы
+ */
+constexpr std::size_t Slot(std::string_view path, std::uint32_t seed) noexcept {
+    if (path.size() < 2) {
+        return 0;
+    }
+    std::uint32_t hash = seed;
+    for (const std::uint32_t part : {static_cast<std::uint32_t>(path.size()),
+                                     static_cast<std::uint32_t>(static_cast<unsigned char>(path.back())),
+                                     static_cast<std::uint32_t>(static_cast<unsigned char>(path[path.size() - 2]))}) {
+        hash = (hash ^ part) * 16777619u;
+    }
+    return (hash ^ (hash >> 16)) & (SIZE - 1);
+}
+
+/**
+ * Подбирает затравку, при которой пути всех маршрутов попадают в разные ячейки (совершенный хеш)
+ * @return затравка. Если её нет, программа не компилируется
+ */
+consteval std::uint32_t FindSeed() {
+    for (std::uint32_t seed = 0; seed < 1'000'000; ++seed) {
+        std::array<bool, SIZE> used{};
+        bool collision = false;
+        for (const auto& spec : API_ROUTES) {
+            auto& slot = used[Slot(spec.path, seed)];
+            collision = collision || slot;
+            slot = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    throw "perfect hash seed for API routes not found";
+}
+
+constexpr std::uint32_t SEED = FindSeed();
+
+/**
+ * Строит таблицу: ячейка содержит индекс маршрута в API_ROUTES или -1
+ */
+consteval std::array<std::int8_t, SIZE> Build() {
+    std::array<std::int8_t, SIZE> table{};
+    table.fill(-1);
+    for (std::size_t i = 0; i < API_ROUTES.size(); ++i) {
+        table[Slot(API_ROUTES[i].path, SEED)] = static_cast<std::int8_t>(i);
+    }
+    return table;
+}
+
+constexpr std::array<std::int8_t, SIZE> TABLE = Build();
+
+}  // namespace route_table
+
+/**
+ * Маршрутизатор API: таблица маршрутов с совершенным хешем, построенная при компиляции.
+ * Сопоставление не выделяет память, если путь не требует декодирования
+ */
+class ApiRouter {
+public:
+    ApiRouter() = delete;
+
+    /**
+     * Находит маршрут по точному совпадению пути
+     * @param path путь без строки запроса
+     * @return маршрут или nullptr
+     */
+    static constexpr const ApiRouteSpec* Find(std::string_view path) noexcept {
+        const auto index = route_table::TABLE[route_table::Slot(path, route_table::SEED)];
+        if (index < 0 || API_ROUTES[index].path != path) {
+            return nullptr;
+        }
+        return &API_ROUTES[index];
+    }
+
+    /**
+     * Сопоставляет request-target маршруту
+     * @param target request-target запроса
+     * @param decoded буфер для декодированного пути. Заполняется, только если путь содержит '%' или '+'
+     * @return маршрут с параметром пути и строкой запроса (ссылаются на target или decoded) или nullopt
+     */
+    static std::optional<ApiRouteMatch> Match(std::string_view target, std::string& decoded) {
+        std::string_view path = target;
+        std::string_view query;
+        if (const auto pos = target.find('?'); pos != std::string_view::npos) {
+            path = target.substr(0, pos);
+            query = target.substr(pos + 1);
+        }
+        if (path.find('%') != std::string_view::npos || path.find('+') != std::string_view::npos) {
+            decoded = util::UrlDecode(std::string{path});
+            path = decoded;
+        }
+
+        if (const auto* spec = Find(path); spec && !spec->has_param) {
+            return ApiRouteMatch{spec, {}, query};
+        }
+        // Маршрут с параметром ищется по пути до последнего '/' включительно. Пустой параметр тоже передаётся
+        // обработчику маршрута, чтобы он ответил так же, как на неизвестный идентификатор
+        if (const auto slash = path.rfind('/'); slash != std::string_view::npos) {
+            if (const auto* spec = Find(path.substr(0, slash + 1)); spec && spec->has_param) {
+                return ApiRouteMatch{spec, path.substr(slash + 1), query};
+            }
+        }
+        // Параметр, содержащий '/', не может быть идентификатором, но тоже отдаётся обработчику маршрута
+        for (const auto& spec : API_ROUTES) {
+            if (spec.has_param && path.starts_with(spec.path)) {
+                return ApiRouteMatch{&spec, path.substr(spec.path.size()), query};
+            }
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Проверяет, что метод разрешён маршруту
+     * @param methods разрешённые методы маршрута
+     * @param method метод запроса
+     */
+    static constexpr bool IsAllowed(ApiMethods methods, boost::beast::http::verb method) noexcept {
+        using boost::beast::http::verb;
+        switch (methods) {
+            case ApiMethods::GET_HEAD:
+                return method == verb::get || method == verb::head;
+            case ApiMethods::POST:
+                return method == verb::post;
+        }
+        return false;
+    }
+};
+
+}  // namespace http_handler
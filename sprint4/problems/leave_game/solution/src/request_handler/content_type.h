@@ -47,6 +47,8 @@ struct ContentType {
     constexpr static std::string_view TEXT_JS = "text/javascript"sv;            // .js
     constexpr static std::string_view APPLICATION_JSON = "application/json"sv;  // .json
     constexpr static std::string_view APPLICATION_XML = "application/xml"sv;    // .xml
+    constexpr static std::string_view APPLICATION_MSGPACK = "application/x-msgpack"sv;
+    constexpr static std::string_view PROMETHEUS_TEXT = "text/plain; version=0.0.4; charset=utf-8"sv;
     constexpr static std::string_view IMAGE_PNG = "image/png"sv;                // .png
     constexpr static std::string_view IMAGE_JPEG = "image/jpeg"sv;              // .jpg, .jpe, .jpeg
     constexpr static std::string_view IMAGE_GIF = "image/gif"sv;                // .gif
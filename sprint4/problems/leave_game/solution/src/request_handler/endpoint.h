@@ -16,10 +16,13 @@ struct EndPoint {
     constexpr const static std::string_view JOIN       = "/api/v1/game/join"sv;
     constexpr const static std::string_view PLAYERS    = "/api/v1/game/players"sv;
     constexpr const static std::string_view STATE      = "/api/v1/game/state"sv;
+    constexpr const static std::string_view WEBSOCKET  = "/api/v1/game/ws"sv;
     constexpr const static std::string_view ACTION     = "/api/v1/game/player/action"sv;
     constexpr const static std::string_view TICK       = "/api/v1/game/tick"sv;
     constexpr const static std::string_view RECORDS    = "/api/v1/game/records"sv;
     constexpr const static std::string_view EMPTY      = "/"sv;
     constexpr const static std::string_view INDEX      = "/index.html"sv;
+    constexpr const static std::string_view METRICS    = "/metrics"sv;
+    constexpr const static std::string_view TRACES     = "/admin/traces"sv;
 };
 }  // namespace http_handler
\ No newline at end of file
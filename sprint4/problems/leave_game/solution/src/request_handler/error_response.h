@@ -15,11 +15,14 @@ struct ErrorResponse {
     constexpr static std::string_view BAD_PARSE_JOIN   = R"({"code": "invalidArgument", "message": "Join game request parse error"})"sv;
     constexpr static std::string_view BAD_PARSE_ACTION = R"({"code": "invalidArgument", "message": "Failed to parse action"})"sv;
     constexpr static std::string_view BAD_PARSE_TICK   = R"({"code": "invalidArgument", "message": "Failed to parse tick request JSON"})"sv;
+    constexpr static std::string_view BAD_STATE_CURSOR = R"({"code": "invalidArgument", "message": "Invalid state version"})"sv;
     constexpr static std::string_view USERNAME_EMPTY   = R"({"code": "invalidArgument", "message": "Invalid name"})"sv;
     constexpr static std::string_view INVALID_TOKEN    = R"({"code": "invalidToken", "message": "Authorization header is missing"})"sv;
     constexpr static std::string_view UNKNOWN_TOKEN    = R"({"code": "unknownToken", "message": "Player token has not been found"})"sv;
     constexpr static std::string_view INVALID_POST     = R"({"code": "invalidMethod", "message": "Only POST method is expected"})"sv;
     constexpr static std::string_view INVALID_GET      = R"({"code": "invalidMethod", "message": "Invalid method"})"sv;
+    constexpr static std::string_view SERVICE_UNAVAILABLE = R"({"code": "serviceUnavailable", "message": "Server is overloaded, retry later"})"sv;
+    constexpr static std::string_view TOO_MANY_REQUESTS = R"({"code": "tooManyRequests", "message": "Request rate limit exceeded, retry later"})"sv;
     constexpr static auto BAD_REQ = [](const std::string& message = "Bad request"s){
         return R"({"code": "badRequest", "message": ")"s + message  +"\"}"s;
     };
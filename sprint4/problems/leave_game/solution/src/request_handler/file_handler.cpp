@@ -1,17 +1,132 @@
 #include "file_handler.h"
 
+#include "http_range.h"
+
 namespace http_handler {
+namespace {
+
+constexpr std::string_view ACCEPT_RANGES_BYTES = "bytes";
+// Части ответа multipart/byteranges собираются в памяти. Если запрошенные участки длиннее,
+// Range игнорируется и содержимое отдаётся целиком, без копирования (sendfile или разделяемый буфер)
+constexpr std::uint64_t MAX_MULTIPART_BODY = 1024 * 1024;
+
+/**
+ * Проверяет условные заголовки If-None-Match и If-Modified-Since.
+ * If-Modified-Since учитывается, только если нет If-None-Match
+ * @param req запрос
+ * @param etag ETag ответа или пустая строка, если его нет
+ * @param last_modified время изменения файла
+ * @return true, если у клиента актуальная версия
+ */
+bool IsNotModified(const StringRequest& req, std::string_view etag, std::time_t last_modified) {
+    if (const auto if_none_match = req[http::field::if_none_match]; !if_none_match.empty()) {
+        return IfNoneMatch(if_none_match, etag);
+    }
+    const auto if_modified_since = ParseHttpDate(req[http::field::if_modified_since]);
+    return if_modified_since && last_modified <= *if_modified_since;
+}
+
+/**
+ * Определяет участки, запрошенные заголовком Range
+ * @param req запрос
+ * @param size размер содержимого
+ * @param etag сильный ETag содержимого или пустая строка
+ * @param last_modified время изменения файла
+ * @return участки или nullopt, если нужно отдать всё содержимое (в том числе когда несколько участков
+ * вместе длиннее MAX_MULTIPART_BODY)
+ */
+std::optional<RangeSet> GetRequestedRanges(const StringRequest& req, std::uint64_t size,
+                                           std::string_view etag, std::time_t last_modified) {
+    const auto range = req[http::field::range];
+    if (range.empty() || req.method() != http::verb::get) {
+        return std::nullopt;
+    }
+    if (const auto if_range = req[http::field::if_range]; !if_range.empty() && !IfRangeMatches(if_range, etag, last_modified)) {
+        return std::nullopt;
+    }
+    auto ranges = ParseRange(range, size);
+    if (ranges && ranges->ranges.size() > 1) {
+        std::uint64_t total = 0;
+        for (const auto& part : ranges->ranges) {
+            total += part.length;
+        }
+        if (total > MAX_MULTIPART_BODY) {
+            return std::nullopt;
+        }
+    }
+    return ranges;
+}
+
+/**
+ * Устанавливает валидаторы ответа и Accept-Ranges
+ */
+template <typename Response>
+void SetValidators(Response& response, std::string_view etag, std::string_view last_modified) {
+    if (!etag.empty()) {
+        response.set(http::field::etag, etag);
+    }
+    response.set(http::field::last_modified, last_modified);
+    response.set(http::field::accept_ranges, ACCEPT_RANGES_BYTES);
+}
+
+StringResponse MakeNotModifiedResponse(const StringRequest& req, std::string_view etag, std::string_view last_modified) {
+    StringResponse response(http::status::not_modified, req.version());
+    SetValidators(response, etag, last_modified);
+    response.keep_alive(req.keep_alive());
+    return response;
+}
+
+StringResponse MakeRangeNotSatisfiableResponse(const StringRequest& req, std::uint64_t size) {
+    StringResponse response(http::status::range_not_satisfiable, req.version());
+    response.set(http::field::content_range, "bytes */" + std::to_string(size));
+    response.set(http::field::accept_ranges, ACCEPT_RANGES_BYTES);
+    response.content_length(0);
+    response.keep_alive(req.keep_alive());
+    return response;
+}
+
+/**
+ * Создаёт ответ 206 multipart/byteranges на запрос нескольких участков
+ * @param read функция, дописывающая участок содержимого в тело
+ * @return 206 или 500, если содержимое не удалось прочитать
+ */
+StringResponse MakeMultipartResponse(const StringRequest& req, const std::vector<ByteRange>& ranges, std::uint64_t size,
+                                     std::string_view content_type,
+                                     const std::function<bool(ByteRange, std::string&)>& read) {
+    const auto boundary = GetMultipartBoundary();
+    auto body = MakeMultipartByteranges(ranges, size, content_type, boundary, read);
+    if (body.empty()) {
+        return MakeStringResponse(http::status::internal_server_error, ErrorResponse::SERVER_ERROR("Failed to read file"),
+                                  req.version(), req.keep_alive(), ContentType::TEXT_PLAIN);
+    }
+    StringResponse response(http::status::partial_content, req.version());
+    response.set(http::field::content_type, "multipart/byteranges; boundary=" + std::string(boundary));
+    response.body() = std::move(body);
+    response.prepare_payload();
+    response.keep_alive(req.keep_alive());
+    return response;
+}
+
+}  // namespace
+
 VariantResponse FileHandler::HandleFileResponse(const StringRequest& req){
 
     const auto text_response = [&req](http::status status, std::string_view text, std::string_view content_type) {
         return MakeStringResponse(status, text, req.version(), req.keep_alive(), content_type);
     };
 
-    std::filesystem::path decoded_target = util::UrlDecode(std::string{req.target()});
+    std::string decoded_target = util::UrlDecode(std::string{req.target()});
     if (decoded_target == EndPoint::EMPTY){
         decoded_target = EndPoint::INDEX;
     }
 
+    // Файлы из индекса отдаются из памяти без обращений к файловой системе
+    if (assets_) {
+        if (auto asset = assets_->Find(decoded_target)) {
+            return MakeAssetResponse(req, std::move(asset));
+        }
+    }
+
     std::filesystem::path file_path = root_path_;
     file_path += decoded_target;
     if(!util::IsSubPath(file_path, root_path_)){
@@ -23,9 +138,10 @@ VariantResponse FileHandler::HandleFileResponse(const StringRequest& req){
         return text_response(http::status::not_found, ErrorResponse::FILE_NOT_FOUND, ContentType::TEXT_PLAIN);
     }
 
-    http::file_body::value_type file;
+    // Файл отправляется сессией без копирования через sendfile
+    FileBody::value_type file;
 
-    if (sys::error_code ec; file.open(file_path.c_str(), beast::file_mode::read, ec), ec) {
+    if (sys::error_code ec; file.Open(file_path.c_str(), ec), ec) {
         return text_response(http::status::internal_server_error,
                              ErrorResponse::SERVER_ERROR("Failed to open file: " + file_path.string()),
                              ContentType::TEXT_PLAIN);
@@ -37,6 +153,120 @@ VariantResponse FileHandler::HandleFileResponse(const StringRequest& req){
 
     std::string_view content_type = ContentType::EXTENSION.contains(extension) ? ContentType::EXTENSION.at(extension) : ContentType::UNKNOWN;
 
-    return MakeFileResponse(http::status::ok, file, req.version(), req.keep_alive(), content_type);
+    // Файлы с диска не имеют ETag, условные запросы проверяются по времени изменения
+    std::error_code time_ec;
+    const auto last_modified = ToTimeT(std::filesystem::last_write_time(file_path, time_ec));
+    const auto last_modified_date = FormatHttpDate(last_modified);
+    if (IsNotModified(req, {}, last_modified)) {
+        return MakeNotModifiedResponse(req, {}, last_modified_date);
+    }
+
+    const auto size = file.GetSize();
+    if (const auto ranges = GetRequestedRanges(req, size, {}, last_modified)) {
+        if (ranges->ranges.empty()) {
+            return MakeRangeNotSatisfiableResponse(req, size);
+        }
+        if (ranges->ranges.size() > 1) {
+            // Участки читаются из уже открытого файла, файл целиком в память не загружается
+            return MakeMultipartResponse(req, ranges->ranges, size, content_type, [&file](ByteRange range, std::string& out) {
+                sys::error_code ec;
+                file.GetFile().seek(range.offset, ec);
+                const auto begin = out.size();
+                out.resize(begin + range.length);
+                std::size_t done = 0;
+                while (!ec && done < range.length) {
+                    const auto n = file.GetFile().read(out.data() + begin + done, range.length - done, ec);
+                    if (n == 0) {
+                        break;
+                    }
+                    done += n;
+                }
+                return !ec && done == range.length;
+            });
+        }
+        // Один участок отправляется из того же дескриптора через sendfile
+        const auto range = ranges->ranges.front();
+        file.SetRegion(range.offset, range.length);
+        auto response = MakeFileResponse(http::status::partial_content, file, req.version(), req.keep_alive(), content_type);
+        response.set(http::field::content_range, MakeContentRange(range, size));
+        SetValidators(response, {}, last_modified_date);
+        return response;
+    }
+
+    auto response = MakeFileResponse(http::status::ok, file, req.version(), req.keep_alive(), content_type);
+    SetValidators(response, {}, last_modified_date);
+    return response;
+}
+
+/**
+ * Создаёт ответ из индекса статических файлов
+ * @param req запрос
+ * @param asset файл
+ * @return 304, если у клиента актуальная версия, 206 или 416 на запрос участков,
+ * иначе 200 с содержимым в подходящем кодировании
+ */
+VariantResponse FileHandler::MakeAssetResponse(const StringRequest& req, std::shared_ptr<const StaticAssetIndex::Asset> asset) {
+    auto encoding = SelectContentEncoding(req[http::field::accept_encoding]);
+    if (asset->GetContent(encoding).empty() && encoding != ContentEncoding::IDENTITY) {
+        encoding = ContentEncoding::IDENTITY;
+    }
+    const auto etag = asset->GetETag(encoding);
+
+    if (IsNotModified(req, etag, asset->last_modified)) {
+        auto response = MakeNotModifiedResponse(req, etag, asset->last_modified_date);
+        if (asset->HasEncodings()) {
+            response.set(http::field::vary, "Accept-Encoding"sv);
+        }
+        return response;
+    }
+
+    // Участки отсчитываются в исходном (несжатом) содержимом
+    const std::string_view content = asset->content;
+    if (const auto ranges = GetRequestedRanges(req, content.size(), asset->etag, asset->last_modified)) {
+        if (ranges->ranges.empty()) {
+            return MakeRangeNotSatisfiableResponse(req, content.size());
+        }
+        if (ranges->ranges.size() > 1) {
+            auto response = MakeMultipartResponse(req, ranges->ranges, content.size(), asset->content_type,
+                                                  [content](ByteRange range, std::string& out) {
+                out.append(content.substr(range.offset, range.length));
+                return true;
+            });
+            SetValidators(response, asset->etag, asset->last_modified_date);
+            if (asset->HasEncodings()) {
+                response.set(http::field::vary, "Accept-Encoding"sv);
+            }
+            return response;
+        }
+        const auto range = ranges->ranges.front();
+        SharedBufferResponse response(http::status::partial_content, req.version());
+        response.set(http::field::content_type, asset->content_type);
+        response.set(http::field::content_range, MakeContentRange(range, content.size()));
+        SetValidators(response, asset->etag, asset->last_modified_date);
+        if (asset->HasEncodings()) {
+            response.set(http::field::vary, "Accept-Encoding"sv);
+        }
+        response.body() = {std::move(asset), content.substr(range.offset, range.length)};
+        response.prepare_payload();
+        response.keep_alive(req.keep_alive());
+        return response;
+    }
+
+    SharedBufferResponse response(http::status::ok, req.version());
+    response.set(http::field::content_type, asset->content_type);
+    SetValidators(response, etag, asset->last_modified_date);
+    if (asset->HasEncodings()) {
+        response.set(http::field::vary, "Accept-Encoding"sv);
+    }
+    if (encoding == ContentEncoding::GZIP) {
+        response.set(http::field::content_encoding, "gzip"sv);
+    } else if (encoding == ContentEncoding::DEFLATE) {
+        response.set(http::field::content_encoding, "deflate"sv);
+    }
+    const auto encoded = asset->GetContent(encoding);
+    response.body() = {std::move(asset), encoded};
+    response.prepare_payload();
+    response.keep_alive(req.keep_alive());
+    return response;
 }
-}  // namespace http_handler
\ No newline at end of file
+}  // namespace http_handler
@@ -9,6 +9,7 @@
 #include "endpoint.h"
 #include "error_response.h"
 #include "make_response.h"
+#include "static_asset_index.h"
 #include "../util/util.h"
 
 namespace http_handler {
@@ -21,7 +22,15 @@ using namespace std::literals;
 
 class FileHandler {
 public:
-    explicit FileHandler(fs::path path): root_path_(std::move(path)) {}
+    /**
+     * @param path каталог статических файлов
+     * @param assets индекс статических файлов. Файлы из индекса отдаются из памяти,
+     * остальные - с диска
+     */
+    explicit FileHandler(fs::path path, std::shared_ptr<const StaticAssetIndex> assets = nullptr)
+        : root_path_(std::move(path))
+        , assets_(std::move(assets)) {
+    }
 
     FileHandler(const FileHandler&) = delete;
     FileHandler& operator=(const FileHandler&) = delete;
@@ -29,6 +38,9 @@ public:
     VariantResponse HandleFileResponse(const StringRequest& req);
 
 private:
+    static VariantResponse MakeAssetResponse(const StringRequest& req, std::shared_ptr<const StaticAssetIndex::Asset> asset);
+
     const fs::path root_path_;
+    std::shared_ptr<const StaticAssetIndex> assets_;
 };
 }  // namespace http_handler
\ No newline at end of file
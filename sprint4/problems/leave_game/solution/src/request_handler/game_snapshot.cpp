@@ -0,0 +1,111 @@
+#include "game_snapshot.h"
+
+namespace http_handler {
+
+const GameSnapshot::Session* GameSnapshot::FindSession(const app::Token& token) const {
+    const auto token_it = tokens->find(token);
+    if (token_it == tokens->end()) {
+        return nullptr;
+    }
+    const auto session_it = sessions.find(token_it->second.session);
+    return session_it != sessions.end() ? session_it->second.get() : nullptr;
+}
+
+std::shared_ptr<app::Player> GameSnapshot::FindPlayer(const app::Token& token) const {
+    const auto it = tokens->find(token);
+    return it != tokens->end() ? it->second.player : nullptr;
+}
+
+std::shared_ptr<const SessionSnapshot> GameSnapshot::Session::GetState() const {
+    return Get(state_, MakeStateSnapshot);
+}
+
+std::shared_ptr<const SessionSnapshot> GameSnapshot::Session::GetPlayers() const {
+    return Get(players_, MakePlayersSnapshot);
+}
+
+std::shared_ptr<const SessionSnapshot> GameSnapshot::Session::GetStateMsgpack() const {
+    return Get(state_msgpack_, MakeStateMsgpackSnapshot);
+}
+
+/**
+ * Возвращает тело ответа, построив его при первом вызове. Одновременные первые вызовы ждут одного построения
+ * @param body тело ответа и признак его построения
+ * @param make_body функция, строящая снимок из копии сессии
+ * @return снимок
+ */
+template <typename MakeBody>
+std::shared_ptr<const SessionSnapshot> GameSnapshot::Session::Get(Body& body, MakeBody&& make_body) const {
+    std::call_once(body.built, [&] {
+        body.snapshot = make_body(session_);
+    });
+    return body.snapshot;
+}
+
+GameSnapshotPublisher::GameSnapshotPublisher(app::Application& app)
+    : app_(app) {
+    Publish(true);
+}
+
+void GameSnapshotPublisher::OnTick([[maybe_unused]] std::chrono::milliseconds tick) {
+    Publish(true);
+}
+
+void GameSnapshotPublisher::Publish(bool rebuild_tokens) {
+    const auto previous = snapshot_.Load();
+    auto tokens = previous ? previous->tokens : nullptr;
+
+    const auto& players = app_.GetPlayers();
+    if (!tokens || (rebuild_tokens && players.GetVersion() != players_version_)) {
+        const auto& token_to_player = players.GetPlayerTokens().GetTokenToPlayer();
+        auto index = std::make_shared<GameSnapshot::TokenIndex>();
+        index->reserve(token_to_player.size());
+        for (const auto& [token, player] : token_to_player) {
+            if (const auto session = player->GetSession()) {
+                index->emplace(token, GameSnapshot::TokenEntry{session->GetId(), player});
+            }
+        }
+        tokens = std::move(index);
+        players_version_ = players.GetVersion();
+    } else if (previous && !HasChangedSessions(*previous)) {
+        return;
+    }
+
+    auto snapshot = std::make_shared<GameSnapshot>();
+    snapshot->tokens = std::move(tokens);
+    for (const auto& session : app_.GetGameModel().GetSessions()) {
+        if (!session) {
+            continue;
+        }
+        // Неизменившаяся сессия переходит в новый снимок вместе с уже построенными телами ответов
+        if (previous) {
+            const auto it = previous->sessions.find(session->GetId());
+            if (it != previous->sessions.end() && it->second->GetVersion() == session->GetVersion()) {
+                snapshot->sessions.emplace(it->first, it->second);
+                continue;
+            }
+        }
+        snapshot->sessions.emplace(session->GetId(), std::make_shared<const GameSnapshot::Session>(session->CopyState()));
+    }
+    snapshot_.Store(std::move(snapshot));
+}
+
+/**
+ * Проверяет, изменились ли сессии с момента построения снимка
+ * @param snapshot опубликованный снимок
+ * @return true, если появилась новая сессия или изменилась версия одной из сессий
+ */
+bool GameSnapshotPublisher::HasChangedSessions(const GameSnapshot& snapshot) const {
+    for (const auto& session : app_.GetGameModel().GetSessions()) {
+        if (!session) {
+            continue;
+        }
+        const auto it = snapshot.sessions.find(session->GetId());
+        if (it == snapshot.sessions.end() || it->second->GetVersion() != session->GetVersion()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "session_snapshot.h"
+#include "../app/application.h"
+#include "../util/atomic_shared_ptr.h"
+#include "../util/flat_hash_map.h"
+
+namespace http_handler {
+
+/**
+ * Неизменяемый снимок игры для запросов на чтение: копии состояния игровых сессий и сессии игроков по их токенам.
+ * Ответы /game/state (JSON и MessagePack) и /game/players строятся при первом чтении и разделяются
+ * всеми последующими чтениями той же версии сессии
+ */
+struct GameSnapshot {
+    /**
+     * Копия состояния одной версии игровой сессии. Тела ответов строятся из копии при первом запросе
+     * в потоке этого запроса, поэтому тела, которые никто не запросил, не сериализуются
+     */
+    class Session {
+    public:
+        explicit Session(model::GameSession session)
+            : session_(std::move(session)) {
+        }
+
+        Session(const Session&) = delete;
+        Session& operator=(const Session&) = delete;
+
+        [[nodiscard]] std::uint64_t GetVersion() const noexcept {
+            return session_.GetVersion();
+        }
+
+        /**
+         * Возвращает тело ответа /api/v1/game/state, при первом вызове строит его. Безопасно вызывать из любого потока
+         * @return снимок, тело которого можно отправлять без копирования
+         */
+        [[nodiscard]] std::shared_ptr<const SessionSnapshot> GetState() const;
+
+        /**
+         * Возвращает тело ответа /api/v1/game/players, при первом вызове строит его. Безопасно вызывать из любого потока
+         * @return снимок, тело которого можно отправлять без копирования
+         */
+        [[nodiscard]] std::shared_ptr<const SessionSnapshot> GetPlayers() const;
+
+        /**
+         * Возвращает тело ответа /api/v1/game/state в формате MessagePack, при первом вызове строит его.
+         * Безопасно вызывать из любого потока
+         * @return снимок, тело которого можно отправлять без копирования
+         */
+        [[nodiscard]] std::shared_ptr<const SessionSnapshot> GetStateMsgpack() const;
+
+    private:
+        struct Body {
+            std::once_flag built;
+            std::shared_ptr<const SessionSnapshot> snapshot;
+        };
+
+        template <typename MakeBody>
+        std::shared_ptr<const SessionSnapshot> Get(Body& body, MakeBody&& make_body) const;
+
+        const model::GameSession session_;
+        mutable Body state_;
+        mutable Body players_;
+        mutable Body state_msgpack_;
+    };
+
+    struct TokenEntry {
+        model::GameSession::Id session;
+        // Из другого потока у игрока используется только потокобезопасная ячейка команды движения
+        std::shared_ptr<app::Player> player;
+    };
+
+    using TokenIndex = util::FlatHashMap<app::Token, TokenEntry, app::TokenHasher>;
+    // Снимки неизменившихся сессий разделяются между снимками игры вместе с построенными телами
+    using SessionIndex = std::unordered_map<model::GameSession::Id, std::shared_ptr<const Session>,
+                                            model::GameSession::IdHasher>;
+
+    // Индекс токенов перестраивается только после тика, поэтому разделяется между снимками
+    std::shared_ptr<const TokenIndex> tokens;
+    SessionIndex sessions;
+
+    /**
+     * Ищет сессию игрока
+     * @param token токен игрока
+     * @return снимок сессии или nullptr, если игрока нет в снимке
+     */
+    [[nodiscard]] const Session* FindSession(const app::Token& token) const;
+
+    /**
+     * Ищет игрока для приёма команды движения
+     * @param token токен игрока
+     * @return игрок или nullptr, если игрока нет в снимке
+     */
+    [[nodiscard]] std::shared_ptr<app::Player> FindPlayer(const app::Token& token) const;
+};
+
+/**
+ * Публикует снимки игры (RCU): снимок строится в api_strand после изменений игры и атомарно
+ * заменяет предыдущий, а запросы на чтение берут текущий снимок из любого потока без блокировок.
+ * Публикация только копирует изменившиеся сессии, сериализация откладывается до первого чтения.
+ * Индекс токенов обновляется после тика, поэтому игрок, вошедший после последнего тика,
+ * ещё не виден в снимке, и его запросы обрабатываются в api_strand
+ */
+class GameSnapshotPublisher : public app::ApplicationListener {
+public:
+    /**
+     * Публикует первый снимок. Вызывается до запуска api_strand или в нём
+     * @param app приложение
+     */
+    explicit GameSnapshotPublisher(app::Application& app);
+
+    GameSnapshotPublisher(const GameSnapshotPublisher&) = delete;
+    GameSnapshotPublisher& operator=(const GameSnapshotPublisher&) = delete;
+
+    // Вызывается в api_strand после тика и обработки ухода игроков другими слушателями
+    void OnTick(std::chrono::milliseconds tick) override;
+
+    /**
+     * Публикует снимок, если состояние сессий изменилось. Вызывается в api_strand
+     * @param rebuild_tokens перестроить индекс токенов, если набор игроков изменился
+     */
+    void Publish(bool rebuild_tokens = false);
+
+    /**
+     * Возвращает текущий снимок. Безопасно вызывать из любого потока
+     */
+    [[nodiscard]] std::shared_ptr<const GameSnapshot> Get() const noexcept {
+        return snapshot_.Load();
+    }
+
+private:
+    bool HasChangedSessions(const GameSnapshot& snapshot) const;
+
+    app::Application& app_;
+    std::uint64_t players_version_ = std::numeric_limits<std::uint64_t>::max();
+    util::AtomicSharedPtr<const GameSnapshot> snapshot_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,127 @@
+#include "game_state_hub.h"
+
+#include <unordered_map>
+
+#include "api_handler.h"
+#include "endpoint.h"
+#include "error_response.h"
+#include "../logger/logger.h"
+
+namespace http_handler {
+
+void GameStateHub::Accept(http_server::StrandSocket&& socket, StringRequest&& request) {
+    if (request.target() != EndPoint::WEBSOCKET) {
+        return Reject(std::move(socket), MakeTextResponse(request, http::status::bad_request,
+                                                          ErrorResponse::BAD_REQ(), CacheControl::NO_CACHE));
+    }
+    net::dispatch(api_strand_, [self = shared_from_this(), socket = std::move(socket), request = std::move(request)]() mutable {
+        const auto token = ApiHandler::TryExtractToken(request);
+        if (!token) {
+            return Reject(std::move(socket), MakeTextResponse(request, http::status::unauthorized,
+                                                              ErrorResponse::INVALID_TOKEN, CacheControl::NO_CACHE));
+        }
+        auto player = self->app_.FindPlayer(*token);
+        if (!player) {
+            return Reject(std::move(socket), MakeTextResponse(request, http::status::unauthorized,
+                                                              ErrorResponse::UNKNOWN_TOKEN, CacheControl::NO_CACHE));
+        }
+        if (self->max_subscribers_ != 0) {
+            // Закрытые соединения удаляются из списка только на тике, поэтому считаем открытые
+            std::erase_if(self->subscribers_, [](const std::weak_ptr<GameWebSocket>& subscriber) {
+                return subscriber.expired();
+            });
+            if (self->subscribers_.size() >= self->max_subscribers_) {
+                ++self->rejected_subscribers_;
+                self->subscribers_count_ = self->subscribers_.size();
+                return Reject(std::move(socket), MakeTextResponse(request, http::status::service_unavailable,
+                                                                  ErrorResponse::SERVICE_UNAVAILABLE, CacheControl::NO_CACHE));
+            }
+        }
+        auto ws = std::make_shared<GameWebSocket>(std::move(socket), self, *token, std::move(player));
+        self->subscribers_.push_back(ws);
+        self->subscribers_count_ = self->subscribers_.size();
+        ws->Run(std::move(request));
+    });
+}
+
+void GameStateHub::OnTick([[maybe_unused]] std::chrono::milliseconds tick) {
+    std::unordered_map<const model::GameSession*, GameWebSocket::Frame> frames;
+    const auto snapshot = snapshots_ ? snapshots_->Get() : nullptr;
+    std::erase_if(subscribers_, [this, &frames, &snapshot](const std::weak_ptr<GameWebSocket>& subscriber) {
+        const auto ws = subscriber.lock();
+        if (!ws) {
+            return true;
+        }
+        const auto player = app_.FindPlayer(ws->GetToken());
+        if (!player) {
+            // Игрок покинул игру
+            ws->Close();
+            return true;
+        }
+        const auto session = player->GetSession();
+        auto& frame = frames[session.get()];
+        if (!frame) {
+            frame = MakeFrame(*session, snapshot.get());
+        }
+        ws->PushState(frame);
+        return false;
+    });
+    subscribers_count_ = subscribers_.size();
+}
+
+/**
+ * Возвращает кадр состояния сессии. Тело из снимка используется, только если снимок построен для текущей версии сессии
+ * @param session игровая сессия
+ * @param snapshot текущий снимок игры или nullptr
+ * @return кадр состояния
+ */
+GameWebSocket::Frame GameStateHub::MakeFrame(const model::GameSession& session, const GameSnapshot* snapshot) {
+    if (snapshot) {
+        const auto it = snapshot->sessions.find(session.GetId());
+        if (it != snapshot->sessions.end() && it->second->GetVersion() == session.GetVersion()) {
+            auto state = it->second->GetState();
+            const std::string* body = &state->body;
+            // Кадр владеет снимком тела, поэтому тело не копируется
+            return GameWebSocket::Frame{std::move(state), body};
+        }
+    }
+    std::string body;
+    ApiHandler::WriteGameState(session, body);
+    ++frames_serialized_;
+    return std::make_shared<const std::string>(std::move(body));
+}
+
+void GameStateHub::Move(const app::Token& token, const std::shared_ptr<app::Player>& player,
+                        const http_server::Endpoint& endpoint, std::string message, std::weak_ptr<GameWebSocket> socket) {
+    using namespace std::chrono_literals;
+    auto reply = [&socket](std::string_view error) {
+        if (const auto ws = socket.lock()) {
+            ws->PushReply(std::make_shared<const std::string>(error));
+        }
+    };
+    if (rate_limiter_ && rate_limiter_->Check(token, endpoint) > 0ns) {
+        return reply(ErrorResponse::TOO_MANY_REQUESTS);
+    }
+    // Команда ставится в очередь без api_strand и применяется в начале следующего тика
+    const auto direction = ApiHandler::ParseMove(message);
+    if (!direction) {
+        return reply(ErrorResponse::BAD_PARSE_ACTION);
+    }
+    app_.GetActionInbox().Push(player, *direction);
+}
+
+void GameStateHub::Reject(http_server::StrandSocket&& socket, StringResponse&& response) {
+    using namespace std::literals;
+    response.keep_alive(false);
+    auto stream = std::make_shared<http_server::Stream>(std::move(socket));
+    auto safe_response = std::make_shared<StringResponse>(std::move(response));
+    stream->expires_after(30s);
+    http::async_write(*stream, *safe_response, [stream, safe_response](beast::error_code ec, std::size_t) {
+        if (ec) {
+            return http_server::ReportError(ec, "websocket reject"sv);
+        }
+        stream->socket().shutdown(net::socket_base::shutdown_send, ec);
+    });
+}
+
+}  // namespace http_handler
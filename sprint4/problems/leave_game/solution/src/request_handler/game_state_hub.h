@@ -0,0 +1,116 @@
+#pragma once
+
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "game_snapshot.h"
+#include "game_websocket.h"
+#include "make_response.h"
+#include "rate_limiter.h"
+#include "../app/application.h"
+#include "../http_server/http_server.h"
+
+namespace http_handler {
+namespace net = boost::asio;
+
+/**
+ * Рассылка состояния игры по WebSocket (эндпоинт EndPoint::WEBSOCKET).
+ * После каждого тика подписчики сессии получают один и тот же кадр. Если подключены снимки игры,
+ * кадром служит тело ответа /game/state из опубликованного снимка, которое разделяется с запросами на чтение,
+ * иначе состояние сессии сериализуется один раз за тик.
+ * Подписчики, токены и игровая модель используются только в api_strand.
+ * WebSocket-соединения не учитываются в ServerOptions::max_sessions, поэтому их число ограничено отдельно
+ */
+class GameStateHub : public app::ApplicationListener, public std::enable_shared_from_this<GameStateHub> {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    /**
+     * @param app приложение
+     * @param api_strand strand для выполнения запросов к API
+     * @param max_subscribers максимальное количество открытых WebSocket-соединений (0 - без ограничения)
+     */
+    GameStateHub(app::Application& app, Strand api_strand, std::size_t max_subscribers = 0)
+        : app_(app)
+        , api_strand_(std::move(api_strand))
+        , max_subscribers_(max_subscribers) {
+    }
+
+    GameStateHub(const GameStateHub&) = delete;
+    GameStateHub& operator=(const GameStateHub&) = delete;
+
+    /**
+     * Подключает ограничение частоты команд, полученных по WebSocket. Вызывается до запуска сервера
+     * @param rate_limiter ограничение частоты запросов к API (nullptr - без ограничения)
+     */
+    void SetRateLimiter(std::shared_ptr<RateLimiter> rate_limiter) {
+        rate_limiter_ = std::move(rate_limiter);
+    }
+
+    /**
+     * Подключает снимки игры, из которых берутся кадры состояния. Вызывается до запуска сервера.
+     * Снимок должен публиковаться после тика раньше, чем вызывается OnTick
+     * @param snapshots публикатор снимков игры (nullptr - сериализовать состояние самостоятельно)
+     */
+    void SetSnapshotPublisher(std::shared_ptr<GameSnapshotPublisher> snapshots) {
+        snapshots_ = std::move(snapshots);
+    }
+
+    /**
+     * Обрабатывает запрос на смену протокола (http_server::UpgradeHandler).
+     * Проверяет эндпоинт и токен игрока, затем переводит соединение в WebSocket.
+     * Если открыто max_subscribers соединений, отвечает 503
+     * @param socket сокет соединения
+     * @param request запрос Upgrade
+     */
+    void Accept(http_server::StrandSocket&& socket, StringRequest&& request);
+
+    // Рассылает состояние игровых сессий подписчикам. Вызывается в api_strand
+    void OnTick(std::chrono::milliseconds tick) override;
+
+    /**
+     * Ставит команду, полученную по WebSocket, в очередь команд. Команды ограничиваются тем же RateLimiter,
+     * что и запросы к API. Можно вызывать из любого потока
+     * @param token токен игрока
+     * @param player игрок
+     * @param endpoint адрес клиента
+     * @param message текст сообщения {"move": "L"}
+     * @param socket соединение, в которое отправляется ответ об ошибке
+     */
+    void Move(const app::Token& token, const std::shared_ptr<app::Player>& player, const http_server::Endpoint& endpoint,
+              std::string message, std::weak_ptr<GameWebSocket> socket);
+
+    /// Количество открытых WebSocket-соединений
+    [[nodiscard]] std::size_t GetSubscribers() const noexcept { return subscribers_count_.load(std::memory_order_relaxed); }
+
+    /// Количество отклонённых запросов Upgrade из-за предела max_subscribers
+    [[nodiscard]] std::size_t GetRejectedSubscribers() const noexcept {
+        return rejected_subscribers_.load(std::memory_order_relaxed);
+    }
+
+    /// Количество кадров состояния, сериализованных без снимков игры (по одному на игровую сессию за тик)
+    [[nodiscard]] std::size_t GetFramesSerialized() const noexcept { return frames_serialized_.load(std::memory_order_relaxed); }
+
+private:
+    // Отвечает на запрос Upgrade обычным HTTP-ответом и закрывает соединение
+    static void Reject(http_server::StrandSocket&& socket, StringResponse&& response);
+
+    // Возвращает кадр состояния сессии для рассылки после тика
+    GameWebSocket::Frame MakeFrame(const model::GameSession& session, const GameSnapshot* snapshot);
+
+    app::Application& app_;
+    Strand api_strand_;
+    const std::size_t max_subscribers_;
+    std::shared_ptr<RateLimiter> rate_limiter_;
+    std::shared_ptr<GameSnapshotPublisher> snapshots_;
+    std::vector<std::weak_ptr<GameWebSocket>> subscribers_;
+    std::atomic<std::size_t> subscribers_count_{0};
+    std::atomic<std::size_t> rejected_subscribers_{0};
+    std::atomic<std::size_t> frames_serialized_{0};
+};
+
+}  // namespace http_handler
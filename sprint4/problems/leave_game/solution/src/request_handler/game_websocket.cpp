@@ -0,0 +1,148 @@
+#include "game_websocket.h"
+
+#include <algorithm>
+
+#include "error_response.h"
+#include "game_state_hub.h"
+#include "../logger/logger.h"
+
+namespace http_handler {
+
+GameWebSocket::GameWebSocket(http_server::StrandSocket&& socket, std::shared_ptr<GameStateHub> hub, app::Token token,
+                             std::shared_ptr<app::Player> player)
+    : ws_(std::move(socket))
+    , hub_(std::move(hub))
+    , token_(std::move(token))
+    , player_(std::move(player)) {
+    beast::error_code ec;
+    endpoint_ = ws_.next_layer().socket().remote_endpoint(ec);
+}
+
+void GameWebSocket::Run(StringRequest&& request) {
+    ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+    ws_.text(true);
+    ws_.read_message_max(MAX_MESSAGE_SIZE);
+    // Запрос сохраняется до окончания рукопожатия
+    auto req = std::make_shared<StringRequest>(std::move(request));
+    net::dispatch(ws_.get_executor(), [self = shared_from_this(), req] {
+        self->ws_.async_accept(*req, [self, req](beast::error_code ec) {
+            self->OnAccept(ec);
+        });
+    });
+}
+
+void GameWebSocket::PushState(Frame frame) {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this(), frame = std::move(frame)]() mutable {
+        self->state_ = std::move(frame);
+        if (self->open_ && !self->writing_) {
+            self->Write();
+        }
+    });
+}
+
+void GameWebSocket::PushReply(Frame frame) {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this(), frame = std::move(frame)]() mutable {
+        if (self->replies_.size() >= MAX_PENDING_REPLIES) {
+            // Клиент не читает сокет: очередь ответов не растёт, соединение закрывается
+            return self->DoClose(websocket::close_code::policy_error);
+        }
+        self->replies_.push_back(std::move(frame));
+        if (self->open_ && !self->writing_) {
+            self->Write();
+        }
+    });
+}
+
+void GameWebSocket::Close() {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this()] {
+        self->DoClose(websocket::close_code::going_away);
+    });
+}
+
+void GameWebSocket::DoClose(websocket::close_code code) {
+    replies_.clear();
+    state_.reset();
+    if (!open_) {
+        return;
+    }
+    open_ = false;
+    ws_.async_close(code, [self = shared_from_this()](beast::error_code) {});
+}
+
+void GameWebSocket::OnAccept(beast::error_code ec) {
+    using namespace std::literals;
+    if (ec) {
+        return http_server::ReportError(ec, "websocket accept"sv);
+    }
+    open_ = true;
+    if (state_ || !replies_.empty()) {
+        Write();
+    }
+    Read();
+}
+
+void GameWebSocket::Read() {
+    buffer_.clear();
+    ws_.async_read(buffer_, beast::bind_front_handler(&GameWebSocket::OnRead, shared_from_this()));
+}
+
+void GameWebSocket::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+    using namespace std::literals;
+    if (ec) {
+        open_ = false;
+        if (ec != websocket::error::closed) {
+            http_server::ReportError(ec, "websocket read"sv);
+        }
+        return;
+    }
+    // После закрытия чтение продолжается до ответного кадра Close, команды уже не принимаются
+    if (open_) {
+        if (AcquireMove(std::chrono::steady_clock::now())) {
+            hub_->Move(token_, player_, endpoint_, beast::buffers_to_string(buffer_.data()), weak_from_this());
+        } else {
+            PushReply(std::make_shared<const std::string>(ErrorResponse::TOO_MANY_REQUESTS));
+        }
+    }
+    Read();
+}
+
+/**
+ * Корзина команд хранится как момент, когда она снова станет полной (алгоритм GCRA,
+ * как в util::TokenBucketTable). Используется только в strand соединения
+ * @param now текущее время
+ * @return true, если команда допущена
+ */
+bool GameWebSocket::AcquireMove(std::chrono::steady_clock::time_point now) noexcept {
+    const auto next = std::max(moves_full_at_, now) + MOVE_INTERVAL;
+    if (next - now > MOVE_INTERVAL * MOVE_BURST) {
+        return false;
+    }
+    moves_full_at_ = next;
+    return true;
+}
+
+void GameWebSocket::Write() {
+    if (!replies_.empty()) {
+        writing_ = std::move(replies_.front());
+        replies_.pop_front();
+    } else if (state_) {
+        writing_ = std::move(state_);
+    } else {
+        return;
+    }
+    ws_.async_write(net::buffer(*writing_), beast::bind_front_handler(&GameWebSocket::OnWrite, shared_from_this()));
+}
+
+void GameWebSocket::OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    using namespace std::literals;
+    writing_.reset();
+    if (ec) {
+        open_ = false;
+        return http_server::ReportError(ec, "websocket write"sv);
+    }
+    if (open_) {
+        Write();
+    }
+}
+
+}  // namespace http_handler
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "make_response.h"
+#include "../app/players.h"
+#include "../http_server/http_server.h"
+
+namespace http_handler {
+namespace beast = boost::beast;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+
+class GameStateHub;
+
+/**
+ * WebSocket-соединение игрока. После каждого тика получает состояние своей игровой сессии
+ * и принимает команды движения {"move": "L"} в том же сокете.
+ * Все операции выполняются в strand соединения
+ */
+class GameWebSocket : public std::enable_shared_from_this<GameWebSocket> {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    // Сколько ответов на команды может ждать отправки. Клиент, который присылает команды,
+    // но не читает ответы, отключается при превышении предела
+    constexpr static std::size_t MAX_PENDING_REPLIES = 16;
+    // Наибольший размер сообщения клиента. Команда {"move": "L"} занимает 13 байт,
+    // более длинное сообщение закрывает соединение с кодом too_big
+    constexpr static std::size_t MAX_MESSAGE_SIZE = 128;
+    // Ограничение частоты команд одного соединения, действующее и без RateLimiter:
+    // в среднем одна команда за MOVE_INTERVAL, подряд не больше MOVE_BURST
+    constexpr static std::chrono::milliseconds MOVE_INTERVAL{20};
+    constexpr static unsigned MOVE_BURST = 10;
+
+    /**
+     * @param socket сокет соединения
+     * @param hub рассылка состояния
+     * @param token токен игрока
+     * @param player игрок, которому передаются команды движения
+     */
+    GameWebSocket(http_server::StrandSocket&& socket, std::shared_ptr<GameStateHub> hub, app::Token token,
+                  std::shared_ptr<app::Player> player);
+
+    GameWebSocket(const GameWebSocket&) = delete;
+    GameWebSocket& operator=(const GameWebSocket&) = delete;
+
+    /**
+     * Отвечает на запрос Upgrade и запускает чтение команд
+     * @param request запрос на смену протокола
+     */
+    void Run(StringRequest&& request);
+
+    /**
+     * Ставит в очередь кадр состояния. Если предыдущее состояние ещё не отправлено,
+     * оно заменяется новым: медленный клиент получает только актуальное состояние
+     */
+    void PushState(Frame frame);
+
+    /**
+     * Ставит в очередь ответ на команду. Ответы не заменяются и отправляются раньше состояния.
+     * Если в очереди уже MAX_PENDING_REPLIES ответов, соединение закрывается с кодом policy_error
+     */
+    void PushReply(Frame frame);
+
+    // Закрывает соединение (например, когда игрок покинул игру)
+    void Close();
+
+    [[nodiscard]] const app::Token& GetToken() const noexcept { return token_; }
+
+private:
+    // Закрывает соединение. Вызывается в strand соединения
+    void DoClose(websocket::close_code code);
+    void OnAccept(beast::error_code ec);
+    void Read();
+    void OnRead(beast::error_code ec, std::size_t bytes_read);
+    // Забирает токен из корзины команд соединения. Возвращает false, если корзина пуста
+    bool AcquireMove(std::chrono::steady_clock::time_point now) noexcept;
+    void Write();
+    void OnWrite(beast::error_code ec, std::size_t bytes_written);
+
+    websocket::stream<http_server::Stream> ws_;
+    // Адрес клиента для ограничения частоты команд
+    http_server::Endpoint endpoint_;
+    beast::flat_buffer buffer_;
+    std::shared_ptr<GameStateHub> hub_;
+    const app::Token token_;
+    // Из strand соединения у игрока используется только потокобезопасная ячейка команды движения
+    const std::shared_ptr<app::Player> player_;
+
+    // Момент, когда корзина команд соединения снова станет полной
+    std::chrono::steady_clock::time_point moves_full_at_{};
+
+    std::deque<Frame> replies_;
+    Frame state_;
+    // Кадр, отправляемый текущей операцией записи
+    Frame writing_;
+    bool open_ = false;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,193 @@
+#include "http_range.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+namespace http_handler {
+namespace {
+
+std::string_view Trim(std::string_view str) {
+    const auto begin = str.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const auto end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::optional<std::uint64_t> ParseNumber(std::string_view str) {
+    std::uint64_t value = 0;
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    if (str.empty() || ec != std::errc{} || ptr != str.data() + str.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+constexpr std::string_view WEEK_DAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+constexpr std::string_view MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+}  // namespace
+
+std::optional<RangeSet> ParseRange(std::string_view range, std::uint64_t size) {
+    constexpr std::string_view UNIT = "bytes=";
+    if (!range.starts_with(UNIT)) {
+        return std::nullopt;
+    }
+    range.remove_prefix(UNIT.size());
+
+    RangeSet result;
+    std::size_t count = 0;
+    while (!range.empty()) {
+        const auto comma = range.find(',');
+        const auto spec = Trim(range.substr(0, comma));
+        range = comma == std::string_view::npos ? std::string_view{} : range.substr(comma + 1);
+        if (spec.empty()) {
+            continue;
+        }
+        if (++count > MAX_RANGES) {
+            return std::nullopt;
+        }
+
+        const auto dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto first = spec.substr(0, dash);
+        const auto last = spec.substr(dash + 1);
+
+        if (first.empty()) {
+            // "-N" - последние N байт
+            const auto suffix = ParseNumber(last);
+            if (!suffix) {
+                return std::nullopt;
+            }
+            if (*suffix > 0 && size > 0) {
+                const auto length = std::min(*suffix, size);
+                result.ranges.push_back({size - length, length});
+            }
+            continue;
+        }
+
+        const auto begin = ParseNumber(first);
+        if (!begin) {
+            return std::nullopt;
+        }
+        std::uint64_t end = size == 0 ? 0 : size - 1;
+        if (!last.empty()) {
+            const auto parsed_end = ParseNumber(last);
+            if (!parsed_end || *parsed_end < *begin) {
+                return std::nullopt;
+            }
+            end = std::min(end, *parsed_end);
+        }
+        // Участок, начинающийся за концом содержимого, невыполним
+        if (*begin < size) {
+            result.ranges.push_back({*begin, end - *begin + 1});
+        }
+    }
+    if (count == 0) {
+        return std::nullopt;
+    }
+    std::uint64_t total = 0;
+    for (const auto& r : result.ranges) {
+        total += r.length;
+    }
+    if (total > size) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+std::string MakeContentRange(ByteRange range, std::uint64_t size) {
+    return "bytes " + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1)
+         + "/" + std::to_string(size);
+}
+
+std::string MakeMultipartByteranges(const std::vector<ByteRange>& ranges, std::uint64_t size, std::string_view content_type,
+                                    std::string_view boundary, const std::function<bool(ByteRange, std::string&)>& read) {
+    std::string body;
+    for (const auto& range : ranges) {
+        body.append("--").append(boundary).append("\r\n");
+        body.append("Content-Type: ").append(content_type).append("\r\n");
+        body.append("Content-Range: ").append(MakeContentRange(range, size)).append("\r\n\r\n");
+        if (!read(range, body)) {
+            return {};
+        }
+        body.append("\r\n");
+    }
+    body.append("--").append(boundary).append("--\r\n");
+    return body;
+}
+
+std::string_view GetMultipartBoundary() {
+    static const std::string boundary = [] {
+        constexpr std::string_view HEX = "0123456789abcdef";
+        std::random_device device;
+        std::string result = "byteranges_";
+        for (int i = 0; i < 16; ++i) {
+            result.push_back(HEX[device() % HEX.size()]);
+        }
+        return result;
+    }();
+    return boundary;
+}
+
+std::string FormatHttpDate(std::time_t time) {
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                  WEEK_DAYS[tm.tm_wday].data(), tm.tm_mday, MONTHS[tm.tm_mon].data(), tm.tm_year + 1900,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return buffer;
+}
+
+std::optional<std::time_t> ParseHttpDate(std::string_view date) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    constexpr std::size_t LENGTH = 29;
+    if (date.size() != LENGTH || date[3] != ',' || date.substr(25) != " GMT") {
+        return std::nullopt;
+    }
+    std::tm tm{};
+    const auto number = [date](std::size_t pos, std::size_t length) {
+        return ParseNumber(date.substr(pos, length));
+    };
+    const auto day = number(5, 2);
+    const auto year = number(12, 4);
+    const auto hour = number(17, 2);
+    const auto minute = number(20, 2);
+    const auto second = number(23, 2);
+    const auto month = std::find(std::begin(MONTHS), std::end(MONTHS), date.substr(8, 3));
+    if (!day || !year || !hour || !minute || !second || month == std::end(MONTHS)) {
+        return std::nullopt;
+    }
+    tm.tm_mday = static_cast<int>(*day);
+    tm.tm_mon = static_cast<int>(month - std::begin(MONTHS));
+    tm.tm_year = static_cast<int>(*year) - 1900;
+    tm.tm_hour = static_cast<int>(*hour);
+    tm.tm_min = static_cast<int>(*minute);
+    tm.tm_sec = static_cast<int>(*second);
+    return timegm(&tm);
+}
+
+std::time_t ToTimeT(std::filesystem::file_time_type time) {
+    const auto system_time = std::chrono::file_clock::to_sys(time);
+    return std::chrono::system_clock::to_time_t(std::chrono::time_point_cast<std::chrono::seconds>(system_time));
+}
+
+bool IfRangeMatches(std::string_view if_range, std::string_view etag, std::time_t last_modified) {
+    if (if_range.starts_with('"')) {
+        return !etag.empty() && if_range == etag;
+    }
+    if (if_range.starts_with("W/")) {
+        return false;
+    }
+    const auto date = ParseHttpDate(if_range);
+    return date && *date == last_modified;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http_handler {
+
+/**
+ * Участок содержимого [offset, offset + length)
+ */
+struct ByteRange {
+    std::uint64_t offset = 0;
+    std::uint64_t length = 0;
+
+    bool operator==(const ByteRange&) const = default;
+};
+
+/**
+ * Разобранный заголовок Range
+ */
+struct RangeSet {
+    // Участки, попадающие в содержимое. Пусто, если ни один участок не выполним (ответ 416)
+    std::vector<ByteRange> ranges;
+};
+
+// Сверх этого количества участков заголовок Range игнорируется и отдаётся всё содержимое
+constexpr std::size_t MAX_RANGES = 16;
+
+/**
+ * Разбирает заголовок Range (RFC 9110, 14.2).
+ * Заголовок игнорируется, если участков больше MAX_RANGES или их суммарная длина
+ * превышает размер содержимого: так пересекающиеся участки не умножают объём ответа
+ * @param range значение заголовка
+ * @param size размер содержимого
+ * @return участки или nullopt, если заголовок некорректен и должен быть проигнорирован
+ */
+std::optional<RangeSet> ParseRange(std::string_view range, std::uint64_t size);
+
+/**
+ * Формирует значение заголовка Content-Range
+ * @param range участок
+ * @param size размер содержимого
+ * @return строка вида "bytes 0-99/1000"
+ */
+std::string MakeContentRange(ByteRange range, std::uint64_t size);
+
+/**
+ * Формирует тело multipart/byteranges
+ * @param ranges участки
+ * @param size размер содержимого
+ * @param content_type MIME-тип содержимого
+ * @param boundary разделитель частей
+ * @param read функция, дописывающая в строку участок содержимого
+ * @return тело ответа
+ */
+std::string MakeMultipartByteranges(const std::vector<ByteRange>& ranges, std::uint64_t size, std::string_view content_type,
+                                    std::string_view boundary, const std::function<bool(ByteRange, std::string&)>& read);
+
+/**
+ * Разделитель частей multipart/byteranges, выбранный при запуске сервера
+ */
+std::string_view GetMultipartBoundary();
+
+/**
+ * Формирует дату в формате HTTP (IMF-fixdate), например "Sun, 06 Nov 1994 08:49:37 GMT"
+ */
+std::string FormatHttpDate(std::time_t time);
+
+/**
+ * Разбирает дату в формате HTTP (IMF-fixdate)
+ * @return время или nullopt, если формат не распознан
+ */
+std::optional<std::time_t> ParseHttpDate(std::string_view date);
+
+/**
+ * Переводит время изменения файла в time_t с точностью до секунды, как в заголовке Last-Modified
+ */
+std::time_t ToTimeT(std::filesystem::file_time_type time);
+
+/**
+ * Проверяет условие If-Range. ETag сравнивается строго (слабый ETag не совпадает никогда),
+ * дата должна точно совпадать с Last-Modified
+ * @param if_range значение заголовка
+ * @param etag сильный ETag содержимого в кавычках или пустая строка, если его нет
+ * @param last_modified время изменения содержимого
+ * @return true, если заголовок Range нужно применить
+ */
+bool IfRangeMatches(std::string_view if_range, std::string_view etag, std::time_t last_modified);
+
+}  // namespace http_handler
@@ -1,6 +1,25 @@
 #include "make_response.h"
 
 namespace http_handler {
+namespace {
+/**
+ * Заполняет заголовки текстового ответа с уже установленным телом
+ */
+template <typename Response>
+void SetStringResponseFields(Response& response, bool keep_alive, std::string_view content_type,
+                             std::string_view cache_control, std::string_view allow) {
+    response.set(http::field::content_type, content_type);
+    response.content_length(response.payload_size());
+    response.keep_alive(keep_alive);
+    if (!cache_control.empty()) {
+        response.set(http::field::cache_control, cache_control);
+    }
+    if (!allow.empty()) {
+        response.set(http::field::allow, allow);
+    }
+}
+}  // namespace
+
 /**
  * Создаёт текстовый ответ StringResponse = http::response<http::string_body>
  * @param status статус-код
@@ -16,16 +35,8 @@ StringResponse MakeStringResponse(http::status status, std::string_view body, un
                                   bool keep_alive, std::string_view content_type,
                                   std::string_view cache_control, std::string_view allow) {
     StringResponse response(status, http_version);
-    response.set(http::field::content_type, content_type);
     response.body() = body;
-    response.content_length(body.size());
-    response.keep_alive(keep_alive);
-    if (!cache_control.empty()) {
-        response.set(http::field::cache_control, cache_control);
-    }
-    if (!allow.empty()) {
-        response.set(http::field::allow, allow);
-    }
+    SetStringResponseFields(response, keep_alive, content_type, cache_control, allow);
     return response;
 }
 
@@ -43,6 +54,41 @@ StringResponse MakeTextResponse(const StringRequest& req, http::status status, s
     return MakeStringResponse(status, text, req.version(), req.keep_alive(), ContentType::APPLICATION_JSON, cache_control, allow);
 }
 
+/**
+ * Создаёт текстовый ответ, забирая тело без копирования
+ * @param req запрос
+ * @param status статус-код
+ * @param text текстовое тело запроса
+ * @param cache_control директива управляет поведением кэширования
+ * @param allow директива разрешает обход разделов или отдельных страниц сайта.
+ * @return StringResponse = http::response<http::string_body>
+ */
+StringResponse MakeTextResponse(const StringRequest& req, http::status status, std::string&& text,
+                                std::string_view cache_control, std::string_view allow) {
+    StringResponse response(status, req.version());
+    response.body() = std::move(text);
+    SetStringResponseFields(response, req.keep_alive(), ContentType::APPLICATION_JSON, cache_control, allow);
+    return response;
+}
+
+/**
+ * Создаёт ответ, тело которого ссылается на общий неизменяемый буфер
+ * @param req запрос
+ * @param status статус-код
+ * @param owner владелец буфера
+ * @param text тело запроса внутри буфера owner
+ * @param cache_control директива управляет поведением кэширования
+ * @param content_type MIME-тип тела
+ * @return SharedBufferResponse = http::response<SharedBufferBody>
+ */
+SharedBufferResponse MakeSharedTextResponse(const StringRequest& req, http::status status, std::shared_ptr<const void> owner,
+                                            std::string_view text, std::string_view cache_control, std::string_view content_type) {
+    SharedBufferResponse response(status, req.version());
+    response.body() = {std::move(owner), text};
+    SetStringResponseFields(response, req.keep_alive(), content_type, cache_control, {});
+    return response;
+}
+
 /**
  * Создаёт ответ на передачу файлов
  * @param status статус-код
@@ -50,9 +96,9 @@ StringResponse MakeTextResponse(const StringRequest& req, http::status status, s
  * @param http_version версия HTTP протокола
  * @param keep_alive Опция сокета для отправки сообщений проверки активности
  * @param content_type Заголовок для определения MIME типа ресурса
- * @return FileResponse = http::response<http::file_body>
+ * @return FileResponse = http::response<FileBody>
  */
-FileResponse MakeFileResponse(http::status status, http::file_body::value_type& body, unsigned http_version,
+FileResponse MakeFileResponse(http::status status, FileBody::value_type& body, unsigned http_version,
                                            bool keep_alive, std::string_view content_type) {
     FileResponse response(status, http_version);
     response.set(http::field::content_type, content_type);
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "content_type.h"
+#include "../http_server/file_region_body.h"
+#include "../http_server/http_request.h"
+#include "../http_server/shared_buffer_body.h"
 
 namespace http_handler {
 namespace beast = boost::beast;
 namespace http = beast::http;
 
 using StringResponse = http::response<http::string_body>;
-using StringRequest = http::request<http::string_body>;
-using FileResponse = http::response<http::file_body>;
-using VariantResponse = std::variant<StringResponse, FileResponse>;
+// Запрос с полями в памяти сессии (http_server::HttpRequest)
+using StringRequest = http_server::HttpRequest;
+using FileBody = http_server::FileRegionBody;
+using FileResponse = http::response<FileBody>;
+using SharedBufferResponse = http::response<http_server::SharedBufferBody>;
+using VariantResponse = std::variant<StringResponse, FileResponse, SharedBufferResponse>;
 
 StringResponse MakeStringResponse(http::status status, std::string_view body, unsigned http_version,
                                   bool keep_alive, std::string_view content_type = ContentType::TEXT_HTML,
@@ -18,6 +24,13 @@ StringResponse MakeStringResponse(http::status status, std::string_view body, un
 StringResponse MakeTextResponse(const StringRequest& req, http::status status, std::string_view text,
                                 std::string_view cache_control = std::string_view(), std::string_view allow = std::string_view());
 
-FileResponse MakeFileResponse(http::status status, http::file_body::value_type& body, unsigned http_version,
+StringResponse MakeTextResponse(const StringRequest& req, http::status status, std::string&& text,
+                                std::string_view cache_control = std::string_view(), std::string_view allow = std::string_view());
+
+SharedBufferResponse MakeSharedTextResponse(const StringRequest& req, http::status status, std::shared_ptr<const void> owner,
+                                            std::string_view text, std::string_view cache_control = std::string_view(),
+                                            std::string_view content_type = ContentType::APPLICATION_JSON);
+
+FileResponse MakeFileResponse(http::status status, FileBody::value_type& body, unsigned http_version,
                                      bool keep_alive, std::string_view content_type);
 } // namespace http_handler
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "map_responses.h"
+
+namespace http_handler {
+
+MapResponses::MapResponses(const model::Game::Maps& maps)
+    : map_list_(StaticAssetIndex::MakeAsset(model::SerializeJson(maps), ContentType::APPLICATION_JSON)) {
+    for (const auto& map : maps) {
+        maps_.emplace(*map->GetId(),
+                      StaticAssetIndex::MakeAsset(model::SerializeJson(*map), ContentType::APPLICATION_JSON));
+    }
+}
+
+std::optional<VariantResponse> MapResponses::Handle(const StringRequest& req, const ApiRouteMatch& match) const {
+    if (req.method() != http::verb::get && req.method() != http::verb::head) {
+        return std::nullopt;
+    }
+    switch (match.spec->route) {
+        case ApiRoute::MAPS:
+            return MakeResponse(req, map_list_);
+        case ApiRoute::MAP:
+            if (auto body = FindMap(match.param)) {
+                return MakeResponse(req, std::move(body));
+            }
+            return MakeTextResponse(req, http::status::not_found, ErrorResponse::MAP_NOT_FOUND, CacheControl::NO_CACHE);
+        default:
+            return std::nullopt;
+    }
+}
+
+std::shared_ptr<const StaticAssetIndex::Asset> MapResponses::FindMap(std::string_view id) const {
+    const auto it = maps_.find(id);
+    return it != maps_.end() ? it->second : nullptr;
+}
+
+/**
+ * Создаёт ответ из готового тела
+ * @param req запрос
+ * @param body тело карты или списка карт
+ * @return 304, если у клиента актуальная версия, иначе 200 с телом в подходящем кодировании
+ */
+VariantResponse MapResponses::MakeResponse(const StringRequest& req, std::shared_ptr<const StaticAssetIndex::Asset> body) {
+    auto encoding = SelectContentEncoding(req[http::field::accept_encoding]);
+    if (body->GetContent(encoding).empty() && encoding != ContentEncoding::IDENTITY) {
+        encoding = ContentEncoding::IDENTITY;
+    }
+    const auto etag = body->GetETag(encoding);
+
+    if (const auto if_none_match = req[http::field::if_none_match]; !if_none_match.empty() && IfNoneMatch(if_none_match, etag)) {
+        StringResponse response(http::status::not_modified, req.version());
+        response.set(http::field::etag, etag);
+        response.set(http::field::cache_control, CacheControl::NO_CACHE);
+        if (body->HasEncodings()) {
+            response.set(http::field::vary, "Accept-Encoding"sv);
+        }
+        response.keep_alive(req.keep_alive());
+        return response;
+    }
+
+    SharedBufferResponse response(http::status::ok, req.version());
+    response.set(http::field::content_type, body->content_type);
+    response.set(http::field::cache_control, CacheControl::NO_CACHE);
+    response.set(http::field::etag, etag);
+    if (body->HasEncodings()) {
+        response.set(http::field::vary, "Accept-Encoding"sv);
+    }
+    if (encoding == ContentEncoding::GZIP) {
+        response.set(http::field::content_encoding, "gzip"sv);
+    } else if (encoding == ContentEncoding::DEFLATE) {
+        response.set(http::field::content_encoding, "deflate"sv);
+    }
+    const auto content = body->GetContent(encoding);
+    response.body() = {std::move(body), content};
+    response.prepare_payload();
+    response.keep_alive(req.keep_alive());
+    return response;
+}
+
+}  // namespace http_handler
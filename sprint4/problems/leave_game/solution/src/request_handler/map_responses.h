@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "api_handler.h"
+#include "make_response.h"
+#include "static_asset_index.h"
+#include "../model/game.h"
+
+namespace http_handler {
+
+/**
+ * Готовые ответы на запросы списка карт и отдельной карты.
+ * Карты не меняются после загрузки игры, поэтому их JSON сериализуется один раз при запуске
+ * вместе со сжатыми вариантами и ETag, а ответы ссылаются на общий буфер без копирования.
+ * Объект неизменяем и может использоваться из нескольких потоков одновременно
+ */
+class MapResponses {
+public:
+    explicit MapResponses(const model::Game::Maps& maps);
+
+    MapResponses(const MapResponses&) = delete;
+    MapResponses& operator=(const MapResponses&) = delete;
+
+    /**
+     * Отвечает на GET или HEAD запрос /api/v1/maps или /api/v1/maps/{id}
+     * @param req запрос
+     * @param match маршрут запроса
+     * @return 200 с готовым телом, 304 или 404, если карты нет.
+     * nullopt, если запрос адресован другому маршруту API или использует другой метод
+     */
+    [[nodiscard]] std::optional<VariantResponse> Handle(const StringRequest& req, const ApiRouteMatch& match) const;
+
+    [[nodiscard]] std::shared_ptr<const StaticAssetIndex::Asset> GetMapList() const noexcept { return map_list_; }
+
+    /**
+     * @param id id карты
+     * @return готовое тело карты или nullptr, если карты нет
+     */
+    [[nodiscard]] std::shared_ptr<const StaticAssetIndex::Asset> FindMap(std::string_view id) const;
+
+private:
+    static VariantResponse MakeResponse(const StringRequest& req, std::shared_ptr<const StaticAssetIndex::Asset> body);
+
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    std::shared_ptr<const StaticAssetIndex::Asset> map_list_;
+    std::unordered_map<std::string, std::shared_ptr<const StaticAssetIndex::Asset>, StringHash, std::equal_to<>> maps_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api_handler.h"
+#include "api_router.h"
+#include "make_response.h"
+#include "../http_server/http_server.h"
+#include "../metrics/server_metrics.h"
+
+namespace http_handler {
+
+/**
+ * Метки эндпоинтов для метрик запросов: пути маршрутов API в порядке API_ROUTES
+ * (у маршрута с параметром - {id} вместо параметра), затем API_OTHER и STATIC
+ */
+struct MetricsEndpoints {
+    MetricsEndpoints() = delete;
+    // Запросы к API, не совпавшие ни с одним маршрутом
+    constexpr static std::string_view API_OTHER = "api_other"sv;
+    // Запросы статических файлов
+    constexpr static std::string_view STATIC = "static"sv;
+    constexpr static std::size_t API_OTHER_INDEX = API_ROUTES.size();
+    constexpr static std::size_t STATIC_INDEX = API_ROUTES.size() + 1;
+
+    static std::vector<std::string> Labels() {
+        std::vector<std::string> labels;
+        labels.reserve(API_ROUTES.size() + 2);
+        for (const auto& spec : API_ROUTES) {
+            labels.emplace_back(spec.path);
+            if (spec.has_param) {
+                labels.back() += "{id}"sv;
+            }
+        }
+        labels.emplace_back(API_OTHER);
+        labels.emplace_back(STATIC);
+        return labels;
+    }
+
+    /**
+     * @param req запрос
+     * @return номер метки эндпоинта запроса в Labels()
+     */
+    static std::size_t Classify(const StringRequest& req) {
+        if (!ApiHandler::IsAPIRequest(req)) {
+            return STATIC_INDEX;
+        }
+        std::string decoded_path;
+        if (const auto match = ApiRouter::Match(req.target(), decoded_path)) {
+            return static_cast<std::size_t>(match->spec - API_ROUTES.data());
+        }
+        return API_OTHER_INDEX;
+    }
+};
+
+/**
+ * Декоратор обработчика запросов: измеряет время обработки запросов и отвечает на GET /metrics.
+ * Время отсчитывается от вызова обработчика до передачи ответа сессии. Запросы к /metrics не учитываются
+ * @tparam Handler обработчик запросов. Метрики создаются с метками MetricsEndpoints::Labels()
+ */
+template <class Handler>
+class MetricsRequestHandler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    MetricsRequestHandler(Handler& handler, metrics::ServerMetrics& metrics) : decorated_(handler), metrics_(metrics) {}
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(const http_server::Endpoint& endpoint, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        if (req.target() == EndPoint::METRICS) {
+            return send(MakeMetricsResponse(req));
+        }
+        const auto start = Clock::now();
+        const std::size_t label = MetricsEndpoints::Classify(req);
+        metrics_.GetRequestsInFlight().Add(1);
+        decorated_(endpoint, std::move(req), [this, label, start, s = std::forward<Send>(send)](auto&& response) {
+            const unsigned status = response.result_int();
+            s(std::forward<decltype(response)>(response));
+            metrics_.GetRequestsInFlight().Add(-1);
+            metrics_.RecordRequest(label, status, Clock::now() - start);
+        });
+    }
+
+private:
+    StringResponse MakeMetricsResponse(const StringRequest& req) const {
+        if (req.method() != http::verb::get && req.method() != http::verb::head) {
+            return MakeTextResponse(req, http::status::method_not_allowed, ErrorResponse::INVALID_GET,
+                                    CacheControl::NO_CACHE, Api::GET_HEAD);
+        }
+        StringResponse response(http::status::ok, req.version());
+        response.body() = metrics_.Scrape();
+        response.set(http::field::content_type, ContentType::PROMETHEUS_TEXT);
+        response.set(http::field::cache_control, CacheControl::NO_CACHE);
+        response.content_length(response.body().size());
+        response.keep_alive(req.keep_alive());
+        return response;
+    }
+
+    Handler& decorated_;
+    metrics::ServerMetrics& metrics_;
+};
+
+}  // namespace http_handler
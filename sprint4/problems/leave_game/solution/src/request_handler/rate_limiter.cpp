@@ -0,0 +1,87 @@
+#include "rate_limiter.h"
+
+#include "api_handler.h"
+
+namespace http_handler {
+
+namespace {
+
+/**
+ * Ключ корзины IP-адреса. Адрес IPv4, отображённый в IPv6, совпадает с исходным адресом IPv4
+ * @param endpoint адрес клиента
+ * @return ключ или nullopt, если это не адрес TCP
+ */
+std::optional<std::uint64_t> AddressKey(const http_server::Endpoint& endpoint) {
+    const auto tcp_endpoint = http_server::ToTcpEndpoint(endpoint);
+    if (!tcp_endpoint) {
+        return std::nullopt;
+    }
+    auto address = tcp_endpoint->address();
+    if (address.is_v6() && address.to_v6().is_v4_mapped()) {
+        address = boost::asio::ip::make_address_v4(boost::asio::ip::v4_mapped, address.to_v6());
+    }
+    if (address.is_v4()) {
+        return address.to_v4().to_uint();
+    }
+    const auto bytes = address.to_v6().to_bytes();
+    std::uint64_t key = 0x9e3779b97f4a7c15ull;
+    for (const auto byte : bytes) {
+        key = (key ^ byte) * 0x100000001b3ull;
+    }
+    return key;
+}
+
+}  // namespace
+
+RateLimiter::RateLimiter(const Options& options) {
+    if (options.per_token) {
+        per_token_.emplace(*options.per_token, options.capacity);
+    }
+    if (options.per_ip) {
+        per_ip_.emplace(*options.per_ip, options.capacity);
+    }
+}
+
+std::chrono::nanoseconds RateLimiter::Check(const StringRequest& req, const http_server::Endpoint& endpoint,
+                                            Clock::time_point now) {
+    // Токен разбирается, только если есть ограничение на токен, и учитывается, только если игрок существует
+    auto token = per_token_ && snapshots_ ? ApiHandler::TryExtractToken(req) : std::nullopt;
+    if (token && !snapshots_->Get()->FindPlayer(*token)) {
+        token.reset();
+    }
+    return Acquire(token ? &*token : nullptr, endpoint, now);
+}
+
+std::chrono::nanoseconds RateLimiter::Check(const app::Token& token, const http_server::Endpoint& endpoint,
+                                            Clock::time_point now) {
+    return Acquire(&token, endpoint, now);
+}
+
+/**
+ * Забирает по токену из корзины токена игрока, затем из корзины адреса клиента
+ * @param token токен игрока (nullptr - запрос без токена)
+ * @param endpoint адрес клиента
+ * @param now текущее время
+ * @return 0, если запрос допущен, иначе время ожидания
+ */
+std::chrono::nanoseconds RateLimiter::Acquire(const app::Token* token, const http_server::Endpoint& endpoint,
+                                              Clock::time_point now) {
+    using namespace std::chrono_literals;
+    if (per_token_ && token) {
+        if (const auto wait = per_token_->TryAcquire(app::TokenHasher{}(*token), now); wait > 0ns) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return wait;
+        }
+    }
+    if (per_ip_) {
+        if (const auto key = AddressKey(endpoint)) {
+            if (const auto wait = per_ip_->TryAcquire(*key, now); wait > 0ns) {
+                rejected_.fetch_add(1, std::memory_order_relaxed);
+                return wait;
+            }
+        }
+    }
+    return 0ns;
+}
+
+}  // namespace http_handler
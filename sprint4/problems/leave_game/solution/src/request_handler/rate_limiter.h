@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "game_snapshot.h"
+#include "make_response.h"
+#include "../app/token.h"
+#include "../http_server/http_server.h"
+#include "../util/token_bucket_table.h"
+
+namespace http_handler {
+
+/**
+ * Ограничение частоты запросов к API корзинами токенов: отдельная корзина у каждого токена игрока
+ * и у каждого IP-адреса клиента. Проверка выполняется в потоке соединения до api_strand и не блокируется.
+ * Корзина заводится только для токена игрока из опубликованного снимка игры, чтобы запросы
+ * с выдуманными токенами не занимали таблицу. Игрок, вошедший после последнего тика, до следующего тика
+ * ограничивается только по адресу
+ */
+class RateLimiter {
+public:
+    using Clock = util::TokenBucketTable::Clock;
+    using Limits = util::TokenBucketTable::Limits;
+
+    // Корзин в каждой таблице по умолчанию
+    constexpr static std::size_t DEFAULT_CAPACITY = 65'536;
+
+    struct Options {
+        // Ограничения на токен игрока и на IP-адрес (nullopt - без ограничения)
+        std::optional<Limits> per_token;
+        std::optional<Limits> per_ip;
+        std::size_t capacity = DEFAULT_CAPACITY;
+    };
+
+    explicit RateLimiter(const Options& options);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * Подключает снимки игры, по которым проверяются токены запросов. Вызывается до запуска сервера
+     * @param snapshots публикатор снимков игры (nullptr - запросы к API не ограничиваются по токену)
+     */
+    void SetSnapshotPublisher(std::shared_ptr<GameSnapshotPublisher> snapshots) {
+        snapshots_ = std::move(snapshots);
+    }
+
+    /**
+     * Забирает по токену из корзин токена игрока и адреса клиента.
+     * Адрес Unix domain socket не ограничивается
+     * @param req запрос к API
+     * @param endpoint адрес клиента
+     * @param now текущее время
+     * @return 0, если запрос допущен, иначе время, через которое его можно повторить
+     */
+    [[nodiscard]] std::chrono::nanoseconds Check(const StringRequest& req, const http_server::Endpoint& endpoint,
+                                                 Clock::time_point now = Clock::now());
+
+    /**
+     * То же для команды игрока, пришедшей не в HTTP-запросе (например, по WebSocket)
+     * @param token токен игрока, уже найденного в игре
+     * @param endpoint адрес клиента
+     * @param now текущее время
+     * @return 0, если команда допущена, иначе время, через которое её можно повторить
+     */
+    [[nodiscard]] std::chrono::nanoseconds Check(const app::Token& token, const http_server::Endpoint& endpoint,
+                                                 Clock::time_point now = Clock::now());
+
+    /// Количество отклонённых запросов
+    [[nodiscard]] std::size_t GetRejected() const noexcept {
+        return rejected_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::chrono::nanoseconds Acquire(const app::Token* token, const http_server::Endpoint& endpoint, Clock::time_point now);
+
+    std::shared_ptr<GameSnapshotPublisher> snapshots_;
+    std::optional<util::TokenBucketTable> per_token_;
+    std::optional<util::TokenBucketTable> per_ip_;
+    std::atomic<std::size_t> rejected_{0};
+};
+
+}  // namespace http_handler
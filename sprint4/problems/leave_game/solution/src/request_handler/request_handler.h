@@ -1,12 +1,23 @@
 #pragma once
 
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <atomic>
+#include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 
 #include "api_handler.h"
 #include "file_handler.h"
+#include "game_snapshot.h"
+#include "map_responses.h"
+#include "rate_limiter.h"
+#include "static_asset_index.h"
+#include "../logger/logger.h"
+#include "../tracing/tracer.h"
 
 namespace http_handler {
 namespace net = boost::asio;
@@ -14,11 +25,37 @@ class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
 
-    RequestHandler(fs::path root, Strand api_strand, app::Application& app, data_base::postgres::Database& db)
+    /**
+     * @param root каталог статических файлов
+     * @param api_strand strand, в котором выполняются запросы к API
+     * @param app приложение
+     * @param unit_factory фабрика единиц работы с базой данных
+     * @param api_queue_limit максимальное количество запросов к API, ожидающих выполнения в api_strand
+     * (0 - без ограничения). Сверх предела запросы отклоняются с кодом 503
+     * @param static_assets индекс статических файлов (nullptr - файлы всегда читаются с диска)
+     * @param game_snapshots снимки игры, из которых состояние читается без api_strand
+     * (nullptr - все запросы к игре выполняются в api_strand)
+     * @param blocking_executor исполнитель блокирующих задач, в котором выполняются запросы к базе данных
+     * (пустой - запросы к базе данных выполняются в api_strand)
+     * @param rate_limiter ограничение частоты запросов к API (nullptr - без ограничения).
+     * Сверх предела запросы отклоняются с кодом 429
+     */
+    RequestHandler(fs::path root, Strand api_strand, app::Application& app, app::UnitOfWorkFactory& unit_factory,
+                   std::size_t api_queue_limit = 0, std::shared_ptr<StaticAssetCache> static_assets = nullptr,
+                   std::shared_ptr<GameSnapshotPublisher> game_snapshots = nullptr,
+                   net::any_io_executor blocking_executor = {},
+                   std::shared_ptr<RateLimiter> rate_limiter = nullptr)
             : root_{std::move(root)}
             , api_strand_{std::move(api_strand)}
-            , app_(app),
-              db_(db) {
+            , api_handler_(app, unit_factory)
+            , records_use_cases_(unit_factory)
+            , map_responses_(app.GetMaps())
+            , action_inbox_(app.GetActionInbox()),
+              api_queue_limit_(api_queue_limit),
+              static_assets_(std::move(static_assets)),
+              game_snapshots_(std::move(game_snapshots)),
+              blocking_executor_(std::move(blocking_executor)),
+              rate_limiter_(std::move(rate_limiter)) {
         if (!std::filesystem::exists(root_)) {
             throw std::logic_error("path to static files not exist: " + root_.string());
         }
@@ -28,15 +65,59 @@ public:
     RequestHandler& operator=(const RequestHandler&) = delete;
 
     template <typename Body, typename Allocator, typename Send>
-    void operator()(const net::ip::tcp::endpoint& /* endpoint */, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+    void operator()(const http_server::Endpoint& endpoint, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
         if(ApiHandler::IsAPIRequest(req)){
-            auto handle = [self = shared_from_this(), send, handler = std::make_shared<ApiHandler>(app_, db_), req] {
+            // Частота проверяется до любой работы с игрой, в том числе до чтения снимков
+            if (rate_limiter_) {
+                if (const auto retry_after = rate_limiter_->Check(req, endpoint); retry_after > 0ns) {
+                    return send(MakeTooManyRequestsResponse(req, retry_after));
+                }
+            }
+            std::string decoded_path;
+            const auto match = ApiRouter::Match(req.target(), decoded_path);
+            // Запросы на чтение карт и состояния игры и команды движения обслуживаются в текущем потоке без api_strand
+            if (auto response = TryHandleWithoutStrand(req, match)) {
+                return std::visit(
+                        [&send](auto&& result) {
+                            send(std::move(std::forward<decltype(result)>(result)));
+                        },
+                        std::move(*response));
+            }
+            // Запрос к базе данных выполняется в пуле блокирующих задач, api_strand его не ждёт
+            if (match && match->spec->route == ApiRoute::RECORDS && blocking_executor_ != nullptr
+                    && ApiRouter::IsAllowed(match->spec->methods, req.method())) {
+                return ExecuteRecordsRequest(std::move(req), std::forward<Send>(send));
+            }
+            if (!AdmitApiRequest()) {
+                return send(MakeServiceUnavailableResponse(req));
+            }
+            // Трассировка текущего потока передаётся в api_strand вместе с запросом
+            auto* trace = tracing::CurrentTrace();
+            if (trace) {
+                trace->Stamp(tracing::Stage::STRAND_ENQUEUE);
+            }
+            // Из запросов вне тика состояние сессий меняет только вход в игру. Тик и уход игроков
+            // публикуются слушателем GameSnapshotPublisher::OnTick
+            const bool publish = game_snapshots_ && match && match->spec->route == ApiRoute::JOIN;
+            // Запрос и send перемещаются в api_strand, обработчик API общий для всех запросов
+            auto handle = [self = shared_from_this(), send = std::forward<Send>(send), req = std::move(req), trace, publish] {
                     assert(self->api_strand_.running_in_this_thread());
-                    send(std::move(handler->HandleApiRequest(req)));
+                    if (trace) {
+                        trace->Stamp(tracing::Stage::STRAND_START);
+                    }
+                    auto response = self->api_handler_.HandleApiRequest(req);
+                    // Новый игрок публикуется до отправки ответа
+                    if (publish) {
+                        self->game_snapshots_->Publish();
+                    }
+                    std::visit([&send](auto&& result) {
+                        send(std::move(std::forward<decltype(result)>(result)));
+                    }, std::move(response));
+                    --self->api_in_flight_;
             };
-            return net::dispatch(api_strand_, handle);
+            return net::dispatch(api_strand_, std::move(handle));
         }else {
-            FileHandler handler(root_);
+            FileHandler handler(root_, static_assets_ ? static_assets_->Get() : nullptr);
             return std::visit(
                     [&send](auto&& result) {
                         send(std::move(std::forward<decltype(result)>(result)));
@@ -46,11 +127,185 @@ public:
         }
     }
 
+    /// Количество запросов к API, поставленных в api_strand и ещё не выполненных
+    [[nodiscard]] std::size_t GetApiInFlight() const noexcept { return api_in_flight_.load(std::memory_order_relaxed); }
+
+    /// Количество запросов к API, отклонённых с кодом 503
+    [[nodiscard]] std::size_t GetApiRejected() const noexcept { return api_rejected_.load(std::memory_order_relaxed); }
+
 private:
+    // Время в секундах, через которое клиенту предлагается повторить отклонённый запрос
+    constexpr static std::string_view RETRY_AFTER = "1"sv;
+
+    /**
+     * Резервирует место в очереди api_strand
+     * @return false, если очередь заполнена и запрос нужно отклонить
+     */
+    bool AdmitApiRequest() {
+        if (api_queue_limit_ == 0) {
+            ++api_in_flight_;
+            return true;
+        }
+        if (const std::size_t in_flight = ++api_in_flight_; in_flight > api_queue_limit_) {
+            --api_in_flight_;
+            ++api_rejected_;
+            if (!shedding_.exchange(true)) {
+                server_logging::Logger::LogInfo(json::value{{"in_flight"s, in_flight},
+                                                            {"limit"s, api_queue_limit_}}, "api load shedding started"sv);
+            }
+            return false;
+        }
+        if (shedding_.load(std::memory_order_relaxed) && shedding_.exchange(false)) {
+            server_logging::Logger::LogInfo(json::value{{"rejected"s, api_rejected_.load()},
+                                                        {"limit"s, api_queue_limit_}}, "api load shedding stopped"sv);
+        }
+        return true;
+    }
+
+    /**
+     * Отвечает на запрос без api_strand: карты из готовых ответов, состояние игры из снимка,
+     * команды движения - постановкой в очередь команд
+     * @param req запрос к API
+     * @param match маршрут запроса
+     * @return ответ или nullopt, если запрос нужно выполнить в api_strand
+     */
+    std::optional<VariantResponse> TryHandleWithoutStrand(const StringRequest& req, const std::optional<ApiRouteMatch>& match) const {
+        if (!match || !ApiRouter::IsAllowed(match->spec->methods, req.method())) {
+            return std::nullopt;
+        }
+        switch (match->spec->route) {
+            case ApiRoute::MAPS:
+            case ApiRoute::MAP:
+                return map_responses_.Handle(req, *match);
+            case ApiRoute::STATE:
+                // Изменения состояния строятся по истории сессии в api_strand, там же отклоняется некорректная строка запроса
+                if (const auto query = ApiHandler::ParseStateQuery(match->query); !query || query->since) {
+                    return std::nullopt;
+                }
+                return ReadGameSnapshot(req, match->spec->route);
+            case ApiRoute::PLAYERS:
+                return ReadGameSnapshot(req, match->spec->route);
+            case ApiRoute::ACTION:
+                return AcceptMove(req);
+            default:
+                return std::nullopt;
+        }
+    }
+
+    /**
+     * Принимает команду движения игрока, известного по текущему снимку игры
+     * @param req запрос
+     * @return ответ или nullopt, если игрока нет в снимке (ошибку или ответ сформирует ApiHandler)
+     */
+    std::optional<VariantResponse> AcceptMove(const StringRequest& req) const {
+        if (!game_snapshots_) {
+            return std::nullopt;
+        }
+        const auto token = ApiHandler::TryExtractToken(req);
+        if (!token) {
+            return std::nullopt;
+        }
+        const auto player = game_snapshots_->Get()->FindPlayer(*token);
+        if (!player) {
+            return std::nullopt;
+        }
+        return ApiHandler::AcceptMove(req, player, action_inbox_);
+    }
+
+    /**
+     * Отвечает на запрос состояния игры или списка игроков из текущего снимка игры
+     * @param req запрос
+     * @param route ApiRoute::STATE или ApiRoute::PLAYERS
+     * @return ответ или nullopt, если игрока нет в снимке (ошибку или ответ сформирует ApiHandler)
+     */
+    std::optional<VariantResponse> ReadGameSnapshot(const StringRequest& req, ApiRoute route) const {
+        if (!game_snapshots_) {
+            return std::nullopt;
+        }
+        const auto token = ApiHandler::TryExtractToken(req);
+        if (!token) {
+            return std::nullopt;
+        }
+        const auto snapshot = game_snapshots_->Get();
+        const auto* session = snapshot->FindSession(*token);
+        if (!session) {
+            return std::nullopt;
+        }
+        if (route == ApiRoute::STATE && ApiHandler::AcceptsMsgpack(req)) {
+            auto data = session->GetStateMsgpack();
+            const std::string_view view = data->body;
+            auto response = MakeSharedTextResponse(req, http::status::ok, std::move(data), view, CacheControl::NO_CACHE,
+                                                   ContentType::APPLICATION_MSGPACK);
+            response.set(http::field::vary, "Accept"sv);
+            return response;
+        }
+        auto body = route == ApiRoute::STATE ? session->GetState() : session->GetPlayers();
+        const std::string_view text = body->body;
+        auto response = MakeSharedTextResponse(req, http::status::ok, std::move(body), text, CacheControl::NO_CACHE);
+        if (route == ApiRoute::STATE) {
+            response.set(http::field::vary, "Accept"sv);
+        }
+        return response;
+    }
+
+    /**
+     * Выполняет запрос рекордов в пуле блокирующих задач. Ответ отправляется из потока пула,
+     * send передаёт его в исполнитель сессии
+     * @param req запрос
+     * @param send функция отправки ответа
+     */
+    template <typename Request, typename Send>
+    void ExecuteRecordsRequest(Request&& req, Send&& send) {
+        auto* trace = tracing::CurrentTrace();
+        if (trace) {
+            trace->Stamp(tracing::Stage::STRAND_ENQUEUE);
+        }
+        net::post(blocking_executor_, [self = shared_from_this(), send = std::forward<Send>(send), req = std::move(req), trace] {
+            if (trace) {
+                trace->Stamp(tracing::Stage::STRAND_START);
+            }
+            std::string decoded_path;
+            const auto match = ApiRouter::Match(req.target(), decoded_path);
+            send(ApiHandler::RequestToRecords(req, match->query, self->records_use_cases_));
+        });
+    }
+
+    static StringResponse MakeServiceUnavailableResponse(const StringRequest& req) {
+        auto response = MakeTextResponse(req, http::status::service_unavailable, ErrorResponse::SERVICE_UNAVAILABLE, CacheControl::NO_CACHE);
+        response.set(http::field::retry_after, RETRY_AFTER);
+        return response;
+    }
+
+    /**
+     * Ответ 429 на запрос сверх ограничения частоты
+     * @param req запрос
+     * @param retry_after время, через которое запрос будет допущен; округляется вверх до секунд
+     */
+    static StringResponse MakeTooManyRequestsResponse(const StringRequest& req, std::chrono::nanoseconds retry_after) {
+        auto response = MakeTextResponse(req, http::status::too_many_requests, ErrorResponse::TOO_MANY_REQUESTS, CacheControl::NO_CACHE);
+        response.set(http::field::retry_after, std::to_string(std::chrono::ceil<std::chrono::seconds>(retry_after).count()));
+        return response;
+    }
+
     const fs::path root_;
     Strand api_strand_;
-    app::Application& app_;
-    data_base::postgres::Database& db_;
+    // Используется только в api_strand
+    ApiHandler api_handler_;
+    // Используется только в пуле блокирующих задач. Хранит лишь ссылку на фабрику единиц работы,
+    // а пул соединений с базой потокобезопасен, поэтому запросы рекордов выполняются параллельно
+    app::UseCasesImpl records_use_cases_;
+    const MapResponses map_responses_;
+    // Потокобезопасна, команды применяются в начале тика
+    app::ActionInbox& action_inbox_;
+    const std::size_t api_queue_limit_;
+    std::shared_ptr<StaticAssetCache> static_assets_;
+    std::shared_ptr<GameSnapshotPublisher> game_snapshots_;
+    net::any_io_executor blocking_executor_;
+    std::shared_ptr<RateLimiter> rate_limiter_;
+    std::atomic<std::size_t> api_in_flight_{0};
+    std::atomic<std::size_t> api_rejected_{0};
+    // Запросы к API отклоняются из-за перегрузки
+    std::atomic<bool> shedding_{false};
 
 };
 }  // namespace http_handler
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "session_snapshot.h"
+
+#include <array>
+
+#include "api_handler.h"
+#include "../msgpack/msgpack_model.h"
+
+namespace http_handler {
+
+namespace {
+
+/**
+ * Сериализует JSON-документ. Документ нужен только на время сериализации, поэтому собирается в буфере на стеке
+ * @param make_json функция, строящая документ в переданном ресурсе памяти
+ * @return текст документа
+ */
+template <typename MakeJson>
+std::string SerializeJson(MakeJson&& make_json) {
+    std::array<unsigned char, ApiHandler::JSON_BUFFER_SIZE> buffer;
+    json::monotonic_resource resource(buffer.data(), buffer.size());
+    return json::serialize(make_json(&resource));
+}
+
+/**
+ * Строит снимок текущей версии сессии
+ * @param session игровая сессия
+ * @param make_body функция, записывающая тело снимка в переданную пустую строку
+ * @return снимок
+ */
+template <typename MakeBody>
+std::shared_ptr<const SessionSnapshot> BuildSnapshot(const model::GameSession& session, MakeBody&& make_body) {
+    auto snapshot = std::make_shared<SessionSnapshot>();
+    snapshot->version = session.GetVersion();
+    make_body(snapshot->body);
+    return snapshot;
+}
+
+}  // namespace
+
+std::shared_ptr<const SessionSnapshot> MakeStateSnapshot(const model::GameSession& session) {
+    return BuildSnapshot(session, [&session](std::string& body) {
+        ApiHandler::WriteGameState(session, body);
+    });
+}
+
+std::shared_ptr<const SessionSnapshot> MakePlayersSnapshot(const model::GameSession& session) {
+    return BuildSnapshot(session, [&session](std::string& body) {
+        body = SerializeJson([&session](json::storage_ptr sp) {
+            return ApiHandler::MakePlayerList(session, std::move(sp));
+        });
+    });
+}
+
+std::shared_ptr<const SessionSnapshot> MakeStateMsgpackSnapshot(const model::GameSession& session) {
+    return BuildSnapshot(session, [&session](std::string& body) {
+        msgpack::EncodeGameState(session, body);
+    });
+}
+
+std::shared_ptr<const SessionSnapshot> SessionSnapshots::GetState(const model::GameSession& session) {
+    return Get(entries_[session.GetId()].state, session, MakeStateSnapshot);
+}
+
+std::shared_ptr<const SessionSnapshot> SessionSnapshots::GetPlayers(const model::GameSession& session) {
+    return Get(entries_[session.GetId()].players, session, MakePlayersSnapshot);
+}
+
+std::shared_ptr<const SessionSnapshot> SessionSnapshots::GetStateMsgpack(const model::GameSession& session) {
+    return Get(entries_[session.GetId()].state_msgpack, session, MakeStateMsgpackSnapshot);
+}
+
+/**
+ * Возвращает снимок текущей версии сессии, при необходимости перестраивая его
+ * @param snapshot закэшированный снимок
+ * @param session игровая сессия
+ * @param make_snapshot функция, строящая снимок текущей версии сессии
+ * @return актуальный снимок
+ */
+template <typename MakeSnapshot>
+std::shared_ptr<const SessionSnapshot> SessionSnapshots::Get(std::shared_ptr<const SessionSnapshot>& snapshot,
+                                                             const model::GameSession& session, MakeSnapshot&& make_snapshot) {
+    if (snapshot && snapshot->version == session.GetVersion()) {
+        return snapshot;
+    }
+    snapshot = make_snapshot(session);
+    ++built_;
+    return snapshot;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "../model/game_session.h"
+
+namespace http_handler {
+
+/**
+ * Сериализованное представление игровой сессии, построенное для одной версии её состояния
+ */
+struct SessionSnapshot {
+    std::uint64_t version = 0;
+    std::string body;
+};
+
+/**
+ * Строит снимок тела ответа /api/v1/game/state для текущей версии сессии
+ * @param session игровая сессия
+ * @return снимок
+ */
+std::shared_ptr<const SessionSnapshot> MakeStateSnapshot(const model::GameSession& session);
+
+/**
+ * Строит снимок тела ответа /api/v1/game/players для текущей версии сессии
+ * @param session игровая сессия
+ * @return снимок
+ */
+std::shared_ptr<const SessionSnapshot> MakePlayersSnapshot(const model::GameSession& session);
+
+/**
+ * Строит снимок тела ответа /api/v1/game/state в формате MessagePack для текущей версии сессии
+ * @param session игровая сессия
+ * @return снимок
+ */
+std::shared_ptr<const SessionSnapshot> MakeStateMsgpackSnapshot(const model::GameSession& session);
+
+/**
+ * Снимки состояния игровых сессий. Снимок строится при первом запросе после изменения сессии
+ * и используется всеми запросами до следующего изменения, так что сериализация выполняется
+ * не чаще одного раза за версию сессии, сколько бы игроков её ни запрашивали.
+ * Не потокобезопасен: используется в api_strand вместе с изменениями сессий
+ */
+class SessionSnapshots {
+public:
+    /**
+     * Возвращает тело ответа /api/v1/game/state для текущей версии сессии
+     * @param session игровая сессия
+     * @return снимок, тело которого можно отправлять без копирования
+     */
+    std::shared_ptr<const SessionSnapshot> GetState(const model::GameSession& session);
+
+    /**
+     * Возвращает тело ответа /api/v1/game/players для текущей версии сессии
+     * @param session игровая сессия
+     * @return снимок, тело которого можно отправлять без копирования
+     */
+    std::shared_ptr<const SessionSnapshot> GetPlayers(const model::GameSession& session);
+
+    /**
+     * Возвращает тело ответа /api/v1/game/state в формате MessagePack для текущей версии сессии
+     * @param session игровая сессия
+     * @return снимок, тело которого можно отправлять без копирования
+     */
+    std::shared_ptr<const SessionSnapshot> GetStateMsgpack(const model::GameSession& session);
+
+    /// Количество построенных снимков
+    [[nodiscard]] std::size_t GetBuilt() const noexcept { return built_; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const SessionSnapshot> state;
+        std::shared_ptr<const SessionSnapshot> players;
+        std::shared_ptr<const SessionSnapshot> state_msgpack;
+    };
+
+    template <typename MakeSnapshot>
+    std::shared_ptr<const SessionSnapshot> Get(std::shared_ptr<const SessionSnapshot>& snapshot,
+                                               const model::GameSession& session, MakeSnapshot&& make_snapshot);
+
+    std::unordered_map<model::GameSession::Id, Entry, model::GameSession::IdHasher> entries_;
+    std::size_t built_ = 0;
+};
+
+}  // namespace http_handler
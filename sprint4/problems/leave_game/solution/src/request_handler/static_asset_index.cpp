@@ -0,0 +1,262 @@
+#include "static_asset_index.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "content_type.h"
+#include "http_range.h"
+#include "../util/util.h"
+
+namespace http_handler {
+namespace {
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+/**
+ * Сжимает данные алгоритмом deflate
+ * @param data исходные данные
+ * @param window_bits 15 + 16 - формат gzip, 15 - формат zlib (HTTP deflate)
+ * @return сжатые данные или пустая строка, если сжатие не уменьшило размер
+ */
+std::string Compress(std::string_view data, int window_bits) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, window_bits, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return {};
+    }
+    std::string result(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(result.data());
+    stream.avail_out = static_cast<uInt>(result.size());
+    const int status = deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END || result.size() >= data.size()) {
+        return {};
+    }
+    return result;
+}
+
+// Хеш FNV-1a содержимого файла
+std::string MakeETag(std::string_view data) {
+    constexpr std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+    constexpr std::string_view HEX = "0123456789abcdef";
+
+    std::uint64_t hash = FNV_OFFSET_BASIS;
+    for (const char c : data) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+
+    std::string etag = "\"";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        etag.push_back(HEX[(hash >> shift) & 0xF]);
+    }
+    etag += '-' + std::to_string(data.size()) + '"';
+    return etag;
+}
+
+std::string_view GetContentType(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    const auto it = ContentType::EXTENSION.find(extension);
+    return it != ContentType::EXTENSION.end() ? it->second : ContentType::UNKNOWN;
+}
+
+std::string_view Trim(std::string_view str) {
+    const auto begin = str.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    const auto end = str.find_last_not_of(" \t");
+    return str.substr(begin, end - begin + 1);
+}
+
+/**
+ * Вызывает action для каждого элемента списка, разделённого запятыми
+ */
+template <typename Action>
+void ForEachListItem(std::string_view list, Action&& action) {
+    while (!list.empty()) {
+        const auto comma = list.find(',');
+        const auto item = Trim(list.substr(0, comma));
+        if (!item.empty() && action(item)) {
+            return;
+        }
+        list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+    }
+}
+
+bool IEquals(std::string_view lhs, std::string_view rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                      [](unsigned char l, unsigned char r) { return std::tolower(l) == std::tolower(r); });
+}
+
+}  // namespace
+
+std::string_view StaticAssetIndex::Asset::GetContent(ContentEncoding encoding) const noexcept {
+    switch (encoding) {
+        case ContentEncoding::GZIP:
+            return gzip;
+        case ContentEncoding::DEFLATE:
+            return deflate;
+        case ContentEncoding::IDENTITY:
+            break;
+    }
+    return content;
+}
+
+std::string_view StaticAssetIndex::Asset::GetETag(ContentEncoding encoding) const noexcept {
+    switch (encoding) {
+        case ContentEncoding::GZIP:
+            return gzip_etag;
+        case ContentEncoding::DEFLATE:
+            return deflate_etag;
+        case ContentEncoding::IDENTITY:
+            break;
+    }
+    return etag;
+}
+
+std::shared_ptr<const StaticAssetIndex> StaticAssetIndex::Build(const fs::path& root) {
+    auto index = std::make_shared<StaticAssetIndex>();
+    for (const auto& entry : fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied)) {
+        if (!entry.is_regular_file() || entry.file_size() > MAX_CACHED_FILE_SIZE) {
+            continue;
+        }
+        // Символическая ссылка может указывать за пределы каталога статических файлов
+        if (entry.is_symlink() && !util::IsSubPath(entry.path(), root)) {
+            continue;
+        }
+        auto asset = MakeAsset(ReadFile(entry.path()), GetContentType(entry.path()));
+        asset->last_modified = ToTimeT(entry.last_write_time());
+        asset->last_modified_date = FormatHttpDate(asset->last_modified);
+
+        index->assets_.emplace("/" + fs::relative(entry.path(), root).generic_string(), std::move(asset));
+    }
+    return index;
+}
+
+std::shared_ptr<StaticAssetIndex::Asset> StaticAssetIndex::MakeAsset(std::string content, std::string_view content_type) {
+    auto asset = std::make_shared<Asset>();
+    asset->content = std::move(content);
+    asset->gzip = Compress(asset->content, 15 + 16);
+    asset->deflate = Compress(asset->content, 15);
+    asset->content_type = content_type;
+    asset->etag = MakeETag(asset->content);
+    // Суффикс варианта добавляется внутрь кавычек
+    asset->gzip_etag = asset->etag.substr(0, asset->etag.size() - 1) + "-gzip\"";
+    asset->deflate_etag = asset->etag.substr(0, asset->etag.size() - 1) + "-deflate\"";
+    return asset;
+}
+
+std::shared_ptr<const StaticAssetIndex::Asset> StaticAssetIndex::Find(std::string_view path) const {
+    const auto it = assets_.find(path);
+    return it != assets_.end() ? it->second : nullptr;
+}
+
+StaticAssetCache::StaticAssetCache(fs::path root)
+    : root_(std::move(root))
+    , index_(StaticAssetIndex::Build(root_)) {
+}
+
+void StaticAssetCache::Rebuild() {
+    index_.Store(StaticAssetIndex::Build(root_));
+}
+
+ContentEncoding SelectContentEncoding(std::string_view accept_encoding) {
+    bool gzip = false;
+    bool deflate = false;
+    ForEachListItem(accept_encoding, [&gzip, &deflate](std::string_view item) {
+        const auto semicolon = item.find(';');
+        const auto coding = Trim(item.substr(0, semicolon));
+        // Кодирование с весом q=0 клиент не принимает
+        if (semicolon != std::string_view::npos) {
+            const auto params = Trim(item.substr(semicolon + 1));
+            if (params.size() >= 3 && IEquals(params.substr(0, 2), "q=")
+                && params.find_first_not_of("0.", 2) == std::string_view::npos) {
+                return false;
+            }
+        }
+        if (IEquals(coding, "gzip") || coding == "*") {
+            gzip = true;
+        } else if (IEquals(coding, "deflate")) {
+            deflate = true;
+        }
+        return false;
+    });
+    if (gzip) {
+        return ContentEncoding::GZIP;
+    }
+    return deflate ? ContentEncoding::DEFLATE : ContentEncoding::IDENTITY;
+}
+
+MediaTypeQuality GetMediaTypeQuality(std::string_view accept, std::string_view media_type) {
+    const auto slash = media_type.find('/');
+    const auto type = media_type.substr(0, slash);
+    MediaTypeQuality result;
+    int best_specificity = -1;
+    ForEachListItem(accept, [&](std::string_view item) {
+        const auto semicolon = item.find(';');
+        const auto range = Trim(item.substr(0, semicolon));
+        int specificity = -1;
+        if (IEquals(range, media_type)) {
+            specificity = 2;
+        } else if (range.size() == type.size() + 2 && IEquals(range.substr(0, type.size()), type) && range.ends_with("/*")) {
+            specificity = 1;
+        } else if (range == "*/*") {
+            specificity = 0;
+        }
+        if (specificity <= best_specificity) {
+            return false;
+        }
+        double quality = 1.0;
+        auto params = semicolon == std::string_view::npos ? std::string_view{} : item.substr(semicolon + 1);
+        while (!params.empty()) {
+            const auto next = params.find(';');
+            const auto param = Trim(params.substr(0, next));
+            if (param.size() > 2 && IEquals(param.substr(0, 2), "q=")) {
+                // Некорректный вес считается нулевым: такой диапазон не выбирается
+                const auto value = param.substr(2);
+                if (std::from_chars(value.data(), value.data() + value.size(), quality).ec != std::errc{}
+                    || quality < 0.0 || quality > 1.0) {
+                    quality = 0.0;
+                }
+            }
+            params = next == std::string_view::npos ? std::string_view{} : params.substr(next + 1);
+        }
+        best_specificity = specificity;
+        result = {quality, specificity == 2};
+        return false;
+    });
+    return result;
+}
+
+bool IfNoneMatch(std::string_view if_none_match, std::string_view etag) {
+    bool match = false;
+    ForEachListItem(if_none_match, [etag, &match](std::string_view item) {
+        if (item.starts_with("W/")) {
+            item.remove_prefix(2);
+        }
+        match = item == "*" || item == etag;
+        return match;
+    });
+    return match;
+}
+
+}  // namespace http_handler
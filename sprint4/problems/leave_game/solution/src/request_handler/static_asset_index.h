@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../util/atomic_shared_ptr.h"
+
+namespace http_handler {
+namespace fs = std::filesystem;
+
+/**
+ * Кодирование содержимого (Content-Encoding)
+ */
+enum class ContentEncoding {
+    IDENTITY,
+    GZIP,
+    DEFLATE
+};
+
+/**
+ * Неизменяемый индекс статических файлов, построенный при запуске сервера.
+ * Хранит содержимое файлов, MIME-тип, ETag и заранее сжатые варианты,
+ * так что ответ на запрос статики формируется без обращений к файловой системе
+ */
+class StaticAssetIndex {
+public:
+    // Файлы больше этого размера не кэшируются и отдаются с диска
+    constexpr static std::uintmax_t MAX_CACHED_FILE_SIZE = 16 * 1024 * 1024;
+
+    struct Asset {
+        std::string content;
+        // Сжатые варианты. Пустые, если сжатие не уменьшает размер
+        std::string gzip;
+        std::string deflate;
+        std::string_view content_type;
+        // Сильные ETag в кавычках, вычисленные по содержимому. У каждого варианта свой ETag
+        std::string etag;
+        std::string gzip_etag;
+        std::string deflate_etag;
+        // Время изменения файла и оно же в формате заголовка Last-Modified
+        std::time_t last_modified = 0;
+        std::string last_modified_date;
+
+        /**
+         * Возвращает содержимое в запрошенном кодировании
+         * @param encoding кодирование
+         * @return содержимое или пустая строка, если такого варианта нет
+         */
+        [[nodiscard]] std::string_view GetContent(ContentEncoding encoding) const noexcept;
+
+        [[nodiscard]] std::string_view GetETag(ContentEncoding encoding) const noexcept;
+
+        // Есть ли сжатые варианты (ответ зависит от Accept-Encoding)
+        [[nodiscard]] bool HasEncodings() const noexcept { return !gzip.empty() || !deflate.empty(); }
+    };
+
+    /**
+     * Строит индекс всех файлов каталога root (рекурсивно). Символические ссылки на файлы вне root пропускаются
+     * @param root каталог статических файлов
+     * @return индекс
+     */
+    static std::shared_ptr<const StaticAssetIndex> Build(const fs::path& root);
+
+    /**
+     * Создаёт элемент индекса из содержимого в памяти: сжимает его и вычисляет ETag вариантов
+     * @param content содержимое
+     * @param content_type MIME-тип
+     * @return элемент без времени изменения
+     */
+    static std::shared_ptr<Asset> MakeAsset(std::string content, std::string_view content_type);
+
+    /**
+     * Ищет файл по пути запроса
+     * @param path декодированный путь запроса, начинающийся с '/'
+     * @return файл или nullptr, если его нет в индексе
+     */
+    [[nodiscard]] std::shared_ptr<const Asset> Find(std::string_view path) const;
+
+    [[nodiscard]] std::size_t Size() const noexcept { return assets_.size(); }
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    std::unordered_map<std::string, std::shared_ptr<const Asset>, StringHash, std::equal_to<>> assets_;
+};
+
+/**
+ * Текущий индекс статических файлов. Индекс можно перестроить (например, при изменении файлов),
+ * при этом обрабатываемые запросы продолжают пользоваться прежней версией
+ */
+class StaticAssetCache {
+public:
+    explicit StaticAssetCache(fs::path root);
+
+    StaticAssetCache(const StaticAssetCache&) = delete;
+    StaticAssetCache& operator=(const StaticAssetCache&) = delete;
+
+    [[nodiscard]] std::shared_ptr<const StaticAssetIndex> Get() const noexcept {
+        return index_.Load();
+    }
+
+    // Перечитывает каталог и публикует новый индекс
+    void Rebuild();
+
+    [[nodiscard]] const fs::path& GetRoot() const noexcept { return root_; }
+
+private:
+    const fs::path root_;
+    util::AtomicSharedPtr<const StaticAssetIndex> index_;
+};
+
+/**
+ * Выбирает кодирование ответа по заголовку Accept-Encoding
+ * @param accept_encoding значение заголовка
+ * @return GZIP или DEFLATE, если клиент их принимает, иначе IDENTITY
+ */
+ContentEncoding SelectContentEncoding(std::string_view accept_encoding);
+
+/**
+ * Вес формата в заголовке Accept
+ */
+struct MediaTypeQuality {
+    // Вес q самого точного подходящего диапазона (0, если формат не принимается)
+    double quality = 0.0;
+    // Формат указан явно (тип/подтип), а не диапазоном тип/* или */*
+    bool exact = false;
+};
+
+/**
+ * Определяет вес формата по заголовку Accept (RFC 9110, 12.5.1): из подходящих диапазонов
+ * берётся самый точный - сам формат, затем все подтипы его типа, затем все форматы
+ * @param accept значение заголовка
+ * @param media_type формат вида "application/json"
+ * @return вес формата
+ */
+MediaTypeQuality GetMediaTypeQuality(std::string_view accept, std::string_view media_type);
+
+/**
+ * Проверяет, совпадает ли ETag с одним из перечисленных в If-None-Match (слабое сравнение)
+ * @param if_none_match значение заголовка
+ * @param etag ETag в кавычках
+ * @return true, если совпадает
+ */
+bool IfNoneMatch(std::string_view if_none_match, std::string_view etag);
+
+}  // namespace http_handler
@@ -0,0 +1,127 @@
+#include "static_asset_watcher.h"
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/json.hpp>
+
+#include <sys/inotify.h>
+
+#include <chrono>
+#include <system_error>
+
+#include "../logger/logger.h"
+
+namespace http_handler {
+using namespace std::literals;
+
+namespace {
+constexpr auto REBUILD_DELAY = 200ms;
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+int CreateInotify() {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "inotify_init1");
+    }
+    return fd;
+}
+}  // namespace
+
+StaticAssetWatcher::StaticAssetWatcher(net::io_context& ioc, std::shared_ptr<StaticAssetCache> cache,
+                                       net::any_io_executor blocking_executor)
+    : strand_(net::make_strand(ioc))
+    , descriptor_(strand_, CreateInotify())
+    , timer_(strand_)
+    , cache_(std::move(cache))
+    , blocking_executor_(std::move(blocking_executor)) {
+}
+
+void StaticAssetWatcher::Start() {
+    net::dispatch(strand_, [self = shared_from_this()] {
+        self->AddWatches();
+        self->Read();
+    });
+}
+
+void StaticAssetWatcher::AddWatches() {
+    const auto add_watch = [this](const fs::path& dir) {
+        if (inotify_add_watch(descriptor_.native_handle(), dir.c_str(), WATCH_MASK) < 0) {
+            server_logging::Logger::LogError(sys::error_code{errno, sys::system_category()}, "inotify_add_watch"sv);
+        }
+    };
+    add_watch(cache_->GetRoot());
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(cache_->GetRoot(), fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (it->is_directory()) {
+            add_watch(it->path());
+        }
+    }
+}
+
+void StaticAssetWatcher::Read() {
+    descriptor_.async_read_some(net::buffer(buffer_),
+                                [self = shared_from_this()](sys::error_code ec, std::size_t bytes_read) {
+                                    self->OnRead(ec, bytes_read);
+                                });
+}
+
+void StaticAssetWatcher::OnRead(sys::error_code ec, std::size_t /*bytes_read*/) {
+    if (ec == net::error::operation_aborted) {
+        return;
+    }
+    if (ec) {
+        return server_logging::Logger::LogError(ec, "inotify read"sv);
+    }
+    // Содержимое событий не важно: любое изменение приводит к перестроению индекса
+    ScheduleRebuild();
+    Read();
+}
+
+void StaticAssetWatcher::ScheduleRebuild() {
+    if (rebuild_scheduled_) {
+        return;
+    }
+    rebuild_scheduled_ = true;
+    timer_.expires_after(REBUILD_DELAY);
+    timer_.async_wait([self = shared_from_this()](sys::error_code ec) {
+        self->rebuild_scheduled_ = false;
+        if (!ec) {
+            self->Rebuild();
+        }
+    });
+}
+
+void StaticAssetWatcher::Rebuild() {
+    if (rebuild_running_) {
+        // Изменения попадут в индекс следующим перестроением
+        rebuild_again_ = true;
+        return;
+    }
+    rebuild_running_ = true;
+    net::post(blocking_executor_, [self = shared_from_this()] {
+        try {
+            // Новый индекс публикуется атомарно, запросы до этого момента обслуживаются прежним
+            self->cache_->Rebuild();
+            // В индекс могли добавиться новые каталоги
+            self->AddWatches();
+            server_logging::Logger::LogInfo(boost::json::value{{"assets"s, self->cache_->Get()->Size()}}, "static assets reloaded"sv);
+        } catch (const std::exception& ex) {
+            // Прежний индекс остаётся в силе
+            server_logging::Logger::LogInfo(boost::json::value{{"exception"s, ex.what()}}, "static assets reload failed"sv);
+        }
+        net::dispatch(self->strand_, [self] {
+            self->OnRebuilt();
+        });
+    });
+}
+
+void StaticAssetWatcher::OnRebuilt() {
+    rebuild_running_ = false;
+    if (rebuild_again_) {
+        rebuild_again_ = false;
+        ScheduleRebuild();
+    }
+}
+
+}  // namespace http_handler
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <array>
+#include <memory>
+
+#include "static_asset_index.h"
+
+namespace http_handler {
+namespace net = boost::asio;
+namespace sys = boost::system;
+
+/**
+ * Следит за каталогом статических файлов через inotify и перестраивает индекс
+ * после изменений. Изменения, пришедшие в течение короткого интервала, объединяются
+ * в одно перестроение. Индекс строится в пуле блокирующих задач, чтобы чтение и сжатие файлов
+ * не занимали потоки, обслуживающие соединения
+ */
+class StaticAssetWatcher : public std::enable_shared_from_this<StaticAssetWatcher> {
+public:
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    /**
+     * @param ioc контекст, в котором читаются события inotify
+     * @param cache индекс статических файлов
+     * @param blocking_executor исполнитель блокирующих задач, в котором строится новый индекс
+     */
+    StaticAssetWatcher(net::io_context& ioc, std::shared_ptr<StaticAssetCache> cache, net::any_io_executor blocking_executor);
+
+    StaticAssetWatcher(const StaticAssetWatcher&) = delete;
+    StaticAssetWatcher& operator=(const StaticAssetWatcher&) = delete;
+
+    void Start();
+
+private:
+    // Подписывается на изменения каталога и всех вложенных каталогов (inotify не рекурсивен).
+    // Обращается только к дескриптору inotify, поэтому вызывается и в пуле блокирующих задач
+    void AddWatches();
+    void Read();
+    void OnRead(sys::error_code ec, std::size_t bytes_read);
+    void ScheduleRebuild();
+    void Rebuild();
+    void OnRebuilt();
+
+    Strand strand_;
+    net::posix::stream_descriptor descriptor_;
+    net::steady_timer timer_;
+    std::shared_ptr<StaticAssetCache> cache_;
+    net::any_io_executor blocking_executor_;
+    std::array<char, 4096> buffer_{};
+    bool rebuild_scheduled_ = false;
+    // Индекс строится в пуле блокирующих задач
+    bool rebuild_running_ = false;
+    // Во время перестроения пришли новые изменения
+    bool rebuild_again_ = false;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <boost/beast/http.hpp>
+#include <boost/json.hpp>
+
+#include <memory>
+#include <utility>
+
+#include "api_handler.h"
+#include "make_response.h"
+#include "../http_server/http_server.h"
+#include "../tracing/tracer.h"
+
+namespace http_handler {
+
+/**
+ * Декоратор обработчика запросов: отдаёт последние трассировки запросов на GET /admin/traces
+ * массивом JSON от старых к новым. Если трассировка выключена, все запросы передаются обработчику
+ */
+template <class Handler>
+class TraceRequestHandler {
+public:
+    TraceRequestHandler(Handler& handler, std::shared_ptr<tracing::Tracer> tracer)
+        : decorated_(handler), tracer_(std::move(tracer)) {
+    }
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(const http_server::Endpoint& endpoint, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        if (tracer_ && req.target() == EndPoint::TRACES) {
+            return send(MakeTracesResponse(req));
+        }
+        decorated_(endpoint, std::move(req), std::forward<Send>(send));
+    }
+
+private:
+    StringResponse MakeTracesResponse(const StringRequest& req) const {
+        if (req.method() != http::verb::get && req.method() != http::verb::head) {
+            return MakeTextResponse(req, http::status::method_not_allowed, ErrorResponse::INVALID_GET,
+                                    CacheControl::NO_CACHE, Api::GET_HEAD);
+        }
+        return MakeTextResponse(req, http::status::ok, boost::json::serialize(tracer_->GetRecent()), CacheControl::NO_CACHE);
+    }
+
+    Handler& decorated_;
+    std::shared_ptr<tracing::Tracer> tracer_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,99 @@
+#include "tracer.h"
+
+#include "../logger/logger.h"
+
+namespace tracing {
+
+using namespace std::literals;
+
+namespace {
+
+thread_local RequestTrace* current_trace = nullptr;
+
+}  // namespace
+
+boost::json::object RequestTrace::ToJson() const {
+    boost::json::object obj;
+    obj["id"sv] = id_;
+    obj["method"sv] = method_;
+    obj["target"sv] = target_;
+    obj["status"sv] = status_;
+
+    auto add_duration = [this, &obj](std::string_view name, Stage from, Stage to) {
+        const auto start = GetStamp(from);
+        const auto end = GetStamp(to);
+        if (start && end) {
+            obj[name] = std::chrono::duration_cast<std::chrono::nanoseconds>(*end - *start).count();
+        }
+    };
+    // Запрос, выполненный в потоке сессии, не проходит через очередь исполнителя
+    const Stage handler_start = GetStamp(Stage::STRAND_START) ? Stage::STRAND_START : Stage::READ_COMPLETE;
+    add_duration("routing_ns"sv, Stage::READ_COMPLETE, Stage::STRAND_ENQUEUE);
+    add_duration("queue_ns"sv, Stage::STRAND_ENQUEUE, Stage::STRAND_START);
+    add_duration("handler_ns"sv, handler_start, Stage::HANDLER_END);
+    add_duration("write_ns"sv, Stage::HANDLER_END, Stage::WRITE_COMPLETE);
+    add_duration("total_ns"sv, Stage::READ_COMPLETE, Stage::WRITE_COMPLETE);
+    return obj;
+}
+
+Tracer::Tracer(TracerOptions options) : options_(options) {
+    recent_.reserve(options_.buffer_size);
+}
+
+std::unique_ptr<RequestTrace> Tracer::Start(std::string_view method, std::string_view target) {
+    // Счётчик потока, а не общий атомарный: выборка не добавляет обращений к общей строке кэша
+    thread_local std::uint32_t skipped = 0;
+    if (options_.sample_period == 0 || ++skipped < options_.sample_period) {
+        return nullptr;
+    }
+    skipped = 0;
+    auto trace = std::make_unique<RequestTrace>(next_id_.fetch_add(1, std::memory_order_relaxed), method, target);
+    trace->Stamp(Stage::READ_COMPLETE);
+    return trace;
+}
+
+void Tracer::Finish(std::unique_ptr<RequestTrace> trace) {
+    if (!trace) {
+        return;
+    }
+    auto span = trace->ToJson();
+    if (options_.log) {
+        server_logging::Logger::LogInfo(span, "request trace"sv);
+    }
+    if (options_.buffer_size == 0) {
+        return;
+    }
+    std::lock_guard lock{mutex_};
+    if (recent_.size() < options_.buffer_size) {
+        recent_.push_back(std::move(span));
+    } else {
+        recent_[next_] = std::move(span);
+    }
+    next_ = (next_ + 1) % options_.buffer_size;
+}
+
+boost::json::array Tracer::GetRecent() const {
+    boost::json::array result;
+    std::lock_guard lock{mutex_};
+    result.reserve(recent_.size());
+    // Пока буфер не заполнен, next_ совпадает с его размером и самая старая запись - первая
+    const std::size_t oldest = recent_.size() < options_.buffer_size ? 0 : next_;
+    for (std::size_t i = 0; i < recent_.size(); ++i) {
+        result.push_back(recent_[(oldest + i) % recent_.size()]);
+    }
+    return result;
+}
+
+RequestTrace* CurrentTrace() noexcept {
+    return current_trace;
+}
+
+ScopedTrace::ScopedTrace(RequestTrace* trace) noexcept : previous_(current_trace) {
+    current_trace = trace;
+}
+
+ScopedTrace::~ScopedTrace() {
+    current_trace = previous_;
+}
+
+}  // namespace tracing
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <boost/json.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tracing {
+
+/**
+ * Отметки времени запроса в порядке прохождения. STRAND_ENQUEUE и STRAND_START ставятся, только если
+ * запрос выполнялся в другом исполнителе (api_strand или пул блокирующих задач)
+ */
+enum class Stage : std::uint8_t {
+    READ_COMPLETE,   // Сессия прочитала запрос
+    STRAND_ENQUEUE,  // Запрос поставлен в очередь исполнителя
+    STRAND_START,    // Исполнитель начал выполнять запрос
+    HANDLER_END,     // Обработчик передал ответ сессии
+    WRITE_COMPLETE   // Ответ записан в сокет
+};
+
+constexpr std::size_t STAGES = 5;
+
+/**
+ * Трассировка одного запроса. Отметки ставятся последовательно из разных потоков:
+ * переходы между исполнителями Asio упорядочивают записи, поэтому синхронизация не нужна
+ */
+class RequestTrace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    RequestTrace(std::uint64_t id, std::string_view method, std::string_view target)
+        : id_(id), method_(method), target_(target) {
+    }
+
+    void Stamp(Stage stage) noexcept {
+        stamps_[static_cast<std::size_t>(stage)] = Clock::now();
+    }
+
+    void SetStatus(unsigned status) noexcept {
+        status_ = status;
+    }
+
+    [[nodiscard]] std::uint64_t GetId() const noexcept { return id_; }
+    [[nodiscard]] const std::string& GetMethod() const noexcept { return method_; }
+    [[nodiscard]] const std::string& GetTarget() const noexcept { return target_; }
+    [[nodiscard]] unsigned GetStatus() const noexcept { return status_; }
+
+    /**
+     * @param stage отметка
+     * @return время отметки или nullopt, если запрос её не проходил
+     */
+    [[nodiscard]] std::optional<Clock::time_point> GetStamp(Stage stage) const noexcept {
+        const auto& stamp = stamps_[static_cast<std::size_t>(stage)];
+        return stamp == Clock::time_point{} ? std::nullopt : std::optional{stamp};
+    }
+
+    /**
+     * Длительности участков запроса в наносекундах: до очереди исполнителя (routing), ожидание в очереди (queue),
+     * обработка (handler), запись ответа (write) и всё время от чтения запроса до записи ответа (total).
+     * Участки без отметок не записываются
+     * @return объект JSON с id, методом, адресом и кодом ответа запроса и длительностями участков
+     */
+    [[nodiscard]] boost::json::object ToJson() const;
+
+private:
+    std::uint64_t id_;
+    std::string method_;
+    std::string target_;
+    unsigned status_ = 0;
+    std::array<Clock::time_point, STAGES> stamps_{};
+};
+
+/**
+ * Параметры трассировки
+ */
+struct TracerOptions {
+    // Трассируется каждый sample_period-й запрос потока (0 - трассировка выключена, 1 - все запросы)
+    std::uint32_t sample_period = 0;
+    // Сколько последних трассировок хранится для выдачи через GetRecent
+    std::size_t buffer_size = 1024;
+    // Записывать каждую завершённую трассировку в журнал
+    bool log = false;
+};
+
+/**
+ * Выбирает запросы для трассировки и собирает завершённые трассировки в кольцевой буфер.
+ * Для невыбранных запросов стоимость трассировки - одно сравнение счётчика потока
+ */
+class Tracer {
+public:
+    explicit Tracer(TracerOptions options);
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * Начинает трассировку запроса, если он попал в выборку, и ставит отметку READ_COMPLETE
+     * @param method метод запроса
+     * @param target request-target запроса
+     * @return трассировка или nullptr
+     */
+    [[nodiscard]] std::unique_ptr<RequestTrace> Start(std::string_view method, std::string_view target);
+
+    /**
+     * Завершает трассировку: сохраняет её в буфере и, если включено, пишет в журнал
+     * @param trace трассировка с отметкой WRITE_COMPLETE
+     */
+    void Finish(std::unique_ptr<RequestTrace> trace);
+
+    /**
+     * @return последние завершённые трассировки, от старых к новым, в виде массива JSON
+     */
+    [[nodiscard]] boost::json::array GetRecent() const;
+
+private:
+    const TracerOptions options_;
+    std::atomic<std::uint64_t> next_id_{1};
+    mutable std::mutex mutex_;
+    // Кольцевой буфер завершённых трассировок, next_ - место следующей записи
+    std::vector<boost::json::object> recent_;
+    std::size_t next_ = 0;
+};
+
+/**
+ * Трассировка запроса, который обрабатывается в текущем потоке (nullptr - запрос не трассируется).
+ * Обработчики читают её до перехода в другой исполнитель и передают туда сами
+ */
+RequestTrace* CurrentTrace() noexcept;
+
+/**
+ * Делает трассировку текущей на время вызова обработчика запроса
+ */
+class ScopedTrace {
+public:
+    explicit ScopedTrace(RequestTrace* trace) noexcept;
+    ~ScopedTrace();
+
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    RequestTrace* previous_;
+};
+
+}  // namespace tracing
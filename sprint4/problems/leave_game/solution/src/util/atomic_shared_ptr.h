@@ -0,0 +1,37 @@
+#pragma once
+#include <memory>
+
+namespace util {
+
+/**
+ * Указатель shared_ptr, который можно читать и заменять из разных потоков.
+ * Читатели получают копию указателя и работают с неизменяемым объектом,
+ * писатель публикует новый объект целиком (RCU).
+ *
+ * std::atomic<std::shared_ptr<T>> появился в libstdc++ только в GCC 12,
+ * а сборка ведётся GCC 11, поэтому используются атомарные функции для shared_ptr
+ */
+template <typename T>
+class AtomicSharedPtr {
+public:
+    AtomicSharedPtr() = default;
+    explicit AtomicSharedPtr(std::shared_ptr<T> ptr) noexcept
+        : ptr_(std::move(ptr)) {
+    }
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    [[nodiscard]] std::shared_ptr<T> Load() const noexcept {
+        return std::atomic_load_explicit(&ptr_, std::memory_order_acquire);
+    }
+
+    void Store(std::shared_ptr<T> ptr) noexcept {
+        std::atomic_store_explicit(&ptr_, std::move(ptr), std::memory_order_release);
+    }
+
+private:
+    std::shared_ptr<T> ptr_;
+};
+
+}  // namespace util
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+/**
+ * Хеш-таблица с открытой адресацией и линейным пробированием.
+ * Элементы хранятся подряд в одном массиве, без отдельного узла в куче на каждый элемент.
+ * Ключ Key{} зарезервирован под пустую ячейку и не может быть добавлен в таблицу.
+ * Удаление сдвигает следующие элементы цепочки назад, поэтому таблица не накапливает "надгробий".
+ * Итераторы и указатели на элементы становятся недействительными при вставке и удалении
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap {
+public:
+    struct Entry {
+        Key first{};
+        Value second{};
+    };
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const Entry*, Entry*>;
+        using reference = std::conditional_t<Const, const Entry&, Entry&>;
+
+        Iterator() = default;
+
+        Iterator(pointer entry, pointer end) noexcept
+            : entry_(entry), end_(end) {
+            SkipEmpty();
+        }
+
+        // Неконстантный итератор приводится к константному
+        operator Iterator<true>() const noexcept {
+            return {entry_, end_};
+        }
+
+        reference operator*() const noexcept { return *entry_; }
+        pointer operator->() const noexcept { return entry_; }
+
+        Iterator& operator++() noexcept {
+            ++entry_;
+            SkipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const Iterator& other) const noexcept = default;
+
+    private:
+        void SkipEmpty() noexcept {
+            while (entry_ != end_ && IsEmpty(*entry_)) {
+                ++entry_;
+            }
+        }
+
+        pointer entry_ = nullptr;
+        pointer end_ = nullptr;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+    [[nodiscard]] std::size_t capacity() const noexcept { return entries_.size(); }
+
+    iterator begin() noexcept { return {entries_.data(), entries_.data() + entries_.size()}; }
+    iterator end() noexcept { return {entries_.data() + entries_.size(), entries_.data() + entries_.size()}; }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator end() const noexcept { return cend(); }
+    const_iterator cbegin() const noexcept { return {entries_.data(), entries_.data() + entries_.size()}; }
+    const_iterator cend() const noexcept { return {entries_.data() + entries_.size(), entries_.data() + entries_.size()}; }
+
+    iterator find(const Key& key) noexcept {
+        const std::size_t index = FindIndex(key);
+        return index == NPOS ? end() : iterator{entries_.data() + index, entries_.data() + entries_.size()};
+    }
+
+    const_iterator find(const Key& key) const noexcept {
+        const std::size_t index = FindIndex(key);
+        return index == NPOS ? cend() : const_iterator{entries_.data() + index, entries_.data() + entries_.size()};
+    }
+
+    [[nodiscard]] bool contains(const Key& key) const noexcept {
+        return FindIndex(key) != NPOS;
+    }
+
+    const Value& at(const Key& key) const {
+        const std::size_t index = FindIndex(key);
+        if (index == NPOS) {
+            throw std::out_of_range("FlatHashMap::at: key not found");
+        }
+        return entries_[index].second;
+    }
+
+    /**
+     * Добавляет элемент, если ключа ещё нет в таблице
+     * @return итератор на элемент с ключом key и признак того, что элемент добавлен
+     */
+    std::pair<iterator, bool> emplace(const Key& key, Value value) {
+        if (IsEmptyKey(key)) {
+            throw std::invalid_argument("FlatHashMap: the empty key cannot be inserted");
+        }
+        if ((size_ + 1) * MAX_LOAD_DENOMINATOR > entries_.size() * MAX_LOAD_NUMERATOR) {
+            Rehash(std::max(MIN_CAPACITY, entries_.size() * 2));
+        }
+        const std::size_t mask = entries_.size() - 1;
+        std::size_t index = hash_(key) & mask;
+        for (; !IsEmpty(entries_[index]); index = (index + 1) & mask) {
+            if (entries_[index].first == key) {
+                return {iterator{entries_.data() + index, entries_.data() + entries_.size()}, false};
+            }
+        }
+        entries_[index] = Entry{key, std::move(value)};
+        ++size_;
+        return {iterator{entries_.data() + index, entries_.data() + entries_.size()}, true};
+    }
+
+    /**
+     * Удаляет элемент по ключу
+     * @return количество удалённых элементов (0 или 1)
+     */
+    std::size_t erase(const Key& key) {
+        std::size_t hole = FindIndex(key);
+        if (hole == NPOS) {
+            return 0;
+        }
+        const std::size_t mask = entries_.size() - 1;
+        // Сдвигаем назад элементы, чья исходная ячейка не лежит между освободившейся ячейкой и их текущей
+        for (std::size_t index = (hole + 1) & mask; !IsEmpty(entries_[index]); index = (index + 1) & mask) {
+            const std::size_t home = hash_(entries_[index].first) & mask;
+            if (((index - home) & mask) >= ((index - hole) & mask)) {
+                entries_[hole] = std::move(entries_[index]);
+                hole = index;
+            }
+        }
+        entries_[hole] = Entry{};
+        --size_;
+        return 1;
+    }
+
+    void clear() noexcept {
+        entries_.clear();
+        size_ = 0;
+    }
+
+    /**
+     * Резервирует место под count элементов без перестроения таблицы
+     */
+    void reserve(std::size_t count) {
+        std::size_t capacity = MIN_CAPACITY;
+        while (count * MAX_LOAD_DENOMINATOR > capacity * MAX_LOAD_NUMERATOR) {
+            capacity *= 2;
+        }
+        if (capacity > entries_.size()) {
+            Rehash(capacity);
+        }
+    }
+
+private:
+    constexpr static std::size_t NPOS = static_cast<std::size_t>(-1);
+    constexpr static std::size_t MIN_CAPACITY = 16;
+    // Максимальная заполненность 3/4: при линейном пробировании цепочки остаются короткими
+    constexpr static std::size_t MAX_LOAD_NUMERATOR = 3;
+    constexpr static std::size_t MAX_LOAD_DENOMINATOR = 4;
+
+    static bool IsEmptyKey(const Key& key) noexcept {
+        return key == Key{};
+    }
+
+    static bool IsEmpty(const Entry& entry) noexcept {
+        return IsEmptyKey(entry.first);
+    }
+
+    std::size_t FindIndex(const Key& key) const noexcept {
+        if (size_ == 0 || IsEmptyKey(key)) {
+            return NPOS;
+        }
+        const std::size_t mask = entries_.size() - 1;
+        for (std::size_t index = hash_(key) & mask; !IsEmpty(entries_[index]); index = (index + 1) & mask) {
+            if (entries_[index].first == key) {
+                return index;
+            }
+        }
+        return NPOS;
+    }
+
+    void Rehash(std::size_t capacity) {
+        std::vector<Entry> entries(capacity);
+        entries.swap(entries_);
+        const std::size_t mask = capacity - 1;
+        for (auto& entry : entries) {
+            if (IsEmpty(entry)) {
+                continue;
+            }
+            std::size_t index = hash_(entry.first) & mask;
+            while (!IsEmpty(entries_[index])) {
+                index = (index + 1) & mask;
+            }
+            entries_[index] = std::move(entry);
+        }
+    }
+
+    std::vector<Entry> entries_;
+    std::size_t size_ = 0;
+    [[no_unique_address]] Hash hash_;
+};
+
+}  // namespace util
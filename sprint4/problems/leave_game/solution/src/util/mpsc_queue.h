@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace util {
+
+/**
+ * Очередь с несколькими производителями и одним потребителем без блокировок.
+ * Производители добавляют элементы в стек одной операцией compare_exchange,
+ * потребитель забирает весь стек одной операцией exchange и обрабатывает элементы
+ * в порядке добавления. Каждый элемент хранится в отдельном узле в куче
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() = default;
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        Delete(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    /**
+     * Добавляет элемент. Можно вызывать из любого потока
+     * @param value элемент
+     */
+    void Push(T value) {
+        auto* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Забирает все добавленные элементы и передаёт их consumer в порядке добавления.
+     * Вызывается только одним потоком одновременно
+     * @param consumer функция, принимающая T&&
+     * @return количество обработанных элементов
+     */
+    template <typename Consumer>
+    std::size_t ConsumeAll(Consumer&& consumer) {
+        Node* reversed = head_.exchange(nullptr, std::memory_order_acquire);
+        // Стек хранит элементы от последнего к первому
+        Node* ordered = nullptr;
+        while (reversed) {
+            Node* next = reversed->next;
+            reversed->next = ordered;
+            ordered = reversed;
+            reversed = next;
+        }
+        std::size_t count = 0;
+        while (ordered) {
+            T value = std::move(ordered->value);
+            delete std::exchange(ordered, ordered->next);
+            try {
+                consumer(std::move(value));
+            } catch (...) {
+                Delete(ordered);
+                throw;
+            }
+            ++count;
+        }
+        return count;
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next = nullptr;
+    };
+
+    static void Delete(Node* node) noexcept {
+        while (node) {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    std::atomic<Node*> head_{nullptr};
+};
+
+}  // namespace util
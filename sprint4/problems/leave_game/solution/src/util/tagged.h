@@ -31,6 +31,8 @@ public:
     using ValueType = Value;
     using TagType = Tag;
 
+    Tagged() = default;
+
     explicit Tagged(Value&& v)
         : value_(std::move(v)) {
     }
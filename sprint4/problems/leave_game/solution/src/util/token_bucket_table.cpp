@@ -0,0 +1,98 @@
+#include "token_bucket_table.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace util {
+
+namespace {
+
+using namespace std::chrono;
+
+// Финальное перемешивание splitmix64: хорошие младшие и старшие биты для любых ключей
+constexpr std::uint64_t Mix(std::uint64_t key) noexcept {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebull;
+    key ^= key >> 31;
+    return key;
+}
+
+std::uint64_t ToNanoseconds(TokenBucketTable::Clock::time_point time) noexcept {
+    return static_cast<std::uint64_t>(duration_cast<nanoseconds>(time.time_since_epoch()).count());
+}
+
+}  // namespace
+
+TokenBucketTable::TokenBucketTable(Limits limits, std::size_t capacity)
+    : interval_(static_cast<std::uint64_t>(std::llround(1e9 / limits.rate)))
+    , tolerance_(interval_ * std::max<std::uint32_t>(limits.burst, 1))
+    , shards_(SHARDS) {
+    const std::size_t shard_capacity = std::bit_ceil(std::max(capacity / SHARDS, MAX_PROBES));
+    shard_mask_ = shard_capacity - 1;
+    for (auto& shard : shards_) {
+        shard.slots = std::make_unique<Slot[]>(shard_capacity);
+    }
+}
+
+std::chrono::nanoseconds TokenBucketTable::TryAcquire(std::uint64_t key, Clock::time_point now) noexcept {
+    const std::uint64_t now_ns = ToNanoseconds(now);
+    Slot* slot = FindSlot(key, now_ns);
+    if (!slot) {
+        // Ячейка может освободиться не раньше, чем корзина в ней пополнится на один токен
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+        return nanoseconds{interval_};
+    }
+    std::uint64_t full_at = slot->full_at.load(std::memory_order_relaxed);
+    while (true) {
+        const std::uint64_t next = std::max(full_at, now_ns) + interval_;
+        if (next - now_ns > tolerance_) {
+            return nanoseconds{next - now_ns - tolerance_};
+        }
+        if (slot->full_at.compare_exchange_weak(full_at, next, std::memory_order_relaxed)) {
+            return nanoseconds::zero();
+        }
+    }
+}
+
+/**
+ * Находит ячейку ключа или занимает для него свободную ячейку либо ячейку с полной корзиной.
+ * Ячейка с полной корзиной может одновременно обновляться прежним ключом. Тогда новый ключ
+ * получает корзину без одного-двух токенов, что для ограничения частоты допустимо
+ * @param key ключ
+ * @param now текущее время в наносекундах
+ * @return ячейка или nullptr, если в пределах MAX_PROBES нет подходящей ячейки
+ */
+TokenBucketTable::Slot* TokenBucketTable::FindSlot(std::uint64_t key, std::uint64_t now) noexcept {
+    // 0 обозначает свободную ячейку
+    const std::uint64_t mixed = Mix(key);
+    const std::uint64_t hash = mixed != 0 ? mixed : 1;
+    auto& shard = shards_[(hash >> 60) & (SHARDS - 1)];
+    Slot* idle = nullptr;
+    std::uint64_t idle_key = 0;
+    for (std::size_t probe = 0; probe < MAX_PROBES; ++probe) {
+        Slot& slot = shard.slots[(hash + probe) & shard_mask_];
+        std::uint64_t slot_key = slot.key.load(std::memory_order_acquire);
+        if (slot_key == 0) {
+            if (slot.key.compare_exchange_strong(slot_key, hash, std::memory_order_acq_rel)) {
+                return &slot;
+            }
+            // Ячейку только что занял другой поток, возможно, тем же ключом
+        }
+        if (slot_key == hash) {
+            return &slot;
+        }
+        if (!idle && slot.full_at.load(std::memory_order_relaxed) <= now) {
+            idle = &slot;
+            idle_key = slot_key;
+        }
+    }
+    if (idle && idle->key.compare_exchange_strong(idle_key, hash, std::memory_order_acq_rel)) {
+        return idle;
+    }
+    return idle_key == hash ? idle : nullptr;
+}
+
+}  // namespace util
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace util {
+
+/**
+ * Таблица корзин токенов (token bucket) без блокировок. Корзина пополняется со скоростью rate токенов
+ * в секунду и вмещает не больше burst токенов, каждый запрос забирает один токен.
+ *
+ * Состояние корзины - одно 64-битное число: момент, когда корзина снова станет полной
+ * (theoretical arrival time, алгоритм GCRA). Запрос сдвигает этот момент на 1/rate секунды
+ * и допускается, если момент уходит в будущее не дальше burst/rate секунд.
+ * Поэтому корзина обновляется одной операцией compare_exchange.
+ *
+ * Ключи - 64-битные хеши, таблица разбита на шарды с открытой адресацией. Ячейка, однажды занятая
+ * ключом, не освобождается, а переходит к новому ключу, когда корзина в ней снова полна:
+ * полная корзина ничем не отличается от отсутствующей, поэтому простаивающие корзины
+ * вытесняются лениво, без отдельного прохода. Если для нового ключа нет ни свободной,
+ * ни полной ячейки, запрос отклоняется (GetOverflows): переполненная таблица не должна
+ * снимать ограничение. Поэтому ключами должны быть проверенные значения, иначе клиент,
+ * перебирающий ключи, займёт ячейки настоящих клиентов
+ */
+class TokenBucketTable {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Limits {
+        // Токенов в секунду, больше 0
+        double rate = 1.0;
+        // Ёмкость корзины, не меньше 1
+        std::uint32_t burst = 1;
+    };
+
+    constexpr static std::size_t SHARDS = 16;
+    // Сколько ячеек просматривается, начиная с ячейки ключа
+    constexpr static std::size_t MAX_PROBES = 16;
+
+    /**
+     * @param limits скорость пополнения и ёмкость корзин
+     * @param capacity общее количество корзин, округляется вверх до степени двойки не меньше SHARDS
+     */
+    TokenBucketTable(Limits limits, std::size_t capacity);
+
+    TokenBucketTable(const TokenBucketTable&) = delete;
+    TokenBucketTable& operator=(const TokenBucketTable&) = delete;
+
+    /**
+     * Забирает токен из корзины ключа. Можно вызывать из любого потока
+     * @param key ключ корзины
+     * @param now текущее время
+     * @return 0, если токен получен, иначе время, через которое он появится
+     *  (при переполнении таблицы - время пополнения одного токена)
+     */
+    [[nodiscard]] std::chrono::nanoseconds TryAcquire(std::uint64_t key, Clock::time_point now) noexcept;
+
+    /// Количество запросов, отклонённых из-за переполнения таблицы
+    [[nodiscard]] std::size_t GetOverflows() const noexcept {
+        return overflows_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        // 0 - ячейка ни разу не занималась
+        std::atomic<std::uint64_t> key{0};
+        // Момент, когда корзина станет полной, в наносекундах от эпохи Clock
+        std::atomic<std::uint64_t> full_at{0};
+    };
+
+    struct alignas(64) Shard {
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    Slot* FindSlot(std::uint64_t key, std::uint64_t now) noexcept;
+
+    const std::uint64_t interval_;
+    const std::uint64_t tolerance_;
+    std::size_t shard_mask_;
+    std::vector<Shard> shards_;
+    std::atomic<std::size_t> overflows_{0};
+};
+
+}  // namespace util
@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/app/application.h"
+#include "../src/util/mpsc_queue.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct InboxFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<app::Token> tokens;
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            tokens.push_back(app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(tokens.size())).first);
+            players.push_back(app.FindPlayer(tokens.back()));
+        }
+    }
+
+    std::string_view GetDirection(const app::Token& token) {
+        return app.FindPlayer(token)->GetDog()->GetDirection();
+    }
+};
+
+const std::vector<std::string_view> DIRECTIONS{model::Movement::LEFT, model::Movement::RIGHT,
+                                               model::Movement::UP, model::Movement::DOWN};
+
+}  // namespace
+
+SCENARIO("MPSC queue") {
+    constexpr int PRODUCERS = 8;
+    constexpr int ITEMS_PER_PRODUCER = 20'000;
+    util::MpscQueue<std::pair<int, int>> queue;
+    std::vector<int> last_seen(PRODUCERS, -1);
+    std::size_t consumed = 0;
+    bool ordered = true;
+    auto consume = [&] {
+        consumed += queue.ConsumeAll([&](std::pair<int, int>&& item) {
+            // Элементы одного производителя приходят в порядке добавления
+            ordered = ordered && item.second == last_seen[item.first] + 1;
+            last_seen[item.first] = item.second;
+        });
+    };
+
+    std::atomic<int> running = PRODUCERS;
+    {
+        std::vector<std::jthread> producers;
+        for (int producer = 0; producer < PRODUCERS; ++producer) {
+            producers.emplace_back([&queue, &running, producer] {
+                for (int i = 0; i < ITEMS_PER_PRODUCER; ++i) {
+                    queue.Push({producer, i});
+                }
+                --running;
+            });
+        }
+        while (running > 0) {
+            consume();
+        }
+    }
+    consume();
+
+    CHECK(ordered);
+    CHECK(consumed == static_cast<std::size_t>(PRODUCERS * ITEMS_PER_PRODUCER));
+    CHECK(queue.Empty());
+}
+
+SCENARIO_METHOD(InboxFixture, "Player moves are applied at the start of the tick") {
+    Join(2);
+    auto& inbox = app.GetActionInbox();
+
+    CHECK(app::ActionInbox::ParseDirection("L"sv) == model::Movement::LEFT);
+    CHECK(app::ActionInbox::ParseDirection(""sv) == model::Movement::STOP);
+    CHECK(!app::ActionInbox::ParseDirection("X"sv));
+    CHECK(!app::ActionInbox::ParseDirection("LL"sv));
+
+    WHEN("several moves of a player arrive within one tick") {
+        inbox.Push(players[0], model::Movement::LEFT);
+        inbox.Push(players[1], model::Movement::DOWN);
+        inbox.Push(players[0], model::Movement::RIGHT);
+
+        THEN("nothing changes until the tick and then the last move wins") {
+            CHECK(GetDirection(tokens[0]) == model::Movement::UP);
+            app.Tick(0ms);
+            CHECK(GetDirection(tokens[0]) == model::Movement::RIGHT);
+            CHECK(GetDirection(tokens[1]) == model::Movement::DOWN);
+            CHECK(app.FindPlayer(tokens[0])->GetDog()->GetSpeed().dx > 0.0);
+        }
+    }
+
+    WHEN("a player sends many moves between ticks") {
+        for (int i = 0; i < 10'000; ++i) {
+            inbox.Push(players[0], i % 2 == 0 ? model::Movement::LEFT : model::Movement::DOWN);
+        }
+
+        THEN("only the last one is kept and applied once") {
+            CHECK(inbox.Drain(app.GetPlayers()) == 1);
+            CHECK(GetDirection(tokens[0]) == model::Movement::DOWN);
+            CHECK(inbox.Drain(app.GetPlayers()) == 0);
+        }
+    }
+
+    WHEN("a player leaves the game before the tick") {
+        inbox.Push(players[0], model::Movement::LEFT);
+        app.GetPlayers().DeleteByToken(tokens[0]);
+
+        THEN("the move is dropped") {
+            CHECK(inbox.Drain(app.GetPlayers()) == 1);
+            CHECK(players[0]->GetDog()->GetDirection() == model::Movement::UP);
+        }
+    }
+}
+
+SCENARIO_METHOD(InboxFixture, "Player moves from many threads while the game ticks") {
+    constexpr std::size_t THREADS = 8;
+    constexpr std::size_t PLAYERS_PER_THREAD = 4;
+    constexpr std::size_t MOVES_PER_PLAYER = 5'000;
+    Join(THREADS * PLAYERS_PER_THREAD);
+
+    std::atomic<std::size_t> running = THREADS;
+    {
+        std::vector<std::jthread> producers;
+        for (std::size_t thread = 0; thread < THREADS; ++thread) {
+            producers.emplace_back([this, &running, thread] {
+                for (std::size_t move = 0; move < MOVES_PER_PLAYER; ++move) {
+                    for (std::size_t player = 0; player < PLAYERS_PER_THREAD; ++player) {
+                        const auto index = thread * PLAYERS_PER_THREAD + player;
+                        app.GetActionInbox().Push(players[index], DIRECTIONS[(index + move) % DIRECTIONS.size()]);
+                    }
+                }
+                --running;
+            });
+        }
+        // Тики идут одновременно с поступлением команд
+        while (running > 0) {
+            app.Tick(1ms);
+        }
+    }
+    app.Tick(1ms);
+
+    for (std::size_t index = 0; index < tokens.size(); ++index) {
+        CHECK(GetDirection(tokens[index]) == DIRECTIONS[(index + MOVES_PER_PLAYER - 1) % DIRECTIONS.size()]);
+    }
+}
+
+TEST_CASE_METHOD(InboxFixture, "Player moves throughput", "[.][benchmark]") {
+    constexpr std::size_t MOVES_PER_THREAD = 100'000;
+    Join(100);
+
+    for (const unsigned threads : {1u, 2u, 4u, 8u}) {
+        BENCHMARK(std::to_string(threads * MOVES_PER_THREAD) + " moves from "s + std::to_string(threads) + " threads and one tick"s) {
+            std::vector<std::jthread> producers;
+            for (unsigned thread = 0; thread < threads; ++thread) {
+                producers.emplace_back([this, thread] {
+                    for (std::size_t move = 0; move < MOVES_PER_THREAD; ++move) {
+                        app.GetActionInbox().Push(players[(thread + move) % players.size()], DIRECTIONS[move % DIRECTIONS.size()]);
+                    }
+                });
+            }
+            producers.clear();
+            return app.GetActionInbox().Drain(app.GetPlayers());
+        };
+    }
+}
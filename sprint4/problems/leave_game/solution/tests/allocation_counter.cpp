@@ -0,0 +1,49 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Подсчёт выделений памяти ведётся только в потоках, где включён счётчик
+thread_local bool count_allocations = false;
+std::atomic<std::size_t> allocations{0};
+std::atomic<std::size_t> allocated_bytes{0};
+
+}  // namespace
+
+namespace test_util {
+
+void CountAllocations(bool enable) noexcept {
+    count_allocations = enable;
+}
+
+std::size_t GetAllocations() noexcept {
+    return allocations.load();
+}
+
+std::size_t GetAllocatedBytes() noexcept {
+    return allocated_bytes.load();
+}
+
+}  // namespace test_util
+
+void* operator new(std::size_t size) {
+    if (count_allocations) {
+        ++allocations;
+        allocated_bytes += size;
+    }
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t /*size*/) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+namespace test_util {
+
+/**
+ * Включает подсчёт выделений памяти (глобальный operator new) в текущем потоке
+ * @param enable true - считать выделения, false - не считать
+ */
+void CountAllocations(bool enable) noexcept;
+
+/**
+ * @return число выделений памяти во всех потоках с включённым подсчётом
+ */
+std::size_t GetAllocations() noexcept;
+
+/**
+ * @return суммарный размер выделений памяти во всех потоках с включённым подсчётом, байт
+ */
+std::size_t GetAllocatedBytes() noexcept;
+
+}  // namespace test_util
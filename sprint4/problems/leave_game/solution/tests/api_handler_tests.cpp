@@ -0,0 +1,333 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "../src/logger/logger.h"
+#include "../src/msgpack/msgpack_model.h"
+#include "../src/request_handler/request_handler.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Проверяемые запросы не обращаются к базе данных
+struct NoDatabase : app::UnitOfWorkFactory {
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        throw std::runtime_error("database is not available");
+    }
+};
+
+struct ApiFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    NoDatabase database;
+    net::io_context ioc;
+    std::shared_ptr<RequestHandler> handler =
+            std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database);
+    std::string token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Шарик"s).first);
+
+    StringRequest MakeRequest(http::verb method, std::string_view target, std::string_view body = {}) const {
+        StringRequest req{method, target, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        req.body() = body;
+        req.prepare_payload();
+        return req;
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(ApiFixture, "Authorized API requests allocate a bounded amount of memory") {
+    constexpr std::size_t WARM_UP_REQUESTS = 10;
+    constexpr std::size_t REQUESTS = 1'000;
+    // Тело ответа и три поля его заголовка (Content-Type, Content-Length, Cache-Control)
+    // плюс запас на внутренние выделения библиотек.
+    // Копия запроса, обработчик API, std::function и строки разбора токена сюда не входят
+    constexpr std::size_t MAX_ALLOCATIONS_PER_REQUEST = 7;
+
+    const std::vector<std::pair<http::verb, std::string_view>> targets{
+        {http::verb::get, EndPoint::STATE},
+        {http::verb::get, EndPoint::PLAYERS},
+        {http::verb::post, EndPoint::ACTION},
+    };
+
+    for (const auto& [method, target] : targets) {
+        GIVEN("requests to "s + std::string{target}) {
+            std::vector<StringRequest> requests;
+            for (std::size_t i = 0; i < WARM_UP_REQUESTS + REQUESTS; ++i) {
+                requests.push_back(MakeRequest(method, target, method == http::verb::post ? R"({"move": "L"})"sv : ""sv));
+            }
+            std::size_t responses = 0;
+            http::status status{};
+            auto send = [&responses, &status](auto&& response) {
+                ++responses;
+                status = response.result();
+            };
+            auto handle = [&](std::size_t from, std::size_t to) {
+                for (std::size_t i = from; i < to; ++i) {
+                    (*handler)(http_server::Endpoint{}, std::move(requests[i]), send);
+                    ioc.run();
+                    ioc.restart();
+                }
+            };
+
+            handle(0, WARM_UP_REQUESTS);
+            test_util::CountAllocations(true);
+            const std::size_t before = test_util::GetAllocations();
+            handle(WARM_UP_REQUESTS, WARM_UP_REQUESTS + REQUESTS);
+            const std::size_t allocations = test_util::GetAllocations() - before;
+            test_util::CountAllocations(false);
+
+            THEN("every request is answered within the allocation bound") {
+                CHECK(responses == WARM_UP_REQUESTS + REQUESTS);
+                CHECK(status == http::status::ok);
+                CHECK(allocations <= REQUESTS * MAX_ALLOCATIONS_PER_REQUEST);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(ApiFixture, "Map requests are answered from precomputed responses") {
+    struct Result {
+        http::status status{};
+        std::string body;
+        std::string etag;
+        std::string content_encoding;
+        // Адрес тела в общем буфере
+        const char* data = nullptr;
+    };
+    auto request = [this](std::string_view target, std::string_view accept_encoding = {}, std::string_view if_none_match = {}) {
+        StringRequest req{http::verb::get, target, 11};
+        if (!accept_encoding.empty()) {
+            req.set(http::field::accept_encoding, accept_encoding);
+        }
+        if (!if_none_match.empty()) {
+            req.set(http::field::if_none_match, if_none_match);
+        }
+        std::optional<Result> result;
+        (*handler)(http_server::Endpoint{}, std::move(req), [&result](auto&& response) {
+            Result r{response.result(), {}, std::string{response[http::field::etag]},
+                     std::string{response[http::field::content_encoding]}};
+            if constexpr (std::is_same_v<std::decay_t<decltype(response)>, SharedBufferResponse>) {
+                r.body = response.body().data;
+                r.data = response.body().data.data();
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(response)>, StringResponse>) {
+                r.body = response.body();
+            }
+            result = std::move(r);
+        });
+        // Ответ отправлен сразу, без api_strand
+        REQUIRE(result.has_value());
+        return *result;
+    };
+
+    const auto map = app.FindMap(model::Map::Id{"map1"s});
+    REQUIRE(map);
+
+    WHEN("a map and the map list are requested") {
+        const auto map_result = request("/api/v1/maps/map1"sv);
+        const auto list_result = request("/api/v1/maps"sv);
+
+        THEN("the bodies match the serialized model") {
+            CHECK(map_result.status == http::status::ok);
+            CHECK(json::parse(map_result.body) == json::value_from(*map));
+            CHECK(!map_result.etag.empty());
+            CHECK(map_result.content_encoding.empty());
+            CHECK(list_result.status == http::status::ok);
+            CHECK(json::parse(list_result.body) == json::value_from(app.GetMaps()));
+        }
+
+        AND_THEN("the same body is served by reference and validated by its ETag") {
+            CHECK(map_result.data != nullptr);
+            CHECK(request("/api/v1/maps/map1"sv).data == map_result.data);
+            CHECK(request("/api/v1/maps/map1"sv, {}, map_result.etag).status == http::status::not_modified);
+        }
+
+        AND_THEN("304 without Content-Type passes through the logging decorator") {
+            server_logging::LoggingRequestHandler logging_handler{*handler};
+            StringRequest req{http::verb::get, "/api/v1/maps/map1"sv, 11};
+            req.set(http::field::if_none_match, map_result.etag);
+            std::optional<http::status> status;
+            logging_handler(http_server::Endpoint{}, std::move(req), [&status](auto&& response) {
+                status = response.result();
+            });
+            CHECK(status == http::status::not_modified);
+        }
+    }
+
+    WHEN("the client accepts gzip") {
+        const auto result = request("/api/v1/maps/map1"sv, "gzip"sv);
+
+        THEN("the pre-compressed variant is sent") {
+            CHECK(result.status == http::status::ok);
+            CHECK(result.content_encoding == "gzip"s);
+            CHECK(result.body.size() < model::SerializeJson(*map).size());
+        }
+    }
+
+    THEN("an unknown map is not found") {
+        CHECK(request("/api/v1/maps/map%3F"sv).status == http::status::not_found);
+        CHECK(request("/api/v1/maps/"sv).status == http::status::not_found);
+        CHECK(request("/api/v1/maps/map1/x"sv).status == http::status::not_found);
+    }
+}
+
+SCENARIO_METHOD(ApiFixture, "State requests with a version cursor") {
+    auto request = [this](std::string_view target) {
+        std::pair<http::status, std::string> result;
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, target), [&result](auto&& response) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(response)>, StringResponse>) {
+                result = {response.result(), response.body()};
+            }
+        });
+        ioc.run();
+        ioc.restart();
+        return result;
+    };
+    const auto& session = *app.FindPlayer(*app::TokenFromHex(token))->GetSession();
+
+    WHEN("the client sends the version it has seen") {
+        const auto [status, body] = request("/api/v1/game/state?since=0"sv);
+
+        THEN("the changes since that version are answered with the current version") {
+            CHECK(status == http::status::ok);
+            std::string expected;
+            ApiHandler::WriteGameStateDelta(session, 0, expected);
+            CHECK(body == expected);
+        }
+    }
+
+    THEN("an invalid version is rejected") {
+        CHECK(request("/api/v1/game/state?since=abc"sv).first == http::status::bad_request);
+        CHECK(request("/api/v1/game/state?since=-1"sv).first == http::status::bad_request);
+    }
+
+    THEN("a malformed query string is rejected") {
+        CHECK(request("/api/v1/game/state?%"sv).first == http::status::bad_request);
+        CHECK(request("/api/v1/game/state?since=%zz"sv).first == http::status::bad_request);
+    }
+}
+
+SCENARIO_METHOD(ApiFixture, "State requests in MessagePack") {
+    std::string content_type;
+    std::string vary;
+    std::string body;
+    auto request = [&](std::string_view accept) {
+        StringRequest req = MakeRequest(http::verb::get, EndPoint::STATE);
+        req.set(http::field::accept, accept);
+        (*handler)(http_server::Endpoint{}, std::move(req), [&content_type, &vary, &body](auto&& response) {
+            content_type = response[http::field::content_type];
+            vary = response[http::field::vary];
+            if constexpr (std::is_same_v<std::decay_t<decltype(response)>, SharedBufferResponse>) {
+                body = response.body().data;
+            }
+        });
+        ioc.run();
+        ioc.restart();
+    };
+
+    WHEN("the client accepts MessagePack") {
+        request(ContentType::APPLICATION_MSGPACK);
+
+        THEN("the state is sent in the binary encoding") {
+            CHECK(content_type == ContentType::APPLICATION_MSGPACK);
+            CHECK(vary == "Accept");
+            const auto state = msgpack::DecodeGameState(body);
+            CHECK(state.dogs.size() == 1);
+        }
+    }
+
+    WHEN("MessagePack is refused with q=0 or weighted below JSON") {
+        THEN("the state is sent as JSON") {
+            request("application/msgpack;q=0, */*"sv);
+            CHECK(content_type == ContentType::APPLICATION_JSON);
+            CHECK(vary == "Accept");
+            request("application/msgpack;q=0.5, application/json"sv);
+            CHECK(content_type == ContentType::APPLICATION_JSON);
+        }
+    }
+}
+
+namespace {
+
+// База данных, запрос рекордов к которой завершается только по команде теста
+struct SlowDatabase : app::UnitOfWorkFactory {
+    struct Repository : data_base::domain::RetiredPlayerRepository {
+        std::shared_future<void> released;
+
+        void Save(const data_base::domain::RetiredPlayer&) override {}
+        void SaveAll(const data_base::domain::RetiredPlayers&) override {}
+        [[nodiscard]] data_base::domain::RetiredPlayers Get(size_t, size_t) const override {
+            released.wait();
+            return {};
+        }
+    };
+
+    struct Work : app::UnitOfWork {
+        Repository repository;
+        void Commit() override {}
+        data_base::domain::RetiredPlayerRepository& RetiredPlayers() override { return repository; }
+    };
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        auto work = std::make_unique<Work>();
+        work->repository.released = released;
+        return work;
+    }
+};
+
+}  // namespace
+
+SCENARIO("Slow records requests do not block the API strand") {
+    app::Application app{"../../tests/test_config.json"s};
+    SlowDatabase database;
+    net::io_context ioc;
+    net::thread_pool blocking_pool(1);
+    auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database,
+                                                    0, nullptr, nullptr, blocking_pool.get_executor());
+    const auto token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Шарик"s).first);
+
+    std::promise<std::string> records;
+    (*handler)(http_server::Endpoint{}, StringRequest{http::verb::get, "/api/v1/game/records?start=0&maxItems=10"sv, 11},
+               [&records](auto&& response) {
+                   if constexpr (std::is_same_v<std::decay_t<decltype(response)>, StringResponse>) {
+                       records.set_value(response.body());
+                   }
+               });
+
+    WHEN("the game state is requested while the database query is in progress") {
+        StringRequest req{http::verb::get, EndPoint::STATE, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        http::status status{};
+        (*handler)(http_server::Endpoint{}, std::move(req), [&status](auto&& response) {
+            status = response.result();
+        });
+        ioc.run();
+
+        THEN("the state is answered before the records") {
+            CHECK(status == http::status::ok);
+            auto records_result = records.get_future();
+            CHECK(records_result.wait_for(0s) == std::future_status::timeout);
+            database.release.set_value();
+            CHECK(records_result.get() == "[]"s);
+        }
+    }
+    blocking_pool.join();
+}
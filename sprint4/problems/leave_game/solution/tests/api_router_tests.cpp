@@ -0,0 +1,161 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "../src/request_handler/api_router.h"
+
+using namespace http_handler;
+using namespace std::literals;
+using boost::beast::http::verb;
+
+namespace {
+
+// Пути всех маршрутов API в том виде, в котором их присылают клиенты
+const std::vector<std::string_view> TARGETS{
+    "/api/v1/maps"sv,
+    "/api/v1/maps/map1"sv,
+    "/api/v1/game/players"sv,
+    "/api/v1/game/join"sv,
+    "/api/v1/game/state"sv,
+    "/api/v1/game/player/action"sv,
+    "/api/v1/game/tick"sv,
+    "/api/v1/game/records?start=0&maxItems=10"sv,
+};
+
+// Прежняя диспетчеризация: декодирование каждого пути и цепочка сравнений
+int LegacyDispatch(std::string_view target) {
+    const auto decoded_target = util::UrlDecode(std::string{target});
+    if (decoded_target.starts_with(EndPoint::MAPS)) {
+        return decoded_target == EndPoint::MAPS ? 0 : 1;
+    }
+    if (decoded_target.starts_with(EndPoint::GAME)) {
+        if (decoded_target == EndPoint::PLAYERS) {
+            return 2;
+        }
+        if (decoded_target == EndPoint::JOIN) {
+            return 3;
+        }
+        if (decoded_target == EndPoint::STATE) {
+            return 4;
+        }
+        if (decoded_target == EndPoint::ACTION) {
+            return 5;
+        }
+        if (decoded_target == EndPoint::TICK) {
+            return 6;
+        }
+        if (decoded_target.starts_with(EndPoint::RECORDS)) {
+            return 7;
+        }
+    }
+    return -1;
+}
+
+}  // namespace
+
+static_assert(ApiRouter::Find(EndPoint::STATE)->route == ApiRoute::STATE);
+static_assert(ApiRouter::Find(EndPoint::GAME) == nullptr);
+
+SCENARIO("API route table") {
+    GIVEN("a request-target of every route") {
+        THEN("each one is matched to its own route") {
+            for (std::size_t i = 0; i < TARGETS.size(); ++i) {
+                std::string decoded;
+                const auto match = ApiRouter::Match(TARGETS[i], decoded);
+                REQUIRE(match.has_value());
+                CHECK(match->spec == &API_ROUTES[i]);
+                CHECK(decoded.empty());
+            }
+        }
+    }
+
+    WHEN("a route has a parameter or a query") {
+        std::string decoded;
+        const auto map = ApiRouter::Match("/api/v1/maps/map1"sv, decoded);
+        const auto records = ApiRouter::Match("/api/v1/game/records?start=5&maxItems=10"sv, decoded);
+
+        THEN("they are returned as views into the target") {
+            REQUIRE(map.has_value());
+            CHECK(map->spec->route == ApiRoute::MAP);
+            CHECK(map->param == "map1"sv);
+            REQUIRE(records.has_value());
+            CHECK(records->spec->route == ApiRoute::RECORDS);
+            CHECK(records->query == "start=5&maxItems=10"sv);
+        }
+    }
+
+    WHEN("the path is percent-encoded") {
+        std::string decoded;
+        const auto match = ApiRouter::Match("/api/v1/maps/map%31"sv, decoded);
+
+        THEN("it is decoded before matching") {
+            REQUIRE(match.has_value());
+            CHECK(match->spec->route == ApiRoute::MAP);
+            CHECK(match->param == "map1"sv);
+            CHECK(decoded == "/api/v1/maps/map1"sv);
+        }
+    }
+
+    THEN("empty and nested map ids are passed to the map route") {
+        std::string decoded;
+        for (const auto& [target, id] : {std::pair{"/api/v1/maps/"sv, ""sv}, std::pair{"/api/v1/maps/map1/x"sv, "map1/x"sv}}) {
+            const auto match = ApiRouter::Match(target, decoded);
+            REQUIRE(match);
+            CHECK(match->spec->route == ApiRoute::MAP);
+            CHECK(match->param == id);
+        }
+    }
+
+    THEN("paths without a route are not matched") {
+        std::string decoded;
+        CHECK(!ApiRouter::Match("/api/v1/game"sv, decoded));
+        CHECK(!ApiRouter::Match("/api/v1/game/ws"sv, decoded));
+        CHECK(!ApiRouter::Match("/api/v1/mapsx"sv, decoded));
+        CHECK(!ApiRouter::Match("/api/v1/game/state/"sv, decoded));
+    }
+
+    THEN("allowed methods are checked per route") {
+        CHECK(ApiRouter::IsAllowed(ApiMethods::GET_HEAD, verb::get));
+        CHECK(ApiRouter::IsAllowed(ApiMethods::GET_HEAD, verb::head));
+        CHECK(!ApiRouter::IsAllowed(ApiMethods::GET_HEAD, verb::post));
+        CHECK(ApiRouter::IsAllowed(ApiMethods::POST, verb::post));
+        CHECK(!ApiRouter::IsAllowed(ApiMethods::POST, verb::get));
+    }
+
+    THEN("matching a path that needs no decoding does not allocate memory") {
+        std::string decoded;
+        std::size_t matched = 0;
+        test_util::CountAllocations(true);
+        const std::size_t before = test_util::GetAllocations();
+        for (const auto target : TARGETS) {
+            matched += ApiRouter::Match(target, decoded).has_value();
+        }
+        const std::size_t allocations = test_util::GetAllocations() - before;
+        test_util::CountAllocations(false);
+        CHECK(matched == TARGETS.size());
+        CHECK(allocations == 0);
+    }
+}
+
+TEST_CASE("API dispatch over all endpoints", "[.][benchmark]") {
+    BENCHMARK("route table") {
+        std::string decoded;
+        std::size_t matched = 0;
+        for (const auto target : TARGETS) {
+            matched += ApiRouter::Match(target, decoded).has_value();
+        }
+        return matched;
+    };
+
+    BENCHMARK("decode and compare") {
+        int routes = 0;
+        for (const auto target : TARGETS) {
+            routes += LegacyDispatch(target);
+        }
+        return routes;
+    };
+}
@@ -0,0 +1,253 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <boost/asio/io_context.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/request_handler/request_handler.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Проверяемые запросы не обращаются к базе данных
+struct NoDatabase : app::UnitOfWorkFactory {
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        throw std::runtime_error("database is not available");
+    }
+};
+
+struct SnapshotFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<app::Token> tokens;
+
+    SnapshotFixture() {
+        app.SetTickMode(true);
+        Join(3);
+    }
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            tokens.push_back(app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(tokens.size())).first);
+        }
+    }
+
+    std::string GetState(const app::Token& token) {
+        std::string state;
+        ApiHandler::WriteGameState(*app.FindPlayer(token)->GetSession(), state);
+        return state;
+    }
+
+    static StringRequest MakeRequest(http::verb method, std::string_view target, const app::Token& token,
+                                     std::string_view body = {}) {
+        StringRequest req{method, target, 11};
+        req.set(http::field::authorization, "Bearer "s + app::TokenToHex(token));
+        req.body() = body;
+        req.prepare_payload();
+        return req;
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(SnapshotFixture, "Published game snapshots") {
+    GameSnapshotPublisher publisher(app);
+
+    GIVEN("the first snapshot") {
+        const auto snapshot = publisher.Get();
+
+        THEN("it holds the state of every player's session") {
+            for (const auto& token : tokens) {
+                const auto* session = snapshot->FindSession(token);
+                REQUIRE(session != nullptr);
+                CHECK(session->GetState()->body == GetState(token));
+            }
+            CHECK(snapshot->FindSession(app::Token{app::TokenValue{1, 2}}) == nullptr);
+        }
+
+        THEN("each body is built once and shared by concurrent reads") {
+            const auto* session = snapshot->FindSession(tokens.front());
+            REQUIRE(session != nullptr);
+            std::vector<std::shared_ptr<const SessionSnapshot>> bodies(4);
+            {
+                std::vector<std::jthread> readers;
+                for (auto& body : bodies) {
+                    readers.emplace_back([session, &body] {
+                        body = session->GetPlayers();
+                    });
+                }
+            }
+            for (const auto& body : bodies) {
+                CHECK(body == bodies.front());
+            }
+        }
+
+        WHEN("nothing changes") {
+            publisher.Publish();
+
+            THEN("the snapshot is not replaced") {
+                CHECK(publisher.Get() == snapshot);
+            }
+        }
+
+        WHEN("a dog changes its direction") {
+            app.FindPlayer(tokens.front())->DogMove("U"sv, 1.0);
+            publisher.Publish();
+
+            // Тело старого снимка строится уже после изменения, из копии сессии
+            THEN("the new state is published while the old snapshot stays intact") {
+                CHECK(publisher.Get() != snapshot);
+                CHECK(publisher.Get()->FindSession(tokens.front())->GetState()->body == GetState(tokens.front()));
+                CHECK(snapshot->FindSession(tokens.front())->GetState()->body != GetState(tokens.front()));
+            }
+        }
+
+        WHEN("a player joins") {
+            Join(1);
+            publisher.Publish();
+
+            THEN("the player becomes visible after the next tick") {
+                CHECK(publisher.Get()->FindSession(tokens.back()) == nullptr);
+                app.Tick(10ms);
+                publisher.OnTick(10ms);
+                CHECK(publisher.Get()->FindSession(tokens.back()) != nullptr);
+            }
+        }
+    }
+}
+
+SCENARIO_METHOD(SnapshotFixture, "Game state is read without the API strand") {
+    NoDatabase database;
+    net::io_context ioc;
+    auto publisher = std::make_shared<GameSnapshotPublisher>(app);
+    auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database,
+                                                    0, nullptr, publisher);
+    std::size_t responses = 0;
+    http::status status{};
+    std::string body;
+    auto send = [&](auto&& response) {
+        ++responses;
+        status = response.result();
+        if constexpr (std::is_same_v<std::decay_t<decltype(response)>, SharedBufferResponse>) {
+            body = response.body().data;
+        }
+    };
+
+    WHEN("a known player requests the state") {
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, EndPoint::STATE, tokens.front()), send);
+
+        THEN("the response is sent at once from the snapshot") {
+            CHECK(responses == 1);
+            CHECK(status == http::status::ok);
+            CHECK(body == GetState(tokens.front()));
+        }
+    }
+
+    WHEN("a player moves") {
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::post, EndPoint::ACTION, tokens.front(), R"({"move": "L"})"sv), send);
+
+        THEN("the move is accepted at once and applied by the next tick") {
+            CHECK(responses == 1);
+            CHECK(status == http::status::ok);
+            CHECK(ioc.poll() == 0);
+            CHECK(app.FindPlayer(tokens.front())->GetDog()->GetDirection() == model::Movement::UP);
+
+            app.Tick(10ms);
+            publisher->OnTick(10ms);
+            CHECK(app.FindPlayer(tokens.front())->GetDog()->GetDirection() == model::Movement::LEFT);
+            (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, EndPoint::STATE, tokens.front()), send);
+            CHECK(responses == 2);
+            CHECK(body == GetState(tokens.front()));
+        }
+    }
+
+    WHEN("the player is not in the snapshot yet") {
+        Join(1);
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, EndPoint::STATE, tokens.back()), send);
+
+        THEN("the request is handled in the strand") {
+            CHECK(responses == 0);
+            ioc.run();
+            CHECK(responses == 1);
+            CHECK(status == http::status::ok);
+        }
+    }
+
+    WHEN("requests that do not change the game go through the strand") {
+        Join(1);
+        const auto snapshot = publisher->Get();
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, EndPoint::STATE, tokens.back()), send);
+        (*handler)(http_server::Endpoint{}, MakeRequest(http::verb::get, EndPoint::PLAYERS, tokens.back()), send);
+        ioc.run();
+
+        THEN("no snapshot is published") {
+            CHECK(responses == 2);
+            CHECK(publisher->Get() == snapshot);
+        }
+    }
+
+    WHEN("a player joins the game") {
+        const auto snapshot = publisher->Get();
+        StringRequest join{http::verb::post, EndPoint::JOIN, 11};
+        join.set(http::field::content_type, "application/json"sv);
+        join.body() = R"({"userName": "Новый игрок", "mapId": "map1"})"sv;
+        join.prepare_payload();
+        (*handler)(http_server::Endpoint{}, std::move(join), send);
+        ioc.run();
+
+        THEN("the new dog is published before the response") {
+            CHECK(responses == 1);
+            CHECK(status == http::status::ok);
+            CHECK(publisher->Get() != snapshot);
+            const auto* session = publisher->Get()->FindSession(tokens.front());
+            REQUIRE(session != nullptr);
+            CHECK(session->GetState()->body == GetState(tokens.front()));
+        }
+    }
+}
+
+TEST_CASE_METHOD(SnapshotFixture, "State reads scaling over 1-16 threads", "[.][benchmark]") {
+    constexpr std::size_t REQUESTS_PER_THREAD = 2'000;
+    Join(97);
+    NoDatabase database;
+
+    for (const bool use_snapshots : {false, true}) {
+        for (const unsigned threads : {1u, 2u, 4u, 8u, 16u}) {
+            net::io_context ioc(static_cast<int>(threads));
+            auto handler = std::make_shared<RequestHandler>(
+                    fs::temp_directory_path(), net::make_strand(ioc), app, database, 0, nullptr,
+                    use_snapshots ? std::make_shared<GameSnapshotPublisher>(app) : nullptr);
+            const auto request = MakeRequest(http::verb::get, EndPoint::STATE, tokens.front());
+
+            BENCHMARK((use_snapshots ? "snapshot, "s : "api strand, "s) + std::to_string(threads) + " threads"s) {
+                std::atomic<std::size_t> responses = 0;
+                std::vector<std::jthread> workers;
+                for (unsigned i = 0; i < threads; ++i) {
+                    workers.emplace_back([&] {
+                        for (std::size_t n = 0; n < REQUESTS_PER_THREAD; ++n) {
+                            (*handler)(http_server::Endpoint{}, StringRequest{request}, [&responses](auto&&) {
+                                ++responses;
+                            });
+                        }
+                        // Запросы, отправленные в api_strand, выполняются всеми потоками по очереди
+                        ioc.run();
+                    });
+                }
+                workers.clear();
+                ioc.restart();
+                return responses.load();
+            };
+        }
+    }
+}
@@ -0,0 +1,194 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../src/request_handler/api_handler.h"
+#include "../src/request_handler/game_snapshot.h"
+#include "../src/request_handler/game_state_hub.h"
+
+using namespace http_handler;
+using namespace std::literals;
+using http_server::tcp;
+
+namespace {
+
+// Обычные HTTP-запросы в этих тестах не используются
+struct NotFoundHandler {
+    template <typename Request, typename Send>
+    void operator()(const http_server::Endpoint& /*endpoint*/, Request&& req, Send&& send) {
+        send(MakeTextResponse(req, http::status::not_found, ErrorResponse::BAD_REQ(), CacheControl::NO_CACHE));
+    }
+};
+
+using ClientSocket = websocket::stream<tcp::socket>;
+
+struct HubFixture {
+    app::Application app{"../../tests/test_config.json"s};
+    net::io_context ioc;
+    std::string token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Шарик"s).first);
+
+    // Запускает сервер, передающий запросы Upgrade в hub
+    tcp::endpoint Serve(const std::shared_ptr<GameStateHub>& hub) {
+        auto listener = http_server::ServeHttp(ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, NotFoundHandler{},
+                                               http_server::ServerOptions{.upgrade = [hub](http_server::StrandSocket&& socket,
+                                                                                           StringRequest&& req) {
+                                                   hub->Accept(std::move(socket), std::move(req));
+                                               }});
+        return *http_server::ToTcpEndpoint(listener->GetLocalEndpoint());
+    }
+
+    /**
+     * Открывает WebSocket-соединение игрока
+     * @param endpoint адрес сервера
+     * @param status код ответа на запрос Upgrade
+     */
+    std::unique_ptr<ClientSocket> Connect(const tcp::endpoint& endpoint, http::status& status) {
+        auto ws = std::make_unique<ClientSocket>(ioc);
+        ws->next_layer().connect(endpoint);
+        ws->set_option(websocket::stream_base::decorator([token = token](websocket::request_type& req) {
+            req.set(http::field::authorization, "Bearer "s + token);
+        }));
+        websocket::response_type response;
+        beast::error_code ec;
+        ws->handshake(response, "127.0.0.1", EndPoint::WEBSOCKET, ec);
+        status = response.result();
+        return ws;
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(HubFixture, "WebSocket connections are limited") {
+    auto hub = std::make_shared<GameStateHub>(app, net::make_strand(ioc), 1);
+    const auto endpoint = Serve(hub);
+    std::thread server([this] { ioc.run(); });
+
+    WHEN("the second connection is opened while the first one is open") {
+        http::status status{};
+        auto first = Connect(endpoint, status);
+        REQUIRE(status == http::status::switching_protocols);
+        auto second = Connect(endpoint, status);
+
+        THEN("it is rejected with 503") {
+            CHECK(status == http::status::service_unavailable);
+            CHECK(hub->GetRejectedSubscribers() == 1);
+        }
+
+        AND_WHEN("the first connection is closed") {
+            first->close(websocket::close_code::normal);
+            // Соединение сервера освобождается после обмена кадрами Close
+            const auto deadline = std::chrono::steady_clock::now() + 5s;
+            do {
+                second = Connect(endpoint, status);
+            } while (status != http::status::switching_protocols && std::chrono::steady_clock::now() < deadline);
+
+            THEN("a new connection is accepted") {
+                CHECK(status == http::status::switching_protocols);
+            }
+        }
+    }
+
+    ioc.stop();
+    server.join();
+}
+
+SCENARIO_METHOD(HubFixture, "WebSocket moves are rate limited") {
+    auto hub = std::make_shared<GameStateHub>(app, net::make_strand(ioc));
+    hub->SetRateLimiter(std::make_shared<RateLimiter>(RateLimiter::Options{RateLimiter::Limits{0.001, 1}, std::nullopt}));
+    const auto endpoint = Serve(hub);
+    std::thread server([this] { ioc.run(); });
+
+    WHEN("a player sends two moves at once with a burst of one") {
+        http::status status{};
+        auto ws = Connect(endpoint, status);
+        REQUIRE(status == http::status::switching_protocols);
+        ws->write(net::buffer(R"({"move": "L"})"sv));
+        ws->write(net::buffer(R"({"move": "R"})"sv));
+
+        THEN("the second move is answered with a rate limit error") {
+            // Тиков нет, поэтому первый кадр от сервера - ответ на команду
+            beast::flat_buffer buffer;
+            ws->read(buffer);
+            CHECK(beast::buffers_to_string(buffer.data()) == ErrorResponse::TOO_MANY_REQUESTS);
+        }
+    }
+
+    ioc.stop();
+    server.join();
+}
+
+SCENARIO_METHOD(HubFixture, "WebSocket moves and messages are limited without a RateLimiter") {
+    auto hub = std::make_shared<GameStateHub>(app, net::make_strand(ioc));
+    const auto endpoint = Serve(hub);
+    std::thread server([this] { ioc.run(); });
+    http::status status{};
+    auto ws = Connect(endpoint, status);
+    REQUIRE(status == http::status::switching_protocols);
+
+    WHEN("a player floods the connection with moves") {
+        // Ответов об ошибке меньше MAX_PENDING_REPLIES, поэтому соединение не закрывается
+        for (std::size_t i = 0; i < GameWebSocket::MOVE_BURST + GameWebSocket::MAX_PENDING_REPLIES / 2; ++i) {
+            ws->write(net::buffer(R"({"move": "L"})"sv));
+        }
+
+        THEN("moves beyond the connection burst are answered with a rate limit error") {
+            beast::flat_buffer buffer;
+            ws->read(buffer);
+            CHECK(beast::buffers_to_string(buffer.data()) == ErrorResponse::TOO_MANY_REQUESTS);
+        }
+    }
+
+    WHEN("a player sends a message larger than a move") {
+        ws->write(net::buffer(std::string(GameWebSocket::MAX_MESSAGE_SIZE + 1, ' ')));
+
+        THEN("the connection is closed with too_big") {
+            beast::flat_buffer buffer;
+            beast::error_code ec;
+            ws->read(buffer, ec);
+            CHECK(ec == websocket::error::closed);
+            CHECK(ws->reason().code == websocket::close_code::too_big);
+        }
+    }
+
+    ioc.stop();
+    server.join();
+}
+
+SCENARIO_METHOD(HubFixture, "State frames are shared with game snapshots") {
+    const auto api_strand = net::make_strand(ioc);
+    auto snapshots = std::make_shared<GameSnapshotPublisher>(app);
+    auto hub = std::make_shared<GameStateHub>(app, api_strand);
+    hub->SetSnapshotPublisher(snapshots);
+    // Как в main: снимок публикуется раньше, чем hub рассылает состояние
+    app.AddApplicationListener(snapshots);
+    app.AddApplicationListener(hub);
+    const auto endpoint = Serve(hub);
+    std::thread server([this] { ioc.run(); });
+
+    WHEN("a tick happens while a player is subscribed") {
+        http::status status{};
+        auto ws = Connect(endpoint, status);
+        REQUIRE(status == http::status::switching_protocols);
+        net::post(api_strand, [this] {
+            app.Tick(10ms);
+        });
+
+        THEN("the frame is the published state body and the hub does not serialize it again") {
+            beast::flat_buffer buffer;
+            ws->read(buffer);
+            const auto snapshot = snapshots->Get();
+            REQUIRE(snapshot->sessions.size() == 1);
+            CHECK(beast::buffers_to_string(buffer.data()) == snapshot->sessions.begin()->second->GetState()->body);
+            CHECK(hub->GetFramesSerialized() == 0);
+        }
+    }
+
+    ioc.stop();
+    server.join();
+}
@@ -0,0 +1,279 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "../src/logger/logger.h"
+#include "../src/request_handler/file_handler.h"
+#include "../src/request_handler/http_range.h"
+#include "../src/request_handler/metrics_request_handler.h"
+#include "../src/request_handler/static_asset_index.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct RangeRoot {
+    fs::path root = fs::temp_directory_path() / "http_range_tests";
+    std::string model;
+
+    RangeRoot() {
+        fs::create_directories(root);
+        for (int i = 0; i < 1000; ++i) {
+            model.push_back(static_cast<char>('a' + i % 26));
+        }
+        std::ofstream{root / "model.glb", std::ios::binary} << model;
+    }
+
+    ~RangeRoot() {
+        fs::remove_all(root);
+    }
+};
+
+StringRequest MakeRangeRequest(std::string_view target, std::string_view range) {
+    StringRequest req{http::verb::get, target, 11};
+    req.set(http::field::range, range);
+    return req;
+}
+
+/**
+ * Обработчик статических файлов с интерфейсом обработчика запросов сервера: ответ FileHandler
+ * передаётся в send, как это делает RequestHandler
+ */
+struct FileRequestHandler {
+    FileHandler& file_handler;
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(const http_server::Endpoint&, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        std::visit([&send](auto&& response) {
+            send(std::move(response));
+        }, file_handler.HandleFileResponse(req));
+    }
+};
+
+std::string ReadFileBody(FileResponse& response) {
+    auto& file = response.body();
+    std::string result(file.GetSize(), '\0');
+    sys::error_code ec;
+    file.GetFile().seek(file.GetOffset(), ec);
+    file.GetFile().read(result.data(), result.size(), ec);
+    REQUIRE(!ec);
+    return result;
+}
+
+}  // namespace
+
+SCENARIO("Range header parsing") {
+    using Ranges = std::vector<ByteRange>;
+
+    CHECK(ParseRange("bytes=0-99", 1000)->ranges == Ranges{{0, 100}});
+    CHECK(ParseRange("bytes=900-", 1000)->ranges == Ranges{{900, 100}});
+    CHECK(ParseRange("bytes=-100", 1000)->ranges == Ranges{{900, 100}});
+    CHECK(ParseRange("bytes=990-2000", 1000)->ranges == Ranges{{990, 10}});
+    CHECK(ParseRange("bytes=-5000", 1000)->ranges == Ranges{{0, 1000}});
+    CHECK(ParseRange("bytes=0-9, 20-29", 1000)->ranges == Ranges{{0, 10}, {20, 10}});
+
+    // Невыполнимые участки отбрасываются, пустой набор означает 416
+    CHECK(ParseRange("bytes=1000-", 1000)->ranges.empty());
+    CHECK(ParseRange("bytes=0-9,2000-", 1000)->ranges == Ranges{{0, 10}});
+
+    // Некорректный заголовок игнорируется
+    CHECK(!ParseRange("items=0-9", 1000));
+    CHECK(!ParseRange("bytes=9-0", 1000));
+    CHECK(!ParseRange("bytes=a-b", 1000));
+    CHECK(!ParseRange("bytes=", 1000));
+    CHECK(!ParseRange("bytes=0-999,0-999", 1000));
+
+    CHECK(MakeContentRange({0, 100}, 1000) == "bytes 0-99/1000");
+}
+
+SCENARIO("HTTP dates") {
+    CHECK(FormatHttpDate(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+    CHECK(ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT") == 784111777);
+    CHECK(!ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT"));
+    CHECK(!ParseHttpDate(""));
+
+    CHECK(IfRangeMatches(R"("abc")", R"("abc")", 0));
+    CHECK(!IfRangeMatches(R"(W/"abc")", R"("abc")", 0));
+    CHECK(!IfRangeMatches(R"("abc")", "", 0));
+    CHECK(IfRangeMatches("Sun, 06 Nov 1994 08:49:37 GMT", "", 784111777));
+    CHECK(!IfRangeMatches("Sun, 06 Nov 1994 08:49:38 GMT", "", 784111777));
+}
+
+SCENARIO_METHOD(RangeRoot, "File handler serves ranges of files from disk") {
+    FileHandler handler(root);
+
+    WHEN("a single range is requested") {
+        auto response = handler.HandleFileResponse(MakeRangeRequest("/model.glb", "bytes=100-199"));
+
+        THEN("206 is returned with a region of the same file") {
+            REQUIRE(std::holds_alternative<FileResponse>(response));
+            auto& partial = std::get<FileResponse>(response);
+            CHECK(partial.result() == http::status::partial_content);
+            CHECK(partial[http::field::content_range] == "bytes 100-199/1000");
+            CHECK(partial[http::field::content_length] == "100");
+            CHECK(partial[http::field::accept_ranges] == "bytes");
+            CHECK(ReadFileBody(partial) == model.substr(100, 100));
+        }
+    }
+
+    WHEN("several ranges are requested") {
+        auto response = handler.HandleFileResponse(MakeRangeRequest("/model.glb", "bytes=0-9,-10"));
+
+        THEN("a multipart/byteranges body with both parts is returned") {
+            REQUIRE(std::holds_alternative<StringResponse>(response));
+            const auto& partial = std::get<StringResponse>(response);
+            CHECK(partial.result() == http::status::partial_content);
+            const std::string boundary{GetMultipartBoundary()};
+            CHECK(partial[http::field::content_type] == "multipart/byteranges; boundary=" + boundary);
+            const auto& body = partial.body();
+            CHECK(body.find("Content-Range: bytes 0-9/1000\r\n\r\n" + model.substr(0, 10) + "\r\n") != std::string::npos);
+            CHECK(body.find("Content-Range: bytes 990-999/1000\r\n\r\n" + model.substr(990) + "\r\n") != std::string::npos);
+            CHECK(body.ends_with("--" + boundary + "--\r\n"));
+        }
+    }
+
+    WHEN("several ranges are requested that together exceed the multipart buffer limit") {
+        std::ofstream{root / "big.bin", std::ios::binary} << std::string(3 * 1024 * 1024, 'x');
+        auto response = handler.HandleFileResponse(MakeRangeRequest("/big.bin", "bytes=0-1048575,-1048576"));
+
+        THEN("the whole file is sent from disk instead of a buffered multipart body") {
+            REQUIRE(std::holds_alternative<FileResponse>(response));
+            auto& full = std::get<FileResponse>(response);
+            CHECK(full.result() == http::status::ok);
+            CHECK(full.body().GetSize() == 3 * 1024 * 1024);
+        }
+    }
+
+    WHEN("the range starts beyond the end of the file") {
+        auto response = handler.HandleFileResponse(MakeRangeRequest("/model.glb", "bytes=5000-"));
+
+        THEN("416 is returned with the file size") {
+            REQUIRE(std::holds_alternative<StringResponse>(response));
+            const auto& error = std::get<StringResponse>(response);
+            CHECK(error.result() == http::status::range_not_satisfiable);
+            CHECK(error[http::field::content_range] == "bytes */1000");
+        }
+    }
+
+    WHEN("the file has not changed since the client's copy") {
+        StringRequest req{http::verb::get, "/model.glb", 11};
+        auto full = handler.HandleFileResponse(req);
+        REQUIRE(std::holds_alternative<FileResponse>(full));
+        const std::string last_modified{std::get<FileResponse>(full)[http::field::last_modified]};
+        REQUIRE(!last_modified.empty());
+
+        req.set(http::field::if_modified_since, last_modified);
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("304 is returned") {
+            REQUIRE(std::holds_alternative<StringResponse>(response));
+            CHECK(std::get<StringResponse>(response).result() == http::status::not_modified);
+        }
+    }
+
+    WHEN("If-Range does not match the file") {
+        auto req = MakeRangeRequest("/model.glb", "bytes=0-9");
+        req.set(http::field::if_range, "Sun, 06 Nov 1994 08:49:37 GMT");
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("the whole file is returned") {
+            REQUIRE(std::holds_alternative<FileResponse>(response));
+            auto& full = std::get<FileResponse>(response);
+            CHECK(full.result() == http::status::ok);
+            CHECK(full.body().GetSize() == model.size());
+        }
+    }
+}
+
+SCENARIO_METHOD(RangeRoot, "File handler serves ranges of indexed files") {
+    const auto index = StaticAssetIndex::Build(root);
+    const auto asset = index->Find("/model.glb");
+    FileHandler handler(root, index);
+
+    WHEN("a range is requested with a matching If-Range ETag") {
+        auto req = MakeRangeRequest("/model.glb", "bytes=-100");
+        req.set(http::field::if_range, asset->etag);
+        req.set(http::field::accept_encoding, "gzip");
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("the range of the identity content is returned from memory") {
+            REQUIRE(std::holds_alternative<SharedBufferResponse>(response));
+            const auto& partial = std::get<SharedBufferResponse>(response);
+            CHECK(partial.result() == http::status::partial_content);
+            CHECK(partial.body().data == model.substr(900));
+            CHECK(partial[http::field::content_range] == "bytes 900-999/1000");
+            CHECK(partial[http::field::content_encoding].empty());
+            CHECK(partial[http::field::last_modified] == asset->last_modified_date);
+        }
+    }
+
+    WHEN("If-Range carries another ETag") {
+        auto req = MakeRangeRequest("/model.glb", "bytes=0-9");
+        req.set(http::field::if_range, R"("stale")");
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("the whole file is returned") {
+            REQUIRE(std::holds_alternative<SharedBufferResponse>(response));
+            const auto& full = std::get<SharedBufferResponse>(response);
+            CHECK(full.result() == http::status::ok);
+            CHECK(full.body().data == model);
+            CHECK(full[http::field::accept_ranges] == "bytes");
+        }
+    }
+
+    WHEN("the client's copy is not older than Last-Modified") {
+        StringRequest req{http::verb::get, "/model.glb", 11};
+        req.set(http::field::if_modified_since, asset->last_modified_date);
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("304 is returned") {
+            REQUIRE(std::holds_alternative<StringResponse>(response));
+            CHECK(std::get<StringResponse>(response).result() == http::status::not_modified);
+        }
+    }
+}
+
+SCENARIO_METHOD(RangeRoot, "File responses without a body pass through the server decorators") {
+    // Те же декораторы, что и в main: журнал запросов и метрики
+    const auto index = StaticAssetIndex::Build(root);
+    FileHandler file_handler(root, index);
+    FileRequestHandler file_request_handler{file_handler};
+    server_logging::LoggingRequestHandler logging_handler{file_request_handler};
+    metrics::ServerMetrics server_metrics(MetricsEndpoints::Labels());
+    MetricsRequestHandler handler(logging_handler, server_metrics);
+    auto send_request = [&handler](StringRequest req) {
+        std::optional<http::status> status;
+        handler(http_server::Endpoint{}, std::move(req), [&status](auto&& response) {
+            status = response.result();
+        });
+        return status;
+    };
+
+    WHEN("a conditional GET matches the client's copy") {
+        StringRequest req{http::verb::get, "/model.glb", 11};
+        req.set(http::field::if_none_match, index->Find("/model.glb")->etag);
+
+        THEN("304 without Content-Type is sent and logged") {
+            CHECK(send_request(std::move(req)) == http::status::not_modified);
+        }
+    }
+
+    WHEN("the requested range cannot be satisfied") {
+        THEN("416 without Content-Type is sent and logged") {
+            CHECK(send_request(MakeRangeRequest("/model.glb", "bytes=5000-")) == http::status::range_not_satisfiable);
+        }
+    }
+
+    WHEN("a file that is not in the index cannot satisfy the range") {
+        std::ofstream{root / "late.bin", std::ios::binary} << model;
+
+        THEN("416 is sent from the disk path as well") {
+            CHECK(send_request(MakeRangeRequest("/late.bin", "bytes=5000-")) == http::status::range_not_satisfiable);
+        }
+    }
+}
@@ -0,0 +1,424 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "allocation_counter.h"
+#include "../src/http_server/http_server.h"
+
+using namespace std::literals;
+using namespace http_server;
+
+namespace {
+
+// Обработчик, отвечающий фиксированным телом. Собственные выделения памяти обработчика
+// (поля заголовка ответа) не относятся к сессии и вычитаются из общего счёта
+struct FixedResponseHandler {
+    std::atomic<std::size_t>* handler_allocations;
+
+    template <typename Request, typename Send>
+    void operator()(const Endpoint& /*endpoint*/, Request&& req, Send&& send) {
+        const std::size_t before = test_util::GetAllocations();
+        http::response<http::string_body> response{http::status::ok, req.version()};
+        response.body() = "{}";
+        response.prepare_payload();
+        *handler_allocations += test_util::GetAllocations() - before;
+        send(std::move(response));
+    }
+};
+
+// Обработчик, отвечающий телом, равным request-target. На запрос /slow отвечает с задержкой,
+// так что ответы на следующие за ним запросы оказываются готовы раньше
+struct EchoTargetHandler {
+    net::io_context* ioc;
+
+    template <typename Request, typename Send>
+    void operator()(const Endpoint& /*endpoint*/, Request&& req, Send&& send) {
+        http::response<http::string_body> response{http::status::ok, req.version()};
+        response.body() = std::string(req.target());
+        response.keep_alive(req.keep_alive());
+        response.prepare_payload();
+        if (req.target() != "/slow") {
+            return send(std::move(response));
+        }
+        auto timer = std::make_shared<net::steady_timer>(*ioc, 50ms);
+        timer->async_wait([timer, response = std::move(response), send = std::forward<Send>(send)](sys::error_code) mutable {
+            send(std::move(response));
+        });
+    }
+};
+
+// Обработчик, отдающий файл телом FileRegionBody, а на запрос /text - строку
+struct FileRegionHandler {
+    std::filesystem::path file;
+
+    template <typename Request, typename Send>
+    void operator()(const Endpoint& /*endpoint*/, Request&& req, Send&& send) {
+        if (req.target() == "/shared") {
+            auto content = std::make_shared<const std::string>("shared content");
+            http::response<SharedBufferBody> response{http::status::ok, req.version()};
+            response.body().data = *content;
+            response.body().owner = std::move(content);
+            response.prepare_payload();
+            return send(std::move(response));
+        }
+        if (req.target() == "/text") {
+            http::response<http::string_body> response{http::status::ok, req.version()};
+            response.body() = "text";
+            response.prepare_payload();
+            return send(std::move(response));
+        }
+        http::response<FileRegionBody> response{http::status::ok, req.version()};
+        beast::error_code ec;
+        response.body().Open(file.c_str(), ec);
+        REQUIRE(!ec);
+        response.prepare_payload();
+        send(std::move(response));
+    }
+};
+
+}  // namespace
+
+SCENARIO("Keep-alive session does not allocate memory per request") {
+    constexpr std::size_t WARM_UP_REQUESTS = 100;
+    constexpr std::size_t REQUESTS = 10'000;
+    // Запрос и его поля размещаются в памяти сессии и переиспользуются. Оставшиеся выделения (замерено ровно 3) -
+    // в таймере тайм-аута beast::basic_stream, который не использует ассоциированный аллокатор обработчика:
+    // две копии strand в any_io_executor таймера (при ожидании чтения и записи) и операция ожидания при чтении
+    constexpr std::size_t MAX_ALLOCATIONS_PER_REQUEST = 3;
+
+    GIVEN("a server with one keep-alive connection") {
+        net::io_context ioc;
+        std::atomic<std::size_t> handler_allocations{0};
+        auto listener = std::make_shared<Listener<FixedResponseHandler>>(
+                ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, FixedResponseHandler{&handler_allocations});
+        listener->Run();
+        const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+
+        net::post(ioc, [] { test_util::CountAllocations(true); });
+        std::thread server([&ioc] { ioc.run(); });
+
+        tcp::socket client(ioc);
+        client.connect(endpoint);
+        beast::flat_buffer buffer;
+        auto send_request = [&client, &buffer] {
+            constexpr std::string_view request = "GET /api/v1/maps HTTP/1.1\r\n\r\n";
+            net::write(client, net::buffer(request));
+            http::response<http::string_body> response;
+            http::read(client, buffer, response);
+            return response.result();
+        };
+
+        for (std::size_t i = 0; i < WARM_UP_REQUESTS; ++i) {
+            REQUIRE(send_request() == http::status::ok);
+        }
+
+        WHEN("10k requests are sent through the session") {
+            const std::size_t allocations_before = test_util::GetAllocations();
+            const std::size_t handler_allocations_before = handler_allocations.load();
+            for (std::size_t i = 0; i < REQUESTS; ++i) {
+                REQUIRE(send_request() == http::status::ok);
+            }
+            const std::size_t session_allocations = (test_util::GetAllocations() - allocations_before)
+                                                  - (handler_allocations.load() - handler_allocations_before);
+
+            THEN("session machinery does not allocate handlers and responses per request") {
+                CHECK(session_allocations <= REQUESTS * MAX_ALLOCATIONS_PER_REQUEST);
+            }
+        }
+
+        client.close();
+        ioc.stop();
+        server.join();
+    }
+}
+
+SCENARIO("Pipelined requests are answered in request order") {
+    GIVEN("a server with limited pipeline depth") {
+        net::io_context ioc;
+        auto listener = std::make_shared<Listener<EchoTargetHandler>>(
+                ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, EchoTargetHandler{&ioc},
+                ServerOptions{.pipeline_depth = 2});
+        listener->Run();
+        const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+        std::thread server([&ioc] { ioc.run(); });
+
+        tcp::socket client(ioc);
+        client.connect(endpoint);
+
+        WHEN("several requests are sent in one packet and the first one is answered last") {
+            const std::vector<std::string> targets{"/slow", "/a", "/b", "/slow", "/c"};
+            std::string requests;
+            for (const auto& target : targets) {
+                requests += "GET " + target + " HTTP/1.1\r\n\r\n";
+            }
+            net::write(client, net::buffer(requests));
+
+            THEN("responses come in the same order as requests") {
+                beast::flat_buffer buffer;
+                for (const auto& target : targets) {
+                    http::response<http::string_body> response;
+                    http::read(client, buffer, response);
+                    CHECK(response.body() == target);
+                }
+            }
+        }
+
+        WHEN("the last request asks to close the connection") {
+            net::write(client, net::buffer("GET /slow HTTP/1.1\r\n\r\nGET /a HTTP/1.1\r\nConnection: close\r\n\r\n"sv));
+
+            THEN("both responses are sent before the connection is closed") {
+                beast::flat_buffer buffer;
+                http::response<http::string_body> first;
+                http::read(client, buffer, first);
+                CHECK(first.body() == "/slow"sv);
+                http::response<http::string_body> second;
+                http::read(client, buffer, second);
+                CHECK(second.body() == "/a"sv);
+                CHECK(second.need_eof());
+
+                beast::error_code ec;
+                http::response<http::string_body> none;
+                http::read(client, buffer, none, ec);
+                CHECK(ec == http::error::end_of_stream);
+            }
+        }
+
+        client.close();
+        ioc.stop();
+        server.join();
+    }
+}
+
+SCENARIO("Listener pauses accept when the session limit is reached") {
+    GIVEN("a server limited to one session") {
+        net::io_context ioc;
+        std::atomic<std::size_t> handler_allocations{0};
+        auto listener = std::make_shared<Listener<FixedResponseHandler>>(
+                ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, FixedResponseHandler{&handler_allocations},
+                ServerOptions{.max_sessions = 1});
+        listener->Run();
+        const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+        std::thread server([&ioc] { ioc.run(); });
+
+        constexpr std::string_view request = "GET /api/v1/maps HTTP/1.1\r\n\r\n";
+        tcp::socket first(ioc);
+        first.connect(endpoint);
+        net::write(first, net::buffer(request));
+        beast::flat_buffer first_buffer;
+        http::response<http::string_body> first_response;
+        http::read(first, first_buffer, first_response);
+        REQUIRE(first_response.result() == http::status::ok);
+
+        WHEN("the second client connects while the first session is open") {
+            tcp::socket second(ioc);
+            second.connect(endpoint);
+            net::write(second, net::buffer(request));
+            std::this_thread::sleep_for(100ms);
+
+            THEN("the second connection is not served until the first one is closed") {
+                CHECK(second.available() == 0);
+                CHECK(listener->GetActiveSessions() == 1);
+                CHECK(listener->GetAcceptPauses() == 1);
+
+                first.shutdown(tcp::socket::shutdown_send);
+                first.close();
+
+                beast::flat_buffer buffer;
+                http::response<http::string_body> response;
+                http::read(second, buffer, response);
+                CHECK(response.result() == http::status::ok);
+            }
+        }
+
+        ioc.stop();
+        server.join();
+    }
+}
+
+SCENARIO("File region responses are sent after the header") {
+    const auto file = std::filesystem::temp_directory_path() / "http_server_tests_file_region.bin";
+    std::string content;
+    // Файл больше буфера сокета, чтобы sendfile выполнялся в несколько приёмов
+    for (std::size_t i = 0; content.size() < 3 * 1024 * 1024; ++i) {
+        content += std::to_string(i * 7919) + ",";
+    }
+    std::ofstream{file, std::ios::binary} << content;
+
+    for (const bool use_sendfile : {true, false}) {
+        GIVEN("a server with sendfile "s + (use_sendfile ? "enabled"s : "disabled"s)) {
+            net::io_context ioc;
+            auto listener = std::make_shared<Listener<FileRegionHandler>>(
+                    ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, FileRegionHandler{file},
+                    ServerOptions{.use_sendfile = use_sendfile});
+            listener->Run();
+            const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+            std::thread server([&ioc] { ioc.run(); });
+
+            tcp::socket client(ioc);
+            client.connect(endpoint);
+
+            WHEN("the file is requested in a pipeline with shared buffer and text responses") {
+                net::write(client, net::buffer("GET /shared HTTP/1.1\r\n\r\nGET /file HTTP/1.1\r\n\r\nGET /text HTTP/1.1\r\n\r\n"sv));
+
+                THEN("responses are received in request order") {
+                    beast::flat_buffer buffer;
+                    http::response<http::string_body> shared;
+                    http::read(client, buffer, shared);
+                    CHECK(shared.body() == "shared content"sv);
+
+                    http::response_parser<http::string_body> parser;
+                    parser.body_limit(content.size());
+                    http::read(client, buffer, parser);
+                    CHECK(parser.get().body() == content);
+
+                    http::response<http::string_body> text;
+                    http::read(client, buffer, text);
+                    CHECK(text.body() == "text"sv);
+                }
+            }
+
+            client.close();
+            ioc.stop();
+            server.join();
+        }
+    }
+    std::filesystem::remove(file);
+}
+
+SCENARIO("Upgrade requests are handed over to the upgrade handler") {
+    GIVEN("a server with a WebSocket echo upgrade handler") {
+        net::io_context ioc;
+        std::atomic<std::size_t> handler_allocations{0};
+        ServerOptions options;
+        options.upgrade = [](StrandSocket&& socket, HttpRequest&& request) {
+            auto ws = std::make_shared<beast::websocket::stream<Stream>>(std::move(socket));
+            auto req = std::make_shared<HttpRequest>(std::move(request));
+            ws->async_accept(*req, [ws, req](beast::error_code ec) {
+                REQUIRE(!ec);
+                auto buffer = std::make_shared<beast::flat_buffer>();
+                ws->async_read(*buffer, [ws, buffer](beast::error_code ec, std::size_t) {
+                    REQUIRE(!ec);
+                    ws->text(true);
+                    ws->async_write(buffer->data(), [ws, buffer](beast::error_code, std::size_t) {});
+                });
+            });
+        };
+        auto listener = std::make_shared<Listener<FixedResponseHandler>>(
+                ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, FixedResponseHandler{&handler_allocations},
+                std::move(options));
+        listener->Run();
+        const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+        std::thread server([&ioc] { ioc.run(); });
+
+        tcp::socket client(ioc);
+        client.connect(endpoint);
+
+        WHEN("a keep-alive request is followed by a WebSocket handshake on the same connection") {
+            net::write(client, net::buffer("GET / HTTP/1.1\r\n\r\n"sv));
+            beast::flat_buffer buffer;
+            http::response<http::string_body> response;
+            http::read(client, buffer, response);
+            REQUIRE(response.body() == "{}"sv);
+
+            beast::websocket::stream<tcp::socket&> ws(client);
+            ws.handshake("127.0.0.1", "/ws");
+
+            THEN("messages are exchanged over the upgraded connection") {
+                ws.write(net::buffer("ping"sv));
+                beast::flat_buffer message;
+                ws.read(message);
+                CHECK(beast::buffers_to_string(message.data()) == "ping");
+            }
+        }
+
+        client.close();
+        ioc.stop();
+        server.join();
+    }
+}
+
+SCENARIO("Upgrade request pipelined after an unanswered request") {
+    GIVEN("a server whose upgrade handler reports the request it received") {
+        net::io_context ioc;
+        auto upgraded = std::make_shared<std::promise<std::string>>();
+        ServerOptions options;
+        options.upgrade = [upgraded](StrandSocket&& /*socket*/, HttpRequest&& request) {
+            upgraded->set_value(std::string(request.target()));
+        };
+        auto listener = std::make_shared<Listener<EchoTargetHandler>>(
+                ioc, tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, EchoTargetHandler{&ioc}, std::move(options));
+        listener->Run();
+        const auto endpoint = *ToTcpEndpoint(listener->GetLocalEndpoint());
+        std::thread server([&ioc] { ioc.run(); });
+
+        tcp::socket client(ioc);
+        client.connect(endpoint);
+
+        WHEN("a WebSocket handshake is sent right after a request that is answered later") {
+            net::write(client, net::buffer("GET /slow HTTP/1.1\r\n\r\n"
+                                           "GET /ws HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\n"
+                                           "Connection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                           "Sec-WebSocket-Version: 13\r\n\r\n"sv));
+
+            THEN("the first request is answered and then the connection is handed over to the upgrade handler") {
+                beast::flat_buffer buffer;
+                http::response<http::string_body> response;
+                http::read(client, buffer, response);
+                CHECK(response.body() == "/slow"sv);
+
+                auto target = upgraded->get_future();
+                REQUIRE(target.wait_for(5s) == std::future_status::ready);
+                CHECK(target.get() == "/ws"sv);
+            }
+        }
+
+        client.close();
+        ioc.stop();
+        server.join();
+    }
+}
+
+SCENARIO("Server listens on a Unix domain socket") {
+    GIVEN("a listener bound to an abstract Unix socket") {
+        net::io_context ioc;
+        const net::local::stream_protocol::endpoint endpoint{"\0http_server_tests"s + std::to_string(::getpid())};
+        auto listener = std::make_shared<Listener<EchoTargetHandler>>(ioc, endpoint, EchoTargetHandler{&ioc});
+        listener->Run();
+        std::thread server([&ioc] { ioc.run(); });
+
+        WHEN("a pipeline of requests is sent over the socket") {
+            net::local::stream_protocol::socket client(ioc);
+            client.connect(endpoint);
+            net::write(client, net::buffer("GET /slow HTTP/1.1\r\n\r\nGET /fast HTTP/1.1\r\n\r\n"sv));
+
+            THEN("responses arrive in order as over TCP") {
+                beast::flat_buffer buffer;
+                http::response<http::string_body> first;
+                http::read(client, buffer, first);
+                CHECK(first.body() == "/slow"sv);
+                http::response<http::string_body> second;
+                http::read(client, buffer, second);
+                CHECK(second.body() == "/fast"sv);
+            }
+        }
+
+        ioc.stop();
+        server.join();
+    }
+}
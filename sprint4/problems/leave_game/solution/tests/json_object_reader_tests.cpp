@@ -0,0 +1,264 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "../src/request_handler/api_handler.h"
+
+using namespace http_handler;
+using namespace detail;
+using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+// Прежний разбор тел запросов через boost::json, с которым сравнивается JsonObjectReader
+
+std::optional<std::string_view> ReferenceMove(std::string_view body) {
+    json::error_code ec;
+    const auto value = json::parse(body, ec);
+    const auto* obj = ec ? nullptr : value.if_object();
+    const auto* move = obj ? obj->if_contains(UserKey::MOVE) : nullptr;
+    if (!move || !move->is_string()) {
+        return std::nullopt;
+    }
+    return app::ActionInbox::ParseDirection(move->get_string());
+}
+
+std::optional<ApiHandler::JoinRequest> ReferenceJoin(std::string_view body) {
+    try {
+        const auto obj = json::parse(body).as_object();
+        return ApiHandler::JoinRequest{std::string{obj.at(UserKey::USER_NAME).as_string()},
+                                       std::string{obj.at(UserKey::MAP_ID).as_string()}};
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<std::int64_t> ReferenceTimeDelta(std::string_view body) {
+    try {
+        return json::parse(body).as_object().at(UserKey::TIME_INTERVAL).as_int64();
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+void CheckAgainstReference(std::string_view body) {
+    INFO("body: " << body);
+    CHECK(ApiHandler::ParseMove(body) == ReferenceMove(body));
+    CHECK(ApiHandler::ParseJoin(body) == ReferenceJoin(body));
+    CHECK(ApiHandler::ParseTimeDelta(body) == ReferenceTimeDelta(body));
+}
+
+/**
+ * Случайные JSON-документы с полями запросов, вложенными контейнерами и значениями на границах типов
+ */
+class DocumentGenerator {
+public:
+    explicit DocumentGenerator(std::uint32_t seed) : random_(seed) {}
+
+    std::string Object() {
+        std::string out = "{";
+        WriteMembers(out, 1);
+        out += '}';
+        return out;
+    }
+
+private:
+    void WriteMembers(std::string& out, std::size_t depth) {
+        const std::string_view keys[] = {"move"sv, "userName"sv, "mapId"sv, "timeDelta"sv, "x"sv,
+                                         R"(mo\u0076e)"sv, R"(map\u0049d)"sv, ""sv};
+        const auto count = random_() % 4;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i > 0) {
+                out += Pick({","sv, " , "sv, ",\n"sv});
+            }
+            out += '"';
+            out += keys[random_() % std::size(keys)];
+            out += Pick({R"(":)"sv, R"(" : )"sv});
+            WriteValue(out, depth);
+        }
+    }
+
+    void WriteValue(std::string& out, std::size_t depth) {
+        switch (random_() % 8) {
+            case 0:
+                out += Pick({R"("L")"sv, R"("R")"sv, R"("U")"sv, R"("D")"sv, R"("")"sv, R"("X")"sv, R"("L")"sv,
+                             R"("Шарик")"sv, R"("map1")"sv, R"("a\"b\\c\/\n\t")"sv, R"("😀")"sv});
+                return;
+            case 1:
+                out += Pick({"0"sv, "-0"sv, "100"sv, "-100"sv, "9223372036854775807"sv, "9223372036854775808"sv,
+                             "-9223372036854775808"sv, "-9223372036854775809"sv, "18446744073709551615"sv,
+                             "18446744073709551616"sv, "100.0"sv, "1e2"sv, "1E+2"sv, "0.5e-3"sv, "1e2147483647"sv});
+                return;
+            case 2:
+                out += Pick({"true"sv, "false"sv, "null"sv});
+                return;
+            case 3:
+            case 4:
+                // Глубина вокруг MAX_DEPTH, чтобы проверить ограничение вложенности
+                if (depth < JsonObjectReader::MAX_DEPTH + 2) {
+                    if (random_() % 2 == 0) {
+                        out += '{';
+                        WriteMembers(out, depth + 1);
+                        out += '}';
+                    } else {
+                        out += '[';
+                        const auto count = random_() % 3;
+                        for (std::size_t i = 0; i < count; ++i) {
+                            out += i > 0 ? ","sv : ""sv;
+                            WriteValue(out, depth + 1);
+                        }
+                        out += ']';
+                    }
+                    return;
+                }
+                [[fallthrough]];
+            default:
+                out += R"("map1")"sv;
+        }
+    }
+
+    std::string_view Pick(std::initializer_list<std::string_view> values) {
+        return values.begin()[random_() % values.size()];
+    }
+
+    std::mt19937 random_;
+};
+
+/**
+ * Повреждает документ: заменяет, вставляет или удаляет байты, обрезает его
+ */
+std::string Mutate(std::string body, std::mt19937& random) {
+    constexpr std::string_view ALPHABET = "{}[]\":,\\ \t\n-+.eE0123456789tfnu";
+    const auto mutations = 1 + random() % 3;
+    for (std::size_t i = 0; i < mutations && !body.empty(); ++i) {
+        const auto pos = random() % body.size();
+        const char c = random() % 4 == 0 ? static_cast<char>(random() % 256) : ALPHABET[random() % ALPHABET.size()];
+        switch (random() % 4) {
+            case 0:
+                body[pos] = c;
+                break;
+            case 1:
+                body.insert(body.begin() + static_cast<std::ptrdiff_t>(pos), c);
+                break;
+            case 2:
+                body.erase(pos, 1 + random() % 3);
+                break;
+            default:
+                body.resize(pos);
+        }
+    }
+    return body;
+}
+
+}  // namespace
+
+SCENARIO("Request bodies are parsed without a document") {
+    THEN("well-formed bodies are read") {
+        CHECK(ApiHandler::ParseMove(R"({"move": "L"})"sv) == model::Movement::LEFT);
+        CHECK(ApiHandler::ParseMove(R"({"move": ""})"sv) == model::Movement::STOP);
+        CHECK(ApiHandler::ParseMove(R"({"move": "R"})"sv) == model::Movement::RIGHT);
+        CHECK(ApiHandler::ParseTimeDelta(R"( {"timeDelta":100} )"sv) == 100);
+        const auto join = ApiHandler::ParseJoin(R"({"userName": "Шарик", "mapId": "map1", "extra": [1, {}]})"sv);
+        REQUIRE(join.has_value());
+        CHECK(join->user_name == "Шарик"s);
+        CHECK(join->map_id == "map1"s);
+    }
+
+    THEN("the last of repeated fields is used") {
+        CHECK(ApiHandler::ParseMove(R"({"move": "L", "move": "U"})"sv) == model::Movement::UP);
+        CHECK(!ApiHandler::ParseMove(R"({"move": "L", "move": 1})"sv));
+    }
+
+    THEN("malformed bodies and values of other types are rejected") {
+        for (const auto body : {""sv, "{"sv, "[]"sv, R"("move")"sv, R"({"move": "L",})"sv, R"({"move": "L"} {})"sv,
+                                R"({'move': 'L'})"sv, R"({"move": L})"sv, R"({"move": "L" /* */})"sv,
+                                R"({"move": "\ud800"})"sv, "{\"move\": \"\xff\"}"sv, R"({"move": "l"})"sv}) {
+            CHECK(!ApiHandler::ParseMove(body));
+        }
+        CHECK(!ApiHandler::ParseTimeDelta(R"({"timeDelta": 100.0})"sv));
+        CHECK(!ApiHandler::ParseTimeDelta(R"({"timeDelta": 9223372036854775808})"sv));
+        CHECK(!ApiHandler::ParseTimeDelta(R"({"timeDelta": "100"})"sv));
+        CHECK(!ApiHandler::ParseJoin(R"({"userName": "Шарик"})"sv));
+        CHECK(!ApiHandler::ParseJoin(R"({"userName": null, "mapId": "map1"})"sv));
+    }
+
+    THEN("a command without escapes does not allocate") {
+        const auto body = R"({"move": "L"})"sv;
+        test_util::CountAllocations(true);
+        const std::size_t before = test_util::GetAllocations();
+        const auto direction = ApiHandler::ParseMove(body);
+        const std::size_t allocations = test_util::GetAllocations() - before;
+        test_util::CountAllocations(false);
+        CHECK(direction == model::Movement::LEFT);
+        CHECK(allocations == 0);
+    }
+}
+
+SCENARIO("Request body parser agrees with boost::json") {
+    constexpr std::size_t DOCUMENTS = 20'000;
+    constexpr std::size_t MUTATIONS_PER_DOCUMENT = 5;
+
+    GIVEN("handwritten edge cases") {
+        const std::vector<std::string> bodies{
+            R"({"move":"L"})", R"({"timeDelta":-0})", R"({"timeDelta":-9223372036854775808})",
+            R"({"timeDelta":1e2147483648})", R"({"timeDelta":01})", R"({"timeDelta":1.})", R"({"timeDelta":.5})",
+            R"({"move":"􏿿"})", R"({"move":"\ud83dA"})", R"({"move":"\x"})",
+            "{\"move\":\"\xed\xa0\x80\"}", "{\"move\":\"\xc0\x80\"}", "{\"move\":\"\xf4\x90\x80\x80\"}",
+            "{\"move\":\"\t\"}", "\xef\xbb\xbf{}", "{}\n", "{}\f", " \r\n\t{ } ",
+            R"({"userName":"a","mapId":"b","userName":"c"})",
+            std::string(JsonObjectReader::MAX_DEPTH - 1, '[') + std::string(JsonObjectReader::MAX_DEPTH - 1, ']'),
+            "{\"a\":" + std::string(JsonObjectReader::MAX_DEPTH - 1, '[') + std::string(JsonObjectReader::MAX_DEPTH - 1, ']') + "}",
+            "{\"a\":" + std::string(JsonObjectReader::MAX_DEPTH, '[') + std::string(JsonObjectReader::MAX_DEPTH, ']') + "}",
+        };
+
+        THEN("the results are the same") {
+            for (const auto& body : bodies) {
+                CheckAgainstReference(body);
+            }
+        }
+    }
+
+    GIVEN("random documents and their damaged copies") {
+        DocumentGenerator generator(42);
+        std::mt19937 random(7);
+
+        THEN("the results are the same") {
+            for (std::size_t i = 0; i < DOCUMENTS; ++i) {
+                const auto document = generator.Object();
+                CheckAgainstReference(document);
+                for (std::size_t j = 0; j < MUTATIONS_PER_DOCUMENT; ++j) {
+                    CheckAgainstReference(Mutate(document, random));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Request body parsing: boost::json against JsonObjectReader", "[.][benchmark]") {
+    const auto action = R"({"move": "L"})"sv;
+    const auto tick = R"({"timeDelta": 100})"sv;
+
+    BENCHMARK("/action: boost::json") {
+        return ReferenceMove(action);
+    };
+
+    BENCHMARK("/action: JsonObjectReader") {
+        return ApiHandler::ParseMove(action);
+    };
+
+    BENCHMARK("/tick: boost::json") {
+        return ReferenceTimeDelta(tick);
+    };
+
+    BENCHMARK("/tick: JsonObjectReader") {
+        return ApiHandler::ParseTimeDelta(tick);
+    };
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/json/json_model_writer.h"
+#include "../src/request_handler/api_handler.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace json = boost::json;
+
+namespace {
+
+struct WriterFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto token = app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(i)).first;
+            players.push_back(app.FindPlayer(token));
+        }
+    }
+
+    model::GameSession& GetSession() {
+        return *players.front()->GetSession();
+    }
+
+    // Собаки разбегаются в разные стороны, на карте появляются предметы
+    void Play(std::size_t ticks) {
+        const std::string_view directions[] = {"L"sv, "R"sv, "U"sv, "D"sv};
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            players[i]->DogMove(directions[i % std::size(directions)], 4.0);
+        }
+        for (std::size_t i = 0; i < ticks; ++i) {
+            app.Tick(1s);
+        }
+    }
+};
+
+std::string Write(auto&& write) {
+    std::string out;
+    detail::JsonWriter writer(out);
+    write(writer);
+    return out;
+}
+
+}  // namespace
+
+SCENARIO("Streaming JSON writer") {
+    THEN("commas are placed between elements of nested containers") {
+        CHECK(Write([](detail::JsonWriter& w) {
+            w.StartObject();
+            w.Key("a"sv);
+            w.StartArray();
+            w.Int(-1);
+            w.Uint(std::numeric_limits<std::uint64_t>::max());
+            w.StartObject();
+            w.EndObject();
+            w.Bool(false);
+            w.Null();
+            w.EndArray();
+            w.Key("b"sv);
+            w.String(""sv);
+            w.EndObject();
+        }) == R"({"a":[-1,18446744073709551615,{},false,null],"b":""})"s);
+    }
+
+    THEN("doubles are written in the shortest form that stays a double") {
+        CHECK(Write([](auto& w) { w.Double(1.0); }) == "1.0"s);
+        CHECK(Write([](auto& w) { w.Double(-0.25); }) == "-0.25"s);
+        CHECK(Write([](auto& w) { w.Double(0.1); }) == "0.1"s);
+        CHECK(Write([](auto& w) { w.Double(1e300); }) == "1e+300"s);
+        CHECK(Write([](auto& w) { w.Double(std::numeric_limits<double>::infinity()); }) == "null"s);
+        CHECK(json::parse(Write([](auto& w) { w.Double(1.0); })).is_double());
+    }
+
+    GIVEN("strings with characters that must be escaped") {
+        const std::vector<std::string> strings{
+            "Шарик"s,
+            "a long string without special characters"s,
+            "quote \" and backslash \\ in the middle of a long string"s,
+            "\b\f\n\r\t"s,
+            std::string("\x01\x1f\0", 3),
+            std::string(15, 'x') + '"',
+        };
+
+        THEN("they are read back unchanged") {
+            for (const auto& s : strings) {
+                const auto text = Write([&s](auto& w) { w.String(s); });
+                CHECK(json::parse(text).as_string() == s);
+            }
+            CHECK(Write([](auto& w) { w.String("\n\x01"sv); }) == R"("\n\u0001")"s);
+        }
+    }
+}
+
+SCENARIO_METHOD(WriterFixture, "Model serialization without a document") {
+    Join(5);
+    Play(10);
+    GetSession().AddLoot(model::Loot{model::Loot::Id{1'000}, 10, {1.5, 0.25}, 1});
+
+    THEN("maps are written as by tag_invoke") {
+        for (const auto& map : app.GetMaps()) {
+            CHECK(json::parse(model::SerializeJson(*map)) == json::value_from(*map));
+        }
+        CHECK(json::parse(model::SerializeJson(app.GetMaps())) == json::value_from(app.GetMaps()));
+    }
+
+    THEN("dogs and lost objects are written as by tag_invoke") {
+        for (const auto& [id, dog] : GetSession().GetDogs()) {
+            CHECK(json::parse(model::SerializeJson(*dog)) == json::value_from(*dog));
+        }
+        for (const auto& [id, loot] : GetSession().GetLoots()) {
+            CHECK(json::parse(model::SerializeJson(loot)) == json::value_from(loot));
+        }
+    }
+
+    THEN("the game state matches the document built by MakeGameState") {
+        std::string state;
+        http_handler::ApiHandler::WriteGameState(GetSession(), state);
+        CHECK(json::parse(state).as_object() == http_handler::ApiHandler::MakeGameState(GetSession()));
+    }
+}
+
+TEST_CASE_METHOD(WriterFixture, "Response serialization: document against streaming writer", "[.][benchmark]") {
+    Join(100);
+    Play(5);
+
+    std::string state;
+    http_handler::ApiHandler::WriteGameState(GetSession(), state);
+    const auto map = app.FindMap(model::Map::Id{"map1"s});
+    REQUIRE(map);
+    const auto map_size = model::SerializeJson(*map).size();
+
+    // Пропускная способность в байтах в секунду: размер тела, делённый на среднее время из отчёта
+    WARN("/state of 100 dogs: " << state.size() << " bytes, /maps/map1: " << map_size << " bytes");
+
+    BENCHMARK("/state: boost::json document") {
+        return json::serialize(http_handler::ApiHandler::MakeGameState(GetSession())).size();
+    };
+
+    // Буфер переиспользуется, как строка тела снимка
+    BENCHMARK("/state: streaming writer") {
+        state.clear();
+        http_handler::ApiHandler::WriteGameState(GetSession(), state);
+        return state.size();
+    };
+
+    BENCHMARK("/maps/map1: boost::json document") {
+        return json::serialize(json::value_from(*map)).size();
+    };
+
+    BENCHMARK("/maps/map1: streaming writer") {
+        return model::SerializeJson(*map).size();
+    };
+}
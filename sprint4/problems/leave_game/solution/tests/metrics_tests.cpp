@@ -0,0 +1,220 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../src/request_handler/metrics_request_handler.h"
+
+using namespace http_handler;
+using namespace metrics;
+using namespace std::literals;
+
+namespace {
+
+/**
+ * Обработчик, отвечающий на любой запрос заданным кодом
+ */
+struct StatusHandler {
+    http::status status = http::status::ok;
+
+    template <typename Body, typename Allocator, typename Send>
+    void operator()(const http_server::Endpoint&, http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+        send(MakeTextResponse(req, status, "{}"sv));
+    }
+};
+
+bool Contains(std::string_view text, std::string_view line) {
+    return text.find(line) != std::string_view::npos;
+}
+
+}  // namespace
+
+SCENARIO("Histogram buckets") {
+    THEN("small values are stored exactly") {
+        for (std::uint64_t value = 0; value < 2 * Histogram::SUB_COUNT; ++value) {
+            CHECK(Histogram::BucketIndex(value) == value);
+            CHECK(Histogram::BucketUpperBound(value) == value);
+        }
+    }
+
+    THEN("buckets follow each other without gaps and are narrower than 1/SUB_COUNT of their values") {
+        for (std::size_t index = 0; index + 1 < Histogram::BUCKETS; ++index) {
+            const std::uint64_t upper = Histogram::BucketUpperBound(index);
+            INFO("bucket " << index << ", upper bound " << upper);
+            REQUIRE(Histogram::BucketIndex(upper) == index);
+            REQUIRE(Histogram::BucketIndex(upper + 1) == index + 1);
+            const std::uint64_t lower = index == 0 ? 0 : Histogram::BucketUpperBound(index - 1) + 1;
+            // Корзины малых значений хранят одно значение, поэтому относительная ширина проверяется для остальных
+            if (index < 2 * Histogram::SUB_COUNT) {
+                CHECK(lower == upper);
+            } else {
+                CHECK((upper - lower + 1) * Histogram::SUB_COUNT <= lower * 2);
+            }
+        }
+        CHECK(Histogram::BucketUpperBound(Histogram::BUCKETS - 1) == Histogram::MAX_VALUE);
+    }
+
+    THEN("values above MAX_VALUE go to the last bucket") {
+        CHECK(Histogram::BucketIndex(Histogram::MAX_VALUE + 1) == Histogram::BUCKETS - 1);
+        CHECK(Histogram::BucketIndex(~std::uint64_t{0}) == Histogram::BUCKETS - 1);
+    }
+}
+
+SCENARIO("Metrics are recorded from many threads") {
+    constexpr int THREADS = 8;
+    constexpr int RECORDS = 100'000;
+    Counter counter;
+    Histogram histogram;
+
+    WHEN("every thread records the same values") {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&counter, &histogram] {
+                for (int i = 0; i < RECORDS; ++i) {
+                    counter.Add();
+                    histogram.Record(static_cast<std::uint64_t>(i % 1'000));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        THEN("no record is lost") {
+            CHECK(counter.Get() == THREADS * RECORDS);
+            const auto snapshot = histogram.Collect();
+            CHECK(snapshot.count == THREADS * RECORDS);
+            CHECK(snapshot.sum == std::uint64_t{THREADS} * (RECORDS / 1'000) * (999 * 1'000 / 2));
+            CHECK(snapshot.counts[Histogram::BucketIndex(0)] == THREADS * RECORDS / 1'000);
+        }
+    }
+
+    WHEN("increments and decrements are made in different threads") {
+        std::thread increments([&counter] {
+            for (int i = 0; i < RECORDS; ++i) {
+                counter.Add(1);
+            }
+        });
+        std::thread decrements([&counter] {
+            for (int i = 0; i < RECORDS; ++i) {
+                counter.Add(-1);
+            }
+        });
+        increments.join();
+        decrements.join();
+
+        THEN("they cancel out") {
+            CHECK(counter.Get() == 0);
+        }
+    }
+}
+
+SCENARIO("Prometheus exposition format") {
+    std::string out;
+    ExpositionWriter writer(out);
+
+    WHEN("a duration histogram is written") {
+        Histogram histogram;
+        histogram.Record(50us);
+        histogram.Record(200us);
+        histogram.Record(2ms);
+        writer.Header("request_seconds"sv, "Request\nduration"sv, "histogram"sv);
+        writer.DurationHistogram("request_seconds"sv, {{"code"sv, "200"sv}}, histogram.Collect());
+
+        THEN("buckets are cumulative and measured in seconds") {
+            CHECK(out.starts_with("# HELP request_seconds Request\\nduration\n# TYPE request_seconds histogram\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"0.0001\"} 1\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"0.00025\"} 2\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"0.001\"} 2\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"0.0025\"} 3\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"10\"} 3\n"sv));
+            CHECK(Contains(out, "request_seconds_bucket{code=\"200\",le=\"+Inf\"} 3\n"sv));
+            CHECK(Contains(out, "request_seconds_sum{code=\"200\"} 0.00225\n"sv));
+            CHECK(Contains(out, "request_seconds_count{code=\"200\"} 3\n"sv));
+        }
+    }
+
+    WHEN("label values contain special characters") {
+        writer.Sample("value"sv, {{"path"sv, "a\"b\\c\nd"sv}}, 1.5);
+
+        THEN("they are escaped") {
+            CHECK(out == "value{path=\"a\\\"b\\\\c\\nd\"} 1.5\n"s);
+        }
+    }
+}
+
+SCENARIO("Metrics request handler") {
+    ServerMetrics server_metrics(MetricsEndpoints::Labels());
+    StatusHandler status_handler;
+    MetricsRequestHandler handler(status_handler, server_metrics);
+    auto send_request = [&handler](http::verb method, std::string_view target) {
+        StringResponse result;
+        handler(http_server::Endpoint{}, StringRequest{method, target, 11}, [&result](auto&& response) {
+            result = std::move(response);
+        });
+        return result;
+    };
+
+    WHEN("requests are served") {
+        send_request(http::verb::get, EndPoint::MAPS);
+        send_request(http::verb::get, "/api/v1/maps/map%31"sv);
+        send_request(http::verb::get, "/api/v1/unknown"sv);
+        send_request(http::verb::get, EndPoint::INDEX);
+        status_handler.status = http::status::unauthorized;
+        send_request(http::verb::get, EndPoint::STATE);
+
+        THEN("/metrics reports their latency by endpoint and status code") {
+            const auto response = send_request(http::verb::get, EndPoint::METRICS);
+            REQUIRE(response.result() == http::status::ok);
+            CHECK(response[http::field::content_type] == ContentType::PROMETHEUS_TEXT);
+            const std::string_view text = response.body();
+            constexpr auto NAME = "game_server_http_request_duration_seconds_count"sv;
+            for (const auto& [endpoint, code] : {std::pair{"/api/v1/maps"sv, "200"sv}, std::pair{"/api/v1/maps/{id}"sv, "200"sv},
+                                                 std::pair{"api_other"sv, "200"sv}, std::pair{"static"sv, "200"sv},
+                                                 std::pair{"/api/v1/game/state"sv, "401"sv}}) {
+                const auto line = std::string{NAME} + "{endpoint=\""s + std::string{endpoint} + "\",code=\""s + std::string{code} + "\"} 1\n"s;
+                CHECK(Contains(text, line));
+            }
+            CHECK(!Contains(text, "endpoint=\"/api/v1/game/state\",code=\"200\""sv));
+            CHECK(Contains(text, "game_server_http_requests_in_flight 0\n"sv));
+            CHECK(Contains(text, "# TYPE game_server_tick_duration_seconds histogram\n"sv));
+        }
+    }
+
+    WHEN("a callback metric is added") {
+        server_metrics.AddCounter("rate_limited"s, "Rejected requests"s, [] { return 3.0; });
+
+        THEN("its value is read at scrape time") {
+            const auto text = server_metrics.Scrape();
+            CHECK(Contains(text, "# TYPE game_server_rate_limited_total counter\ngame_server_rate_limited_total 3\n"sv));
+        }
+    }
+
+    THEN("/metrics accepts only GET and HEAD") {
+        const auto response = send_request(http::verb::post, EndPoint::METRICS);
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(response[http::field::allow] == Api::GET_HEAD);
+    }
+}
+
+TEST_CASE("Metrics recording", "[.][benchmark]") {
+    Counter counter;
+    Histogram histogram;
+    histogram.Record(0);
+    std::uint64_t value = 12'345;
+
+    BENCHMARK("Counter::Add") {
+        counter.Add();
+    };
+
+    BENCHMARK("Histogram::Record") {
+        histogram.Record(value += 1'000);
+    };
+
+    BENCHMARK("Histogram::Collect") {
+        return histogram.Collect().count;
+    };
+}
@@ -0,0 +1,201 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/msgpack/msgpack_model.h"
+#include "../src/request_handler/api_handler.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace json = boost::json;
+
+namespace {
+
+struct MsgpackFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto token = app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(i)).first;
+            players.push_back(app.FindPlayer(token));
+        }
+    }
+
+    model::GameSession& GetSession() {
+        return *players.front()->GetSession();
+    }
+
+    // Собаки разбегаются в разные стороны, на карте появляются предметы
+    void Play(std::size_t ticks) {
+        const std::string_view directions[] = {"L"sv, "R"sv, "U"sv, "D"sv};
+        for (std::size_t i = 0; i < players.size(); ++i) {
+            players[i]->DogMove(directions[i % std::size(directions)], 4.0);
+        }
+        for (std::size_t i = 0; i < ticks; ++i) {
+            app.Tick(1s);
+        }
+    }
+};
+
+std::string Encode(auto&& write) {
+    std::string out;
+    msgpack::Writer writer(out);
+    write(writer);
+    return out;
+}
+
+}  // namespace
+
+SCENARIO("MessagePack values") {
+    GIVEN("integers of every width") {
+        const std::vector<std::int64_t> values{0, 1, 127, 128, 255, 256, 65'535, 65'536, 4'294'967'295, 4'294'967'296,
+                                               -1, -32, -33, -128, -129, -32'768, -32'769, -2'147'483'648,
+                                               -2'147'483'649, std::numeric_limits<std::int64_t>::min(),
+                                               std::numeric_limits<std::int64_t>::max()};
+        const auto data = Encode([&values](msgpack::Writer& writer) {
+            for (const auto value : values) {
+                writer.Int(value);
+            }
+            writer.Uint(std::numeric_limits<std::uint64_t>::max());
+        });
+
+        THEN("they are read back unchanged") {
+            msgpack::Reader reader(data);
+            for (const auto value : values) {
+                CHECK(reader.Int() == value);
+            }
+            CHECK(reader.Uint() == std::numeric_limits<std::uint64_t>::max());
+            CHECK(reader.AtEnd());
+        }
+    }
+
+    THEN("values are written in the shortest form") {
+        CHECK(Encode([](auto& w) { w.Uint(127); }) == "\x7f"s);
+        CHECK(Encode([](auto& w) { w.Uint(128); }) == "\xcc\x80"s);
+        CHECK(Encode([](auto& w) { w.Uint(256); }) == "\xcd\x01\x00"s);
+        CHECK(Encode([](auto& w) { w.Int(-32); }) == "\xe0"s);
+        CHECK(Encode([](auto& w) { w.Int(-33); }) == "\xd0\xdf"s);
+        CHECK(Encode([](auto& w) { w.Double(1.5); }) == "\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00"s);
+        CHECK(Encode([](auto& w) { w.String("U"sv); }) == "\xa1U"s);
+        CHECK(Encode([](auto& w) { w.Array(15); }) == "\x9f"s);
+        CHECK(Encode([](auto& w) { w.Array(16); }) == "\xdc\x00\x10"s);
+        CHECK(Encode([](auto& w) { w.Map(70'000); }) == "\xdf\x00\x01\x11\x70"s);
+        CHECK(Encode([](auto& w) { w.Nil(); w.Bool(true); }) == "\xc0\xc3"s);
+    }
+
+    GIVEN("strings, doubles and containers") {
+        const std::string long_string(300, 'x');
+        const auto data = Encode([&long_string](msgpack::Writer& writer) {
+            writer.Map(1);
+            writer.String(std::string(31, 'a'));
+            writer.Array(3);
+            writer.String(std::string(32, 'b'));
+            writer.String(long_string);
+            writer.Double(-0.25);
+        });
+
+        THEN("they are read back unchanged") {
+            msgpack::Reader reader(data);
+            CHECK(reader.Map() == 1);
+            CHECK(reader.String() == std::string(31, 'a'));
+            CHECK(reader.Array() == 3);
+            CHECK(reader.String() == std::string(32, 'b'));
+            CHECK(reader.String() == long_string);
+            CHECK(reader.Double() == -0.25);
+            CHECK(reader.AtEnd());
+        }
+
+        THEN("truncated data and unexpected types are rejected") {
+            msgpack::Reader truncated(std::string_view{data}.substr(0, data.size() - 1));
+            truncated.Map();
+            truncated.String();
+            truncated.Array();
+            truncated.String();
+            truncated.String();
+            CHECK_THROWS_AS(truncated.Double(), std::invalid_argument);
+
+            msgpack::Reader reader(data);
+            CHECK_THROWS_AS(reader.Array(), std::invalid_argument);
+        }
+    }
+}
+
+SCENARIO_METHOD(MsgpackFixture, "Game state in MessagePack") {
+    Join(5);
+    Play(10);
+    GetSession().AddLoot(model::Loot{model::Loot::Id{1'000}, 10, {1.5, 0.25}, 1});
+
+    WHEN("the state is encoded and decoded") {
+        std::string data;
+        msgpack::EncodeGameState(GetSession(), data);
+        const auto state = msgpack::DecodeGameState(data);
+
+        THEN("it matches the session") {
+            REQUIRE(state.dogs.size() == GetSession().GetDogs().size());
+            for (const auto& [id, dog] : GetSession().GetDogs()) {
+                REQUIRE(state.dogs.contains(*id));
+                const auto& decoded = state.dogs.at(*id);
+                CHECK(decoded.position == dog->GetPosition());
+                CHECK(decoded.speed == dog->GetSpeed());
+                CHECK(decoded.direction == dog->GetDirection());
+                CHECK(decoded.score == dog->GetScore());
+                REQUIRE(decoded.bag.size() == dog->GetBag().size());
+                for (std::size_t i = 0; i < decoded.bag.size(); ++i) {
+                    CHECK(decoded.bag[i].id == *dog->GetBag()[i].id);
+                    CHECK(decoded.bag[i].type == dog->GetBag()[i].type);
+                }
+            }
+            REQUIRE(state.loots.size() == GetSession().GetLoots().size());
+            for (const auto& [id, loot] : GetSession().GetLoots()) {
+                REQUIRE(state.loots.contains(*id));
+                CHECK(state.loots.at(*id).type == loot.GetType());
+                CHECK(state.loots.at(*id).position == loot.GetPosition());
+            }
+        }
+
+        AND_THEN("it is smaller than the JSON state") {
+            CHECK(data.size() < json::serialize(http_handler::ApiHandler::MakeGameState(GetSession())).size());
+        }
+
+        AND_THEN("damaged documents are rejected") {
+            CHECK_THROWS_AS(msgpack::DecodeGameState(std::string_view{data}.substr(0, data.size() / 2)), std::invalid_argument);
+            CHECK_THROWS_AS(msgpack::DecodeGameState(data + '\0'), std::invalid_argument);
+        }
+    }
+}
+
+TEST_CASE_METHOD(MsgpackFixture, "Game state encoding: MessagePack against JSON", "[.][benchmark]") {
+    std::size_t joined = 0;
+    for (const std::size_t dogs : {10, 100, 1000}) {
+        Join(dogs - joined);
+        joined = dogs;
+        Play(5);
+
+        std::string data;
+        msgpack::EncodeGameState(GetSession(), data);
+        const auto json_size = json::serialize(http_handler::ApiHandler::MakeGameState(GetSession())).size();
+        WARN(dogs << " dogs, " << GetSession().GetLoots().size() << " lost objects: JSON " << json_size
+             << " bytes, MessagePack " << data.size() << " bytes");
+
+        BENCHMARK("JSON, "s + std::to_string(dogs) + " dogs") {
+            return json::serialize(http_handler::ApiHandler::MakeGameState(GetSession())).size();
+        };
+
+        // Буфер переиспользуется между кодированиями, как и тело снимка после первого построения
+        BENCHMARK("MessagePack, "s + std::to_string(dogs) + " dogs") {
+            data.clear();
+            msgpack::EncodeGameState(GetSession(), data);
+            return data.size();
+        };
+    }
+}
@@ -0,0 +1,187 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <cctype>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "../src/app/token.h"
+#include "../src/util/flat_hash_map.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Хешер, сводящий ключи в несколько цепочек, чтобы проверить сдвиг элементов при удалении
+struct CollidingHasher {
+    std::size_t operator()(int key) const noexcept {
+        return static_cast<std::size_t>(key % 3);
+    }
+};
+
+std::vector<app::Token> MakeTokens(std::size_t count) {
+    std::vector<app::TokenValue> values(count);
+    app::GenerateTokenValues(values);
+    std::vector<app::Token> tokens;
+    tokens.reserve(count);
+    for (const auto& value : values) {
+        tokens.emplace_back(value);
+    }
+    return tokens;
+}
+
+}  // namespace
+
+SCENARIO("Player token hex representation") {
+    const auto token = app::TokenFromHex("0123456789abcdefFEDCBA9876543210"sv);
+    REQUIRE(token.has_value());
+    CHECK((**token).high == 0x0123456789abcdefull);
+    CHECK((**token).low == 0xfedcba9876543210ull);
+    CHECK(app::TokenToHex(*token) == "0123456789abcdeffedcba9876543210"s);
+    CHECK(app::TokenFromHex(app::TokenToHex(*token)) == token);
+
+    CHECK(!app::TokenFromHex(""sv));
+    CHECK(!app::TokenFromHex("0123456789abcdef0123456789abcde"sv));
+    CHECK(!app::TokenFromHex("0123456789abcdef0123456789abcdef0"sv));
+    CHECK(!app::TokenFromHex("0123456789abcdeg0123456789abcdef"sv));
+    CHECK(!app::TokenFromHex("0123456789abcdef 123456789abcdef"sv));
+    CHECK(!app::TokenFromHex("0123456789abcdef\0""123456789abcdef"sv));
+}
+
+SCENARIO("Generated player tokens") {
+    const auto tokens = MakeTokens(1000);
+    std::unordered_set<std::string> unique;
+    for (const auto& token : tokens) {
+        CHECK(*token != app::TokenValue{});
+        unique.insert(app::TokenToHex(token));
+    }
+    CHECK(unique.size() == tokens.size());
+}
+
+SCENARIO("Flat hash map") {
+    GIVEN("a map of tokens") {
+        const auto tokens = MakeTokens(10'000);
+        util::FlatHashMap<app::Token, int, app::TokenHasher> map;
+        for (std::size_t i = 0; i < tokens.size(); ++i) {
+            CHECK(map.emplace(tokens[i], static_cast<int>(i)).second);
+        }
+
+        THEN("every token is found and duplicates are not inserted") {
+            CHECK(map.size() == tokens.size());
+            CHECK(!map.emplace(tokens.front(), -1).second);
+            for (std::size_t i = 0; i < tokens.size(); ++i) {
+                REQUIRE(map.contains(tokens[i]));
+                CHECK(map.at(tokens[i]) == static_cast<int>(i));
+            }
+            CHECK(map.find(app::Token{}) == map.end());
+        }
+
+        WHEN("half of the tokens are erased") {
+            for (std::size_t i = 0; i < tokens.size(); i += 2) {
+                CHECK(map.erase(tokens[i]) == 1);
+            }
+
+            THEN("only the other half remains") {
+                CHECK(map.size() == tokens.size() / 2);
+                for (std::size_t i = 0; i < tokens.size(); ++i) {
+                    CHECK(map.contains(tokens[i]) == (i % 2 == 1));
+                }
+                std::size_t iterated = 0;
+                for (const auto& [token, index] : map) {
+                    CHECK(index % 2 == 1);
+                    ++iterated;
+                }
+                CHECK(iterated == map.size());
+            }
+        }
+    }
+
+    GIVEN("a map with long collision chains") {
+        util::FlatHashMap<int, int, CollidingHasher> map;
+        for (int key = 1; key <= 12; ++key) {
+            map.emplace(key, key * 10);
+        }
+
+        WHEN("keys are erased from the middle of the chains") {
+            CHECK(map.erase(4) == 1);
+            CHECK(map.erase(5) == 1);
+            CHECK(map.erase(4) == 0);
+
+            THEN("the rest of the chains are still reachable") {
+                CHECK(map.size() == 10);
+                for (int key = 1; key <= 12; ++key) {
+                    CHECK(map.contains(key) == (key != 4 && key != 5));
+                }
+                CHECK(map.at(7) == 70);
+            }
+        }
+    }
+}
+
+TEST_CASE("Player token lookup with 1M players", "[.][benchmark]") {
+    constexpr std::size_t PLAYERS = 1'000'000;
+    constexpr std::size_t LOOKUPS = 10'000;
+
+    const auto tokens = MakeTokens(PLAYERS);
+    std::vector<std::string> requests;
+    std::mt19937_64 random{42};
+    for (std::size_t i = 0; i < LOOKUPS; ++i) {
+        requests.push_back(app::TokenToHex(tokens[random() % PLAYERS]));
+    }
+    const auto player = std::make_shared<int>(0);
+
+    // Обе таблицы резервируются заранее, поэтому счётчики показывают итоговый размер без перестроений
+    // (служебные данные malloc не учитываются)
+    test_util::CountAllocations(true);
+    // Прежнее представление: строка из 32 символов в узле std::unordered_map
+    std::size_t bytes_before = test_util::GetAllocatedBytes();
+    std::size_t allocations_before = test_util::GetAllocations();
+    std::unordered_map<std::string, std::shared_ptr<int>> string_index;
+    string_index.reserve(PLAYERS);
+    for (const auto& token : tokens) {
+        string_index.emplace(app::TokenToHex(token), player);
+    }
+    const std::size_t string_index_bytes = test_util::GetAllocatedBytes() - bytes_before;
+    const std::size_t string_index_allocations = test_util::GetAllocations() - allocations_before;
+
+    bytes_before = test_util::GetAllocatedBytes();
+    allocations_before = test_util::GetAllocations();
+    util::FlatHashMap<app::Token, std::shared_ptr<int>, app::TokenHasher> flat_index;
+    flat_index.reserve(PLAYERS);
+    for (const auto& token : tokens) {
+        flat_index.emplace(token, player);
+    }
+    const std::size_t flat_index_bytes = test_util::GetAllocatedBytes() - bytes_before;
+    const std::size_t flat_index_allocations = test_util::GetAllocations() - allocations_before;
+    test_util::CountAllocations(false);
+
+    WARN("per player: unordered_map<string> " << string_index_bytes / PLAYERS << " bytes in "
+         << string_index_allocations / PLAYERS << " allocations, flat 128-bit index "
+         << flat_index_bytes / PLAYERS << " bytes in " << flat_index_allocations << " allocations total");
+
+    BENCHMARK("unordered_map<string>: lower-case copy and lookup") {
+        std::size_t found = 0;
+        for (const auto& request : requests) {
+            std::string token = request;
+            for (char& c : token) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            found += string_index.contains(token) ? 1 : 0;
+        }
+        return found;
+    };
+
+    BENCHMARK("flat 128-bit index: hex decode and lookup") {
+        std::size_t found = 0;
+        for (const auto& request : requests) {
+            const auto token = app::TokenFromHex(request);
+            found += token && flat_index.find(*token) != flat_index.end() ? 1 : 0;
+        }
+        return found;
+    };
+}
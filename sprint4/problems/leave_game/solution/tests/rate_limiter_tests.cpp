@@ -0,0 +1,212 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/request_handler/request_handler.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+using Clock = util::TokenBucketTable::Clock;
+
+struct NoDatabase : app::UnitOfWorkFactory {
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        throw std::runtime_error("database is not available");
+    }
+};
+
+}  // namespace
+
+SCENARIO("Token bucket table") {
+    const auto start = Clock::now();
+
+    GIVEN("a bucket of 3 tokens refilled at 10 tokens per second") {
+        util::TokenBucketTable table({10.0, 3}, 1'024);
+
+        THEN("a burst of 3 requests is admitted and the next one waits for a token") {
+            for (int i = 0; i < 3; ++i) {
+                CHECK(table.TryAcquire(1, start) == 0ns);
+            }
+            CHECK(table.TryAcquire(1, start) == 100ms);
+            CHECK(table.TryAcquire(1, start + 40ms) == 60ms);
+            CHECK(table.TryAcquire(1, start + 100ms) == 0ns);
+            CHECK(table.TryAcquire(1, start + 100ms) > 0ns);
+        }
+
+        THEN("other keys have their own buckets") {
+            for (int i = 0; i < 3; ++i) {
+                CHECK(table.TryAcquire(1, start) == 0ns);
+            }
+            CHECK(table.TryAcquire(2, start) == 0ns);
+        }
+
+        THEN("an idle bucket is refilled up to its capacity") {
+            for (int i = 0; i < 3; ++i) {
+                CHECK(table.TryAcquire(1, start) == 0ns);
+            }
+            const auto later = start + 10s;
+            for (int i = 0; i < 3; ++i) {
+                CHECK(table.TryAcquire(1, later) == 0ns);
+            }
+            CHECK(table.TryAcquire(1, later) > 0ns);
+        }
+    }
+
+    GIVEN("a table smaller than the number of clients") {
+        util::TokenBucketTable table({1.0, 1}, 16);
+        constexpr std::uint64_t KEYS = 10'000;
+
+        WHEN("every client sends one request") {
+            std::size_t admitted = 0;
+            for (std::uint64_t key = 1; key <= KEYS; ++key) {
+                const auto wait = table.TryAcquire(key, start);
+                if (wait == 0ns) {
+                    ++admitted;
+                } else {
+                    CHECK(wait == 1s);
+                }
+            }
+
+            THEN("requests above the capacity are rejected") {
+                CHECK(admitted > 0);
+                CHECK(admitted < KEYS);
+                CHECK(table.GetOverflows() == KEYS - admitted);
+            }
+
+            AND_WHEN("the buckets become full again") {
+                const std::size_t overflows = table.GetOverflows();
+                std::size_t reused = 0;
+                for (std::uint64_t key = KEYS + 1; key <= 2 * KEYS; ++key) {
+                    if (table.TryAcquire(key, start + 1s) == 0ns) {
+                        ++reused;
+                    }
+                }
+
+                THEN("idle buckets are reused for new clients") {
+                    CHECK(reused > 0);
+                    CHECK(table.GetOverflows() - overflows == KEYS - reused);
+                    CHECK(table.TryAcquire(KEYS + 1, start + 1s) > 0ns);
+                }
+            }
+        }
+    }
+
+    GIVEN("many threads sharing one bucket") {
+        constexpr std::uint32_t BURST = 1'000;
+        util::TokenBucketTable table({1.0, BURST}, 1'024);
+        std::atomic<std::size_t> admitted{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&table, &admitted, start] {
+                for (std::uint32_t i = 0; i < BURST; ++i) {
+                    if (table.TryAcquire(42, start) == 0ns) {
+                        ++admitted;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        THEN("exactly the bucket capacity is admitted") {
+            CHECK(admitted == BURST);
+        }
+    }
+}
+
+SCENARIO("API requests above the rate limit") {
+    app::Application app{"../../tests/test_config.json"s};
+    NoDatabase database;
+    net::io_context ioc;
+    auto send_request = [&ioc](RequestHandler& handler, const http_server::Endpoint& endpoint, std::string_view token) {
+        StringRequest req{http::verb::get, EndPoint::STATE, 11};
+        req.set(http::field::authorization, "Bearer "s + std::string{token});
+        std::pair<http::status, std::string> result;
+        handler(endpoint, std::move(req), [&result](auto&& response) {
+            result = {response.result(), std::string{response[http::field::retry_after]}};
+        });
+        ioc.run();
+        ioc.restart();
+        return result;
+    };
+    const auto first_token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Шарик"s).first);
+    const auto second_token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Бобик"s).first);
+    const http_server::Endpoint first_client = net::ip::tcp::endpoint{net::ip::make_address("10.0.0.1"), 50'000};
+    const http_server::Endpoint second_client = net::ip::tcp::endpoint{net::ip::make_address("10.0.0.2"), 50'000};
+
+    GIVEN("a limit of 2 requests per player token") {
+        auto limiter = std::make_shared<RateLimiter>(RateLimiter::Options{RateLimiter::Limits{0.5, 2}, std::nullopt});
+        limiter->SetSnapshotPublisher(std::make_shared<GameSnapshotPublisher>(app));
+        auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database,
+                                                        0, nullptr, nullptr, net::any_io_executor{}, limiter);
+
+        THEN("the third request of a player is rejected with Retry-After") {
+            CHECK(send_request(*handler, first_client, first_token).first == http::status::ok);
+            CHECK(send_request(*handler, first_client, first_token).first == http::status::ok);
+            const auto [status, retry_after] = send_request(*handler, first_client, first_token);
+            CHECK(status == http::status::too_many_requests);
+            CHECK(retry_after == "2"s);
+            CHECK(limiter->GetRejected() == 1);
+
+            AND_THEN("another player from the same address is not limited") {
+                CHECK(send_request(*handler, first_client, second_token).first == http::status::ok);
+            }
+        }
+    }
+
+    GIVEN("a small table of player token buckets") {
+        auto limiter = std::make_shared<RateLimiter>(
+                RateLimiter::Options{RateLimiter::Limits{0.5, 1}, std::nullopt, util::TokenBucketTable::SHARDS});
+        limiter->SetSnapshotPublisher(std::make_shared<GameSnapshotPublisher>(app));
+
+        WHEN("a client fills it with requests carrying made-up tokens") {
+            constexpr std::uint64_t UNKNOWN_TOKENS = 10'000;
+            std::size_t limited = 0;
+            for (std::uint64_t i = 1; i <= UNKNOWN_TOKENS; ++i) {
+                StringRequest req{http::verb::get, EndPoint::STATE, 11};
+                req.set(http::field::authorization, "Bearer "s + app::TokenToHex(app::Token{{i, ~i}}));
+                if (limiter->Check(req, first_client) > 0ns) {
+                    ++limited;
+                }
+            }
+
+            THEN("unknown tokens get no buckets and real players are still limited by their own bucket") {
+                CHECK(limited == 0);
+                auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app,
+                                                                database, 0, nullptr, nullptr, net::any_io_executor{},
+                                                                limiter);
+                CHECK(send_request(*handler, second_client, first_token).first == http::status::ok);
+                CHECK(send_request(*handler, second_client, first_token).first == http::status::too_many_requests);
+                CHECK(send_request(*handler, second_client, second_token).first == http::status::ok);
+            }
+        }
+    }
+
+    GIVEN("a limit of 1 request per IP address") {
+        auto limiter = std::make_shared<RateLimiter>(RateLimiter::Options{std::nullopt, RateLimiter::Limits{1.0, 1}});
+        auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database,
+                                                        0, nullptr, nullptr, net::any_io_executor{}, limiter);
+
+        THEN("every token from one address shares the limit") {
+            CHECK(send_request(*handler, first_client, first_token).first == http::status::ok);
+            CHECK(send_request(*handler, first_client, second_token).first == http::status::too_many_requests);
+            CHECK(send_request(*handler, second_client, second_token).first == http::status::ok);
+        }
+
+        THEN("Unix domain socket clients are not limited by address") {
+            CHECK(send_request(*handler, http_server::Endpoint{}, first_token).first == http::status::ok);
+            CHECK(send_request(*handler, http_server::Endpoint{}, first_token).first == http::status::ok);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/request_handler/api_handler.h"
+#include "../src/request_handler/session_snapshot.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct SessionFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto token = app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(i)).first;
+            players.push_back(app.FindPlayer(token));
+        }
+    }
+
+    model::GameSession& GetSession() {
+        return *players.front()->GetSession();
+    }
+};
+
+}  // namespace
+
+SCENARIO_METHOD(SessionFixture, "Session state snapshots") {
+    Join(3);
+    SessionSnapshots snapshots;
+
+    GIVEN("the snapshot of the current version") {
+        const auto state = snapshots.GetState(GetSession());
+        const auto players_list = snapshots.GetPlayers(GetSession());
+
+        THEN("it matches the serialized session and is shared while the session does not change") {
+            CHECK(json::parse(state->body).as_object() == ApiHandler::MakeGameState(GetSession()));
+            CHECK(players_list->body == json::serialize(ApiHandler::MakePlayerList(GetSession())));
+            CHECK(snapshots.GetState(GetSession()) == state);
+            CHECK(snapshots.GetPlayers(GetSession()) == players_list);
+            CHECK(snapshots.GetBuilt() == 2);
+        }
+
+        WHEN("a dog changes its direction") {
+            players.front()->DogMove("R"sv, 1.0);
+
+            THEN("a new snapshot is built") {
+                const auto changed = snapshots.GetState(GetSession());
+                CHECK(changed != state);
+                CHECK(changed->version > state->version);
+                CHECK(json::parse(changed->body).as_object() == ApiHandler::MakeGameState(GetSession()));
+            }
+        }
+
+        WHEN("the game is updated") {
+            app.Tick(100ms);
+
+            THEN("a new snapshot is built once for all requests of the tick") {
+                const auto changed = snapshots.GetState(GetSession());
+                CHECK(changed != state);
+                CHECK(snapshots.GetState(GetSession()) == changed);
+            }
+        }
+
+        WHEN("a player joins the session") {
+            Join(1);
+
+            THEN("the player list is rebuilt") {
+                CHECK(snapshots.GetPlayers(GetSession())->body != players_list->body);
+            }
+        }
+    }
+}
+
+TEST_CASE_METHOD(SessionFixture, "State requests of a 100-player session in one tick", "[.][benchmark]") {
+    constexpr std::size_t PLAYERS = 100;
+    Join(PLAYERS);
+    app.Tick(100ms);
+    SessionSnapshots snapshots;
+
+    BENCHMARK("serialize per request") {
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < PLAYERS; ++i) {
+            size += json::serialize(ApiHandler::MakeGameState(GetSession())).size();
+        }
+        return size;
+    };
+
+    BENCHMARK("shared snapshot") {
+        // Новый тик: снимок строится первым запросом и используется остальными
+        GetSession().MarkChanged();
+        std::size_t size = 0;
+        for (std::size_t i = 0; i < PLAYERS; ++i) {
+            size += snapshots.GetState(GetSession())->body.size();
+        }
+        return size;
+    };
+}
@@ -0,0 +1,216 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../src/request_handler/api_handler.h"
+
+using namespace http_handler;
+using namespace detail;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct DeltaFixture {
+    fs::path test_config = "../../tests/test_config.json"s;
+    app::Application app{test_config};
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    void Join(std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto token = app.JoinGame(model::Map::Id{"map1"s}, "Игрок "s + std::to_string(i)).first;
+            players.push_back(app.FindPlayer(token));
+        }
+    }
+
+    model::GameSession& GetSession() {
+        return *players.front()->GetSession();
+    }
+
+    model::Dog::Id GetDogId(std::size_t player) {
+        return players.at(player)->GetDog()->GetId();
+    }
+};
+
+json::object MakeGameStateDelta(const model::GameSession& session, std::uint64_t since) {
+    std::string out;
+    ApiHandler::WriteGameStateDelta(session, since, out);
+    return json::parse(out).as_object();
+}
+
+std::size_t GameStateDeltaSize(const model::GameSession& session, std::uint64_t since) {
+    std::string out;
+    ApiHandler::WriteGameStateDelta(session, since, out);
+    return out.size();
+}
+
+std::size_t GameStateSize(const model::GameSession& session) {
+    std::string out;
+    ApiHandler::WriteGameState(session, out);
+    return out.size();
+}
+
+}  // namespace
+
+SCENARIO_METHOD(DeltaFixture, "Session change history") {
+    Join(3);
+    app.Tick(100ms);
+    auto& session = GetSession();
+    const auto version = session.GetVersion();
+
+    THEN("nothing has changed since the current version") {
+        const auto changes = session.GetChangesSince(version);
+        REQUIRE(changes.has_value());
+        CHECK(changes->dogs.empty());
+        CHECK(changes->removed_dogs.empty());
+        CHECK(changes->removed_loots.empty());
+    }
+
+    WHEN("one dog moves during a tick") {
+        players.front()->DogMove("R"sv, 1.0);
+        app.Tick(100ms);
+
+        THEN("only this dog is reported as changed") {
+            const auto changes = session.GetChangesSince(version);
+            REQUIRE(changes.has_value());
+            CHECK(changes->dogs == decltype(changes->dogs){GetDogId(0)});
+        }
+
+        AND_WHEN("it stands still during the next tick") {
+            players.front()->DogMove(""sv, 1.0);
+            app.Tick(100ms);
+            const auto stopped = session.GetVersion();
+            app.Tick(100ms);
+
+            THEN("a tick without movement changes nothing") {
+                const auto changes = session.GetChangesSince(stopped);
+                REQUIRE(changes.has_value());
+                CHECK(changes->dogs.empty());
+            }
+        }
+    }
+
+    WHEN("a dog turns between ticks") {
+        players.front()->DogMove("R"sv, 1.0);
+        const auto turned = session.GetVersion();
+
+        THEN("the version changes once and only this dog is reported") {
+            CHECK(turned == version + 1);
+            const auto changes = session.GetChangesSince(version);
+            REQUIRE(changes.has_value());
+            CHECK(changes->dogs == decltype(changes->dogs){GetDogId(0)});
+        }
+
+        AND_WHEN("the same move is repeated") {
+            players.front()->DogMove("R"sv, 1.0);
+
+            THEN("the session does not change") {
+                CHECK(session.GetVersion() == turned);
+            }
+        }
+    }
+
+    WHEN("a dog leaves the session and loot appears") {
+        const auto dog_id = GetDogId(1);
+        session.EraseDog(dog_id);
+        const auto& loot = session.AddLoot(model::Loot{model::Loot::Id{100}, 10, {0.0, 0.0}, 0});
+
+        THEN("the dog is reported as removed and the loot as added") {
+            const auto changes = session.GetChangesSince(version);
+            REQUIRE(changes.has_value());
+            CHECK(changes->removed_dogs == decltype(changes->removed_dogs){dog_id});
+            CHECK(!changes->dogs.contains(dog_id));
+            CHECK(changes->loots.contains(loot.GetId()));
+        }
+    }
+
+    WHEN("the cursor is older than the history") {
+        for (std::size_t i = 0; i <= model::GameSession::CHANGE_HISTORY_SIZE; ++i) {
+            app.Tick(100ms);
+        }
+
+        THEN("changes are not available and the full state is sent") {
+            CHECK(!session.GetChangesSince(version));
+            CHECK(session.GetChangesSince(session.GetVersion()));
+            const auto delta = MakeGameStateDelta(session, version);
+            CHECK(delta.at(UserKey::FULL_STATE).as_bool());
+            CHECK(delta.at(UserKey::PLAYERS).as_object().size() == 3);
+            CHECK(delta.at(UserKey::VERSION).as_uint64() == session.GetVersion());
+        }
+    }
+
+    THEN("a cursor from the future is rejected") {
+        CHECK(!session.GetChangesSince(version + 1));
+    }
+
+    WHEN("a delta is built after a dog moved") {
+        players.back()->DogMove("L"sv, 1.0);
+        app.Tick(100ms);
+        const auto delta = MakeGameStateDelta(session, version);
+
+        THEN("it contains only that dog, serialized as in the full state") {
+            CHECK(!delta.at(UserKey::FULL_STATE).as_bool());
+            const auto& dogs = delta.at(UserKey::PLAYERS).as_object();
+            REQUIRE(dogs.size() == 1);
+            const auto key = std::to_string(*GetDogId(2));
+            CHECK(dogs.at(key) == ApiHandler::MakeGameState(session).at(UserKey::PLAYERS).as_object().at(key));
+            CHECK(delta.at(UserKey::REMOVED_PLAYERS).as_array().empty());
+        }
+    }
+}
+
+TEST_CASE_METHOD(DeltaFixture, "State bandwidth of a 200-dog session", "[.][benchmark]") {
+    constexpr std::size_t DOGS = 200;
+    constexpr std::size_t MOVING_PER_TICK = 20;
+    constexpr std::size_t TICKS = 100;
+    Join(DOGS);
+    app.Tick(100ms);
+
+    // Клиент опрашивает состояние каждый тик. За тик двигается каждая десятая собака,
+    // собаки, двигавшиеся в прошлом тике, останавливаются
+    std::mt19937 random{42};
+    const std::string_view directions[] = {"L"sv, "R"sv, "U"sv, "D"sv};
+    std::vector<std::size_t> moving;
+    std::size_t full_bytes = 0;
+    std::size_t delta_bytes = 0;
+    for (std::size_t tick = 0; tick < TICKS; ++tick) {
+        const auto cursor = GetSession().GetVersion();
+        for (const auto player : moving) {
+            players[player]->DogMove(""sv, 4.0);
+        }
+        moving.clear();
+        for (std::size_t i = 0; i < MOVING_PER_TICK; ++i) {
+            moving.push_back(random() % DOGS);
+            players[moving.back()]->DogMove(directions[random() % std::size(directions)], 4.0);
+        }
+        app.Tick(100ms);
+        full_bytes += GameStateSize(GetSession());
+        delta_bytes += GameStateDeltaSize(GetSession(), cursor);
+    }
+    WARN("bytes per poll: full state " << full_bytes / TICKS << ", delta " << delta_bytes / TICKS);
+
+    const auto cursor = GetSession().GetVersion();
+    for (const auto player : moving) {
+        players[player]->DogMove(""sv, 4.0);
+    }
+    for (std::size_t i = 0; i < MOVING_PER_TICK; ++i) {
+        players[i]->DogMove("R"sv, 4.0);
+    }
+    app.Tick(100ms);
+
+    BENCHMARK("full state") {
+        return GameStateSize(GetSession());
+    };
+
+    BENCHMARK("delta since the previous tick") {
+        return GameStateDeltaSize(GetSession(), cursor);
+    };
+}
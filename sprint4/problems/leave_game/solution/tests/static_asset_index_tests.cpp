@@ -0,0 +1,178 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "../src/request_handler/file_handler.h"
+#include "../src/request_handler/static_asset_index.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct StaticRoot {
+    fs::path root = fs::temp_directory_path() / "static_asset_index_tests";
+    std::string script;
+
+    StaticRoot() {
+        fs::create_directories(root / "js");
+        for (int i = 0; i < 1000; ++i) {
+            script += "console.log(" + std::to_string(i) + ");\n";
+        }
+        std::ofstream{root / "js" / "game.js"} << script;
+        std::ofstream{root / "index.html"} << "<html></html>";
+    }
+
+    ~StaticRoot() {
+        fs::remove_all(root);
+    }
+};
+
+std::string Inflate(std::string_view data) {
+    std::string result(1 << 20, '\0');
+    uLongf size = result.size();
+    REQUIRE(uncompress(reinterpret_cast<Bytef*>(result.data()), &size,
+                       reinterpret_cast<const Bytef*>(data.data()), data.size()) == Z_OK);
+    result.resize(size);
+    return result;
+}
+
+StringRequest MakeRequest(std::string_view target) {
+    StringRequest req{http::verb::get, target, 11};
+    return req;
+}
+
+}  // namespace
+
+SCENARIO_METHOD(StaticRoot, "Static asset index") {
+    GIVEN("an index built from the static root") {
+        const auto index = StaticAssetIndex::Build(root);
+
+        THEN("it contains every file under its request path") {
+            CHECK(index->Size() == 2);
+            CHECK(index->Find("/index.html") != nullptr);
+            CHECK(index->Find("/js/missing.js") == nullptr);
+
+            const auto asset = index->Find("/js/game.js");
+            REQUIRE(asset != nullptr);
+            CHECK(asset->content == script);
+            CHECK(asset->content_type == ContentType::TEXT_JS);
+        }
+
+        THEN("compressible files have smaller deflate and gzip variants with their own ETags") {
+            const auto asset = index->Find("/js/game.js");
+            REQUIRE(!asset->deflate.empty());
+            CHECK(asset->deflate.size() < script.size());
+            CHECK(Inflate(asset->deflate) == script);
+            REQUIRE(!asset->gzip.empty());
+            CHECK(asset->gzip.starts_with("\x1f\x8b"sv));
+
+            CHECK(asset->etag.starts_with('"'));
+            CHECK(asset->etag.ends_with('"'));
+            CHECK(asset->etag != asset->gzip_etag);
+            CHECK(asset->etag != asset->deflate_etag);
+        }
+
+        THEN("a file that does not shrink has no compressed variants") {
+            CHECK(!index->Find("/index.html")->HasEncodings());
+        }
+    }
+
+    GIVEN("symbolic links to files inside and outside the static root") {
+        const auto outside = fs::temp_directory_path() / "static_asset_index_tests_secret.txt";
+        std::ofstream{outside} << "secret";
+        fs::create_symlink(outside, root / "secret.txt");
+        fs::create_symlink(root / "index.html", root / "js" / "index.html");
+        const auto index = StaticAssetIndex::Build(root);
+        fs::remove(outside);
+
+        THEN("only the link that stays inside the root is indexed") {
+            CHECK(index->Find("/secret.txt") == nullptr);
+            CHECK(index->Find("/js/index.html") != nullptr);
+        }
+    }
+}
+
+SCENARIO("Content negotiation helpers") {
+    CHECK(SelectContentEncoding("") == ContentEncoding::IDENTITY);
+    CHECK(SelectContentEncoding("gzip, deflate, br") == ContentEncoding::GZIP);
+    CHECK(SelectContentEncoding("deflate") == ContentEncoding::DEFLATE);
+    CHECK(SelectContentEncoding("GZIP;q=0.5") == ContentEncoding::GZIP);
+    CHECK(SelectContentEncoding("gzip;q=0, deflate") == ContentEncoding::DEFLATE);
+    CHECK(SelectContentEncoding("*") == ContentEncoding::GZIP);
+    CHECK(SelectContentEncoding("br") == ContentEncoding::IDENTITY);
+
+    CHECK(GetMediaTypeQuality("", "application/json").quality == 0.0);
+    CHECK(GetMediaTypeQuality("application/msgpack", "application/msgpack").exact);
+    CHECK(GetMediaTypeQuality("application/msgpack;q=0", "application/msgpack").quality == 0.0);
+    CHECK(GetMediaTypeQuality("Application/MsgPack; q=0.5, */*;q=0.1", "application/msgpack").quality == 0.5);
+    CHECK(GetMediaTypeQuality("text/html, application/*;q=0.2, */*;q=0.1", "application/json").quality == 0.2);
+    CHECK(!GetMediaTypeQuality("*/*", "application/msgpack").exact);
+    CHECK(GetMediaTypeQuality("application/x-msgpack", "application/msgpack").quality == 0.0);
+
+    CHECK(IfNoneMatch(R"("abc")", R"("abc")"));
+    CHECK(IfNoneMatch(R"("x", W/"abc")", R"("abc")"));
+    CHECK(IfNoneMatch("*", R"("abc")"));
+    CHECK(!IfNoneMatch(R"("abcd")", R"("abc")"));
+}
+
+SCENARIO_METHOD(StaticRoot, "File handler serves indexed files from memory") {
+    FileHandler handler(root, StaticAssetIndex::Build(root));
+    const auto asset = StaticAssetIndex::Build(root)->Find("/js/game.js");
+
+    WHEN("a file is requested without Accept-Encoding") {
+        auto response = handler.HandleFileResponse(MakeRequest("/js/game.js"));
+
+        THEN("the whole file is returned with its ETag") {
+            REQUIRE(std::holds_alternative<SharedBufferResponse>(response));
+            const auto& shared = std::get<SharedBufferResponse>(response);
+            CHECK(shared.result() == http::status::ok);
+            CHECK(shared.body().data == script);
+            CHECK(shared[http::field::etag] == asset->etag);
+            CHECK(shared[http::field::content_encoding].empty());
+            CHECK(shared[http::field::vary] == "Accept-Encoding");
+        }
+    }
+
+    WHEN("the client accepts gzip") {
+        auto req = MakeRequest("/js/game.js");
+        req.set(http::field::accept_encoding, "gzip, deflate");
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("the gzip variant is returned") {
+            REQUIRE(std::holds_alternative<SharedBufferResponse>(response));
+            const auto& shared = std::get<SharedBufferResponse>(response);
+            CHECK(shared[http::field::content_encoding] == "gzip");
+            CHECK(shared.body().data == asset->gzip);
+            CHECK(shared[http::field::etag] == asset->gzip_etag);
+        }
+    }
+
+    WHEN("the client already has the current version") {
+        auto req = MakeRequest("/js/game.js");
+        req.set(http::field::if_none_match, asset->etag);
+        auto response = handler.HandleFileResponse(req);
+
+        THEN("304 Not Modified is returned without a body") {
+            REQUIRE(std::holds_alternative<StringResponse>(response));
+            const auto& not_modified = std::get<StringResponse>(response);
+            CHECK(not_modified.result() == http::status::not_modified);
+            CHECK(not_modified.body().empty());
+            CHECK(not_modified[http::field::etag] == asset->etag);
+        }
+    }
+
+    WHEN("the root path is requested") {
+        auto response = handler.HandleFileResponse(MakeRequest("/"));
+
+        THEN("index.html is returned") {
+            REQUIRE(std::holds_alternative<SharedBufferResponse>(response));
+            CHECK(std::get<SharedBufferResponse>(response).body().data == "<html></html>");
+        }
+    }
+}
@@ -0,0 +1,238 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/write.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "../src/request_handler/request_handler.h"
+#include "../src/request_handler/trace_request_handler.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace json = boost::json;
+using tracing::Stage;
+
+namespace {
+
+struct NoDatabase : app::UnitOfWorkFactory {
+    app::UnitOfWorkHolder CreateUnitOfWork() override {
+        throw std::runtime_error("database is not available");
+    }
+};
+
+// Обработчик, отвечающий на любой запрос кодом 201
+struct CreatedHandler {
+    template <typename Request, typename Send>
+    void operator()(const http_server::Endpoint& /*endpoint*/, Request&& req, Send&& send) {
+        http::response<http::string_body> response{http::status::created, req.version()};
+        response.body() = "{}";
+        response.prepare_payload();
+        send(std::move(response));
+    }
+};
+
+}  // namespace
+
+SCENARIO("Tracer samples requests and keeps recent traces") {
+    GIVEN("a tracer sampling every third request") {
+        tracing::Tracer tracer({3, 16, false});
+
+        THEN("one request of three is traced") {
+            std::size_t traced = 0;
+            for (int i = 0; i < 9; ++i) {
+                traced += tracer.Start("GET"sv, "/"sv) != nullptr;
+            }
+            CHECK(traced == 3);
+        }
+    }
+
+    GIVEN("a tracer with tracing turned off") {
+        tracing::Tracer tracer({0, 16, false});
+
+        THEN("no request is traced") {
+            CHECK(tracer.Start("GET"sv, "/"sv) == nullptr);
+        }
+    }
+
+    GIVEN("a tracer keeping two traces") {
+        tracing::Tracer tracer({1, 2, false});
+
+        WHEN("three requests are finished") {
+            for (int i = 0; i < 3; ++i) {
+                auto trace = tracer.Start("GET"sv, "/api/v1/maps"sv);
+                REQUIRE(trace);
+                trace->Stamp(Stage::HANDLER_END);
+                trace->Stamp(Stage::WRITE_COMPLETE);
+                tracer.Finish(std::move(trace));
+            }
+
+            THEN("the two latest are returned from old to new") {
+                const auto recent = tracer.GetRecent();
+                REQUIRE(recent.size() == 2);
+                CHECK(recent[0].as_object().at("id").as_uint64() + 1 == recent[1].as_object().at("id").as_uint64());
+                CHECK(recent[1].as_object().at("target").as_string() == "/api/v1/maps"sv);
+            }
+        }
+    }
+}
+
+SCENARIO("Request trace breakdown") {
+    tracing::RequestTrace trace(1, "POST"sv, "/api/v1/game/join"sv);
+    trace.Stamp(Stage::READ_COMPLETE);
+
+    WHEN("the request is answered without a strand") {
+        trace.Stamp(Stage::HANDLER_END);
+        trace.Stamp(Stage::WRITE_COMPLETE);
+        const auto span = trace.ToJson();
+
+        THEN("there is no queue part") {
+            CHECK(!span.contains("routing_ns"));
+            CHECK(!span.contains("queue_ns"));
+            CHECK(span.at("handler_ns").as_int64() >= 0);
+            CHECK(span.at("total_ns").as_int64() >= span.at("handler_ns").as_int64());
+        }
+    }
+
+    WHEN("the request waits for the strand") {
+        trace.Stamp(Stage::STRAND_ENQUEUE);
+        std::this_thread::sleep_for(2ms);
+        trace.Stamp(Stage::STRAND_START);
+        trace.Stamp(Stage::HANDLER_END);
+        trace.Stamp(Stage::WRITE_COMPLETE);
+        trace.SetStatus(200);
+        const auto span = trace.ToJson();
+
+        THEN("the wait is reported separately from the handler") {
+            CHECK(span.at("status").as_uint64() == 200);
+            CHECK(span.at("queue_ns").as_int64() >= 2'000'000);
+            CHECK(span.at("handler_ns").as_int64() < span.at("queue_ns").as_int64());
+            CHECK(span.at("total_ns").as_int64() >= span.at("queue_ns").as_int64());
+        }
+    }
+}
+
+SCENARIO("Session stamps traced requests") {
+    net::io_context ioc;
+    auto tracer = std::make_shared<tracing::Tracer>(tracing::TracerOptions{1, 16, false});
+    auto listener = std::make_shared<http_server::Listener<CreatedHandler>>(
+            ioc, http_server::tcp::endpoint{net::ip::make_address("127.0.0.1"), 0}, CreatedHandler{},
+            http_server::ServerOptions{.tracer = tracer});
+    listener->Run();
+    const auto endpoint = *http_server::ToTcpEndpoint(listener->GetLocalEndpoint());
+    std::thread server([&ioc] { ioc.run(); });
+
+    WHEN("requests are answered") {
+        constexpr int REQUESTS = 3;
+        http_server::tcp::socket client(ioc);
+        client.connect(endpoint);
+        beast::flat_buffer buffer;
+        for (int i = 0; i < REQUESTS; ++i) {
+            net::write(client, net::buffer("GET /api/v1/maps HTTP/1.1\r\n\r\n"sv));
+            http::response<http::string_body> response;
+            http::read(client, buffer, response);
+        }
+        // Трассировка завершается в сессии после записи, клиент может прочитать ответ раньше
+        const auto deadline = std::chrono::steady_clock::now() + 5s;
+        while (tracer->GetRecent().size() < REQUESTS && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(1ms);
+        }
+
+        THEN("every request is traced from reading to writing") {
+            const auto recent = tracer->GetRecent();
+            REQUIRE(recent.size() == REQUESTS);
+            for (const auto& span : recent) {
+                CHECK(span.as_object().at("method").as_string() == "GET"sv);
+                CHECK(span.as_object().at("status").as_uint64() == 201);
+                CHECK(span.as_object().contains("write_ns"));
+                CHECK(span.as_object().contains("total_ns"));
+            }
+        }
+    }
+
+    ioc.stop();
+    server.join();
+}
+
+SCENARIO("Request handler stamps the hop to the API strand") {
+    app::Application app{"../../tests/test_config.json"s};
+    NoDatabase database;
+    net::io_context ioc;
+    auto handler = std::make_shared<RequestHandler>(fs::temp_directory_path(), net::make_strand(ioc), app, database);
+    const auto token = app::TokenToHex(app.JoinGame(model::Map::Id{"map1"s}, "Шарик"s).first);
+
+    WHEN("a state request is traced") {
+        tracing::RequestTrace trace(1, "GET"sv, EndPoint::STATE);
+        trace.Stamp(Stage::READ_COMPLETE);
+        StringRequest req{http::verb::get, EndPoint::STATE, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        {
+            tracing::ScopedTrace scope(&trace);
+            (*handler)(http_server::Endpoint{}, std::move(req), [&trace](auto&& response) {
+                trace.SetStatus(response.result_int());
+            });
+        }
+        CHECK(trace.GetStamp(Stage::STRAND_ENQUEUE).has_value());
+        ioc.run();
+
+        THEN("the strand wait is measured") {
+            CHECK(trace.GetStatus() == 200);
+            REQUIRE(trace.GetStamp(Stage::STRAND_START).has_value());
+            CHECK(*trace.GetStamp(Stage::STRAND_START) >= *trace.GetStamp(Stage::STRAND_ENQUEUE));
+        }
+    }
+
+    WHEN("a request is not traced") {
+        StringRequest req{http::verb::get, EndPoint::STATE, 11};
+        req.set(http::field::authorization, "Bearer "s + token);
+        http::status status{};
+        (*handler)(http_server::Endpoint{}, std::move(req), [&status](auto&& response) {
+            status = response.result();
+        });
+        ioc.run();
+
+        THEN("it is handled as usual") {
+            CHECK(status == http::status::ok);
+        }
+    }
+}
+
+SCENARIO("Recent traces are served on /admin/traces") {
+    auto tracer = std::make_shared<tracing::Tracer>(tracing::TracerOptions{1, 16, false});
+    auto trace = tracer->Start("GET"sv, "/api/v1/maps"sv);
+    trace->Stamp(Stage::HANDLER_END);
+    trace->Stamp(Stage::WRITE_COMPLETE);
+    tracer->Finish(std::move(trace));
+
+    CreatedHandler created;
+    TraceRequestHandler handler(created, tracer);
+    auto send_request = [&handler](http::verb method, std::string_view target) {
+        StringResponse result;
+        handler(http_server::Endpoint{}, StringRequest{method, target, 11}, [&result](auto&& response) {
+            result = std::move(response);
+        });
+        return result;
+    };
+
+    THEN("GET returns the traces as a JSON array") {
+        const auto response = send_request(http::verb::get, EndPoint::TRACES);
+        REQUIRE(response.result() == http::status::ok);
+        const auto traces = json::parse(response.body()).as_array();
+        REQUIRE(traces.size() == 1);
+        CHECK(traces[0].as_object().at("target").as_string() == "/api/v1/maps"sv);
+    }
+
+    THEN("other methods are not allowed") {
+        CHECK(send_request(http::verb::post, EndPoint::TRACES).result() == http::status::method_not_allowed);
+    }
+
+    THEN("other requests are passed to the decorated handler") {
+        CHECK(send_request(http::verb::get, EndPoint::MAPS).result() == http::status::created);
+    }
+}